@@ -0,0 +1,234 @@
+// 
+// Runs the byte pattern corpus against CkCompileBytePattern, CkTryFindBytePattern and CkFindAllBytePatterns.
+// 
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "EasyNT.h"
+
+static ULONG NumberOfFailures = 0;
+static ULONG NumberOfCases = 0;
+
+/// <summary>
+/// A case of the corpus.
+/// </summary>
+struct TEST_CASE
+{
+	ULONG Line;
+	std::string Kind;
+	std::string Pattern;
+	std::vector<UINT8> Data;
+	std::vector<SIZE_T> Expected;
+};
+
+/// <summary>
+/// Parses a line of the corpus: the kind of the case, the quoted pattern, the bytes and, after a colon, the expected numbers.
+/// </summary>
+/// <param name="InLine">The line, without its line feed.</param>
+/// <param name="OutCase">The case.</param>
+static BOOLEAN TestParseCase(CONST std::string& InLine, OUT TEST_CASE* OutCase)
+{
+	CONST SIZE_T PatternStart = InLine.find('"');
+	CONST SIZE_T PatternEnd = PatternStart != std::string::npos ? InLine.find('"', PatternStart + 1) : std::string::npos;
+
+	if (PatternEnd == std::string::npos)
+		return FALSE;
+
+	OutCase->Kind = InLine.substr(0, InLine.find_first_of(" \t"));
+	OutCase->Pattern = InLine.substr(PatternStart + 1, PatternEnd - PatternStart - 1);
+	OutCase->Data.clear();
+	OutCase->Expected.clear();
+
+	// 
+	// The bytes are hexadecimal, "@N" standing for N zero bytes, and the expected numbers decimal.
+	// 
+
+	BOOLEAN AfterColon = FALSE;
+	SIZE_T Step = PatternEnd + 1;
+
+	while (Step < InLine.size())
+	{
+		if (InLine[Step] == ' ' || InLine[Step] == '\t')
+		{
+			Step++;
+			continue;
+		}
+
+		CONST SIZE_T TokenEnd = InLine.find_first_of(" \t", Step);
+		CONST std::string Token = InLine.substr(Step, TokenEnd == std::string::npos ? std::string::npos : TokenEnd - Step);
+		Step = TokenEnd == std::string::npos ? InLine.size() : TokenEnd;
+
+		if (Token == ":")
+			AfterColon = TRUE;
+		else if (AfterColon)
+			OutCase->Expected.push_back((SIZE_T) strtoull(Token.c_str(), nullptr, 10));
+		else if (Token[0] == '@')
+			OutCase->Data.resize(OutCase->Data.size() + (SIZE_T) strtoull(Token.c_str() + 1, nullptr, 10), 0x00);
+		else
+			OutCase->Data.push_back((UINT8) strtoul(Token.c_str(), nullptr, 16));
+	}
+
+	return TRUE;
+}
+
+/// <summary>
+/// Reports a failed case.
+/// </summary>
+/// <param name="InCase">The case.</param>
+/// <param name="InReason">The reason of the failure.</param>
+static VOID TestFail(CONST TEST_CASE* InCase, CONST CHAR* InReason)
+{
+	printf("FAIL line %u, %s \"%s\": %s\n", InCase->Line, InCase->Kind.c_str(), InCase->Pattern.c_str(), InReason);
+	NumberOfFailures++;
+}
+
+/// <summary>
+/// Runs a case of the corpus.
+/// </summary>
+/// <param name="InCase">The case.</param>
+static VOID TestRunCase(CONST TEST_CASE* InCase)
+{
+	CK_BYTE_PATTERN* Pattern = nullptr;
+	CONST NTSTATUS Status = CkCompileBytePattern(InCase->Pattern.c_str(), &Pattern);
+	CHAR Reason[128];
+
+	NumberOfCases++;
+
+	if (InCase->Kind == "invalid")
+	{
+		if (NT_SUCCESS(Status))
+		{
+			TestFail(InCase, "compiled");
+			CkFreeBytePattern(Pattern);
+		}
+
+		return;
+	}
+
+	if (NT_ERROR(Status))
+	{
+		snprintf(Reason, sizeof(Reason), "failed to compile with %08X", (ULONG) Status);
+		TestFail(InCase, Reason);
+		return;
+	}
+
+	// 
+	// The bytes end exactly at the end of their allocation, so an over-read is caught by the sanitizers.
+	// 
+
+	CONST PVOID Data = (PVOID) InCase->Data.data();
+	CONST SIZE_T Size = InCase->Data.size();
+
+	if (InCase->Kind == "match" || InCase->Kind == "none")
+	{
+		PVOID Result = nullptr;
+		SIZE_T Length = 0;
+		CONST NTSTATUS FindStatus = CkTryFindBytePattern(Data, Size, Pattern, &Result, &Length);
+
+		if (InCase->Kind == "none")
+		{
+			if (FindStatus != STATUS_NOT_FOUND)
+			{
+				snprintf(Reason, sizeof(Reason), "expected no match, found %08X at %zu", (ULONG) FindStatus, NT_SUCCESS(FindStatus) ? (SIZE_T) ((UINT8*) Result - (UINT8*) Data) : 0);
+				TestFail(InCase, Reason);
+			}
+		}
+		else if (InCase->Expected.size() != 2)
+		{
+			TestFail(InCase, "expected an offset and a length");
+		}
+		else if (!NT_SUCCESS(FindStatus))
+		{
+			snprintf(Reason, sizeof(Reason), "expected a match at %zu, failed with %08X", InCase->Expected[0], (ULONG) FindStatus);
+			TestFail(InCase, Reason);
+		}
+		else if ((SIZE_T) ((UINT8*) Result - (UINT8*) Data) != InCase->Expected[0] || Length != InCase->Expected[1])
+		{
+			snprintf(Reason, sizeof(Reason), "expected %zu/%zu, found %zu/%zu", InCase->Expected[0], InCase->Expected[1], (SIZE_T) ((UINT8*) Result - (UINT8*) Data), Length);
+			TestFail(InCase, Reason);
+		}
+	}
+	else if (InCase->Kind == "all")
+	{
+		struct ENUMERATION_CONTEXT
+		{
+			PVOID Data;
+			std::vector<SIZE_T> Offsets;
+		};
+
+		ENUMERATION_CONTEXT Context = { Data, {} };
+
+		CkFindAllBytePatterns(Data, Size, Pattern, &Context, [] (ULONG InIndex, PVOID InAddress, VOID* InContext) -> bool
+		{
+			auto* Context = (ENUMERATION_CONTEXT*) InContext;
+			Context->Offsets.push_back((SIZE_T) ((UINT8*) InAddress - (UINT8*) Context->Data));
+			return false;
+		});
+
+		if (Context.Offsets != InCase->Expected)
+		{
+			std::string Found;
+
+			for (SIZE_T Offset : Context.Offsets)
+				Found += " " + std::to_string(Offset);
+
+			snprintf(Reason, sizeof(Reason), "found the matches:%s", Found.empty() ? " none" : Found.c_str());
+			TestFail(InCase, Reason);
+		}
+	}
+	else
+	{
+		TestFail(InCase, "unknown kind of case");
+	}
+
+	CkFreeBytePattern(Pattern);
+}
+
+int main(int InArgumentCount, CHAR** InArguments)
+{
+	if (InArgumentCount != 2)
+	{
+		printf("usage: %s <corpus>\n", InArguments[0]);
+		return 2;
+	}
+
+	auto* File = fopen(InArguments[1], "r");
+
+	if (File == nullptr)
+	{
+		printf("cannot open %s\n", InArguments[1]);
+		return 2;
+	}
+
+	CHAR Buffer[4096];
+	TEST_CASE Case;
+	Case.Line = 0;
+
+	while (fgets(Buffer, sizeof(Buffer), File) != nullptr)
+	{
+		std::string Line = Buffer;
+		Case.Line++;
+
+		while (!Line.empty() && (Line.back() == '\n' || Line.back() == '\r'))
+			Line.pop_back();
+
+		if (Line.empty() || Line[0] == '#')
+			continue;
+
+		if (!TestParseCase(Line, &Case))
+		{
+			printf("FAIL line %u: malformed case\n", Case.Line);
+			NumberOfFailures++;
+			continue;
+		}
+
+		TestRunCase(&Case);
+	}
+
+	fclose(File);
+
+	printf("%u cases, %u failures\n", NumberOfCases, NumberOfFailures);
+	return NumberOfFailures == 0 && NumberOfCases != 0 ? 0 : 1;
+}
@@ -0,0 +1,345 @@
+// 
+// Measures the throughput and the latency of the pattern scanning functions, on a random buffer and on the files given on the command line.
+// 
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "EasyNT.h"
+
+// 
+// The number of signatures sampled for each shape, and the number of runs of each measurement, of which the fastest is reported.
+// 
+
+#define BENCHMARK_NUMBER_OF_SIGNATURES 64
+#define BENCHMARK_NUMBER_OF_RUNS       5
+
+// 
+// The length of the longest signature shape in entries, and of a signature written in the IDA format, three characters per entry.
+// 
+
+#define BENCHMARK_MAXIMUM_LENGTH        64
+#define BENCHMARK_SIGNATURE_TEXT_LENGTH (BENCHMARK_MAXIMUM_LENGTH * 3)
+
+// 
+// The size of the random buffer.
+// 
+
+#define BENCHMARK_RANDOM_BUFFER_SIZE (64 * 1024 * 1024)
+
+// 
+// The padding searched for by the padding measurement.
+// 
+
+#define BENCHMARK_PADDING_BYTE   0xCC
+#define BENCHMARK_PADDING_LENGTH 16
+
+/// <summary>
+/// A shape of the signatures sampled for the measurements.
+/// </summary>
+struct BENCHMARK_SHAPE
+{
+	CONST CHAR* Name;
+	SIZE_T Length;
+	SIZE_T WildcardStride;
+};
+
+// 
+// The short signatures are solid, the long ones have a wildcard every eight bytes and the wildcard-heavy ones every other byte.
+// 
+
+static CONST BENCHMARK_SHAPE BenchmarkShapes[] =
+{
+	{ "Short",          8,  0 },
+	{ "Long",           64, 8 },
+	{ "Wildcard-heavy", 16, 2 },
+};
+
+/// <summary>
+/// A deterministic xorshift generator, so every run samples the same signatures.
+/// </summary>
+struct BENCHMARK_RANDOM
+{
+	UINT64 State;
+
+	UINT64 Next()
+	{
+		State ^= State << 13;
+		State ^= State >> 7;
+		State ^= State << 17;
+		return State;
+	}
+};
+
+/// <summary>
+/// Writes a signature in the IDA format out of the bytes at the given address.
+/// </summary>
+/// <param name="InAddress">The address of the sampled bytes.</param>
+/// <param name="InShape">The shape of the signature.</param>
+/// <param name="OutSignature">The signature, at least BENCHMARK_SIGNATURE_TEXT_LENGTH characters long.</param>
+static VOID BenchmarkWriteSignature(CONST UINT8* InAddress, CONST BENCHMARK_SHAPE* InShape, OUT CHAR* OutSignature)
+{
+	CONST CHAR Digits[] = "0123456789ABCDEF";
+	CHAR* Cursor = OutSignature;
+
+	for (SIZE_T I = 0; I < InShape->Length; I++)
+	{
+		if (I != 0)
+			*Cursor++ = ' ';
+
+		// 
+		// The first and last entries are always solid.
+		// 
+
+		if (InShape->WildcardStride != 0 && I != 0 && I + 1 != InShape->Length && (I % InShape->WildcardStride) == InShape->WildcardStride - 1)
+		{
+			*Cursor++ = '?';
+			continue;
+		}
+
+		*Cursor++ = Digits[InAddress[I] >> 4];
+		*Cursor++ = Digits[InAddress[I] & 0xF];
+	}
+
+	*Cursor = '\0';
+}
+
+/// <summary>
+/// Runs a measurement several times and prints the throughput and the latency of the fastest run.
+/// </summary>
+/// <param name="InName">The name of the measurement.</param>
+/// <param name="InNumberOfSignatures">The number of signatures searched by each run.</param>
+/// <param name="InScan">The measured function, returning the number of bytes it went through.</param>
+template <typename TScan>
+static VOID BenchmarkMeasure(CONST CHAR* InName, ULONG InNumberOfSignatures, TScan InScan)
+{
+	ULONG64 NumberOfBytes = 0;
+	double BestSeconds = 0;
+
+	for (ULONG Run = 0; Run < BENCHMARK_NUMBER_OF_RUNS; Run++)
+	{
+		CONST auto Start = std::chrono::steady_clock::now();
+		NumberOfBytes = InScan();
+		CONST std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+
+		if (Run == 0 || Elapsed.count() < BestSeconds)
+			BestSeconds = Elapsed.count();
+	}
+
+	if (BestSeconds <= 0)
+		BestSeconds = 1e-9;
+
+	printf("  %-26s %8.2f GB/s %12.2f us/signature\n", InName, (double) NumberOfBytes / BestSeconds / 1e9, BestSeconds * 1e6 / InNumberOfSignatures);
+}
+
+/// <summary>
+/// Measures every shape, the signature set and the padding search over the given memory region.
+/// </summary>
+/// <param name="InName">The name of the region.</param>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+static NTSTATUS BenchmarkRegion(CONST CHAR* InName, CONST PVOID InBaseAddress, SIZE_T InSize)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InName == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InSize <= BENCHMARK_MAXIMUM_LENGTH)
+		return STATUS_INVALID_PARAMETER_3;
+
+	printf("%s, %zu bytes\n", InName, InSize);
+
+	// 
+	// Sample the signatures out of the region, so every one of them is found.
+	// 
+
+	CONST SIZE_T NumberOfShapes = ARRAYSIZE(BenchmarkShapes);
+	auto* Base = (CONST UINT8*) InBaseAddress;
+
+	std::vector<CHAR> Texts(NumberOfShapes * BENCHMARK_NUMBER_OF_SIGNATURES * (BENCHMARK_SIGNATURE_TEXT_LENGTH + 1));
+	std::vector<CK_SIGNATURE*> Signatures(NumberOfShapes * BENCHMARK_NUMBER_OF_SIGNATURES);
+	std::vector<PVOID> SetResults(BENCHMARK_NUMBER_OF_SIGNATURES);
+
+	NTSTATUS Status = STATUS_SUCCESS;
+	BENCHMARK_RANDOM Random = { 0x9E3779B97F4A7C15 };
+
+	for (SIZE_T ShapeIndex = 0; ShapeIndex < NumberOfShapes && NT_SUCCESS(Status); ShapeIndex++)
+	{
+		CONST BENCHMARK_SHAPE* Shape = &BenchmarkShapes[ShapeIndex];
+
+		for (ULONG I = 0; I < BENCHMARK_NUMBER_OF_SIGNATURES; I++)
+		{
+			CONST SIZE_T Index = ShapeIndex * BENCHMARK_NUMBER_OF_SIGNATURES + I;
+			CONST SIZE_T Offset = (SIZE_T) (Random.Next() % (InSize - Shape->Length));
+			CHAR* Text = &Texts[Index * (BENCHMARK_SIGNATURE_TEXT_LENGTH + 1)];
+
+			BenchmarkWriteSignature(&Base[Offset], Shape, Text);
+
+			if (!NT_SUCCESS(Status = CkCompileSignature(Text, &Signatures[Index])))
+				break;
+		}
+	}
+
+	// 
+	// Measure each shape, first parsed on every call then compiled.
+	// 
+
+	for (SIZE_T ShapeIndex = 0; ShapeIndex < NumberOfShapes && NT_SUCCESS(Status); ShapeIndex++)
+	{
+		CONST BENCHMARK_SHAPE* Shape = &BenchmarkShapes[ShapeIndex];
+		CHAR Name[64];
+
+		snprintf(Name, sizeof(Name), "%s (text)", Shape->Name);
+		BenchmarkMeasure(Name, BENCHMARK_NUMBER_OF_SIGNATURES, [&] () -> ULONG64
+		{
+			ULONG64 NumberOfBytes = 0;
+
+			for (ULONG I = 0; I < BENCHMARK_NUMBER_OF_SIGNATURES; I++)
+			{
+				PVOID Result = nullptr;
+
+				if (NT_SUCCESS(CkTryFindPattern(InBaseAddress, InSize, &Texts[(ShapeIndex * BENCHMARK_NUMBER_OF_SIGNATURES + I) * (BENCHMARK_SIGNATURE_TEXT_LENGTH + 1)], &Result)))
+					NumberOfBytes += (ULONG64) ((CONST UINT8*) Result - Base) + Shape->Length;
+				else
+					NumberOfBytes += InSize;
+			}
+
+			return NumberOfBytes;
+		});
+
+		snprintf(Name, sizeof(Name), "%s (compiled)", Shape->Name);
+		BenchmarkMeasure(Name, BENCHMARK_NUMBER_OF_SIGNATURES, [&] () -> ULONG64
+		{
+			ULONG64 NumberOfBytes = 0;
+
+			for (ULONG I = 0; I < BENCHMARK_NUMBER_OF_SIGNATURES; I++)
+			{
+				PVOID Result = nullptr;
+
+				if (NT_SUCCESS(CkTryFindPattern(InBaseAddress, InSize, Signatures[ShapeIndex * BENCHMARK_NUMBER_OF_SIGNATURES + I], &Result)))
+					NumberOfBytes += (ULONG64) ((CONST UINT8*) Result - Base) + Shape->Length;
+				else
+					NumberOfBytes += InSize;
+			}
+
+			return NumberOfBytes;
+		});
+	}
+
+	// 
+	// Measure the short signatures matched together in a single pass.
+	// 
+
+	if (NT_SUCCESS(Status))
+	{
+		CK_SIGNATURE_SET* SignatureSet = nullptr;
+
+		if (NT_SUCCESS(Status = CkCompileSignatureSet(Signatures.data(), BENCHMARK_NUMBER_OF_SIGNATURES, &SignatureSet)))
+		{
+			BenchmarkMeasure("Short (set)", BENCHMARK_NUMBER_OF_SIGNATURES, [&] () -> ULONG64
+			{
+				CkTryFindPatterns(InBaseAddress, InSize, SignatureSet, SetResults.data());
+				return InSize;
+			});
+
+			CkFreeSignatureSet(SignatureSet);
+		}
+	}
+
+	// 
+	// Measure the padding search.
+	// 
+
+	if (NT_SUCCESS(Status))
+	{
+		BenchmarkMeasure("Padding", 1, [&] () -> ULONG64
+		{
+			PVOID Result = nullptr;
+
+			if (NT_SUCCESS(CkTryFindPadding(InBaseAddress, InSize, BENCHMARK_PADDING_BYTE, BENCHMARK_PADDING_LENGTH, &Result)))
+				return (ULONG64) ((CONST UINT8*) Result - Base) + BENCHMARK_PADDING_LENGTH;
+
+			return InSize;
+		});
+	}
+
+	// 
+	// Release the signatures.
+	// 
+
+	for (auto* Signature : Signatures)
+	{
+		if (Signature != nullptr)
+			CkFreeSignature(Signature);
+	}
+
+	return Status;
+}
+
+/// <summary>
+/// Reads a whole file into memory.
+/// </summary>
+/// <param name="InFilePath">The path of the file.</param>
+/// <param name="OutBuffer">The buffer receiving the content of the file.</param>
+static NTSTATUS BenchmarkReadFile(CONST CHAR* InFilePath, OUT std::vector<UINT8>* OutBuffer)
+{
+	auto* File = fopen(InFilePath, "rb");
+
+	if (File == nullptr)
+		return STATUS_OBJECT_NAME_NOT_FOUND;
+
+	NTSTATUS Status = STATUS_SUCCESS;
+	UINT8 Chunk[0x10000];
+	SIZE_T NumberOfBytesRead;
+
+	OutBuffer->clear();
+
+	while ((NumberOfBytesRead = fread(Chunk, 1, sizeof(Chunk), File)) != 0)
+		OutBuffer->insert(OutBuffer->end(), Chunk, Chunk + NumberOfBytesRead);
+
+	if (ferror(File))
+		Status = STATUS_UNSUCCESSFUL;
+
+	fclose(File);
+	return Status;
+}
+
+int main(int InArgumentCount, CHAR** InArguments)
+{
+	NTSTATUS Status;
+	int ExitCode = 0;
+
+	// 
+	// Measure a random buffer, where the first bytes of the signatures rarely match, then the given files, typically PE images.
+	// 
+
+	std::vector<UINT8> Buffer(BENCHMARK_RANDOM_BUFFER_SIZE);
+	BENCHMARK_RANDOM Random = { 0x2545F4914F6CDD1D };
+
+	for (auto& Value : Buffer)
+		Value = (UINT8) Random.Next();
+
+	if (!NT_SUCCESS(Status = BenchmarkRegion("Random buffer", Buffer.data(), Buffer.size())))
+	{
+		printf("Random buffer: failed with %08X\n", (ULONG) Status);
+		ExitCode = 1;
+	}
+
+	for (int I = 1; I < InArgumentCount; I++)
+	{
+		if (!NT_SUCCESS(Status = BenchmarkReadFile(InArguments[I], &Buffer)) || !NT_SUCCESS(Status = BenchmarkRegion(InArguments[I], Buffer.data(), Buffer.size())))
+		{
+			printf("%s: failed with %08X\n", InArguments[I], (ULONG) Status);
+			ExitCode = 1;
+		}
+	}
+
+	return ExitCode;
+}
@@ -0,0 +1,249 @@
+// 
+// Compares every scan engine of ScanExtensions.cpp against a naive reference, on random buffers and signatures.
+// 
+
+#include <cstdio>
+#include <vector>
+
+#include "Sources/Extensions/ScanExtensions.cpp"
+
+// 
+// The number of random buffers, and of signatures searched in each of them.
+// 
+
+#define TEST_NUMBER_OF_BUFFERS    400
+#define TEST_NUMBER_OF_SIGNATURES 24
+
+/// <summary>
+/// A deterministic xorshift generator, so a failure can be replayed from its seed.
+/// </summary>
+struct TEST_RANDOM
+{
+	UINT64 State;
+
+	UINT64 Next()
+	{
+		State ^= State << 13;
+		State ^= State >> 7;
+		State ^= State << 17;
+		return State;
+	}
+
+	SIZE_T Below(SIZE_T InBound)
+	{
+		return (SIZE_T) (Next() % InBound);
+	}
+};
+
+static ULONG NumberOfFailures = 0;
+static ULONG NumberOfComparisons = 0;
+
+/// <summary>
+/// Searches for the signature one offset at a time, comparing every byte.
+/// </summary>
+static SIZE_T TestScanReference(CONST UINT8* InData, SIZE_T InSize, CONST UINT8* InValues, CONST UINT8* InMasks, SIZE_T InLength, SIZE_T InOffset)
+{
+	for (SIZE_T X = InOffset; X + InLength <= InSize; X++)
+	{
+		SIZE_T I = 0;
+
+		while (I < InLength && (InData[X + I] & InMasks[I]) == InValues[I])
+			I++;
+
+		if (I == InLength)
+			return X;
+	}
+
+	return SIGNATURE_NOT_FOUND;
+}
+
+/// <summary>
+/// Enumerates every match of the signature with the given engine, and compares them with the reference.
+/// </summary>
+static VOID TestCompareEngine(CONST CHAR* InName, SIGNATURE_SCAN_ENGINE InEngine, CONST UINT8* InData, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, UINT64 InSeed)
+{
+	SIZE_T Expected = 0;
+	SIZE_T Actual = 0;
+
+	for (;;)
+	{
+		Expected = TestScanReference(InData, InSize, InSignature->Values, InSignature->Masks, InSignature->Length, Expected);
+		Actual = InEngine(InData, InSize, InSignature, Actual);
+		NumberOfComparisons++;
+
+		if (Expected != Actual)
+		{
+			printf("FAIL %s: seed %llu, size %zu, length %zu, expected %zd, found %zd\n", InName, (unsigned long long) InSeed, InSize, InSignature->Length, (ptrdiff_t) Expected, (ptrdiff_t) Actual);
+			NumberOfFailures++;
+			return;
+		}
+
+		if (Expected == SIGNATURE_NOT_FOUND)
+			return;
+
+		Expected++;
+		Actual++;
+
+		if (Expected + InSignature->Length > InSize)
+			return;
+	}
+}
+
+/// <summary>
+/// Compares every engine applicable to the signature, along with the public entry points.
+/// </summary>
+static VOID TestCompareEngines(CONST UINT8* InData, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, UINT64 InSeed)
+{
+	if (InSize < InSignature->Length)
+		return;
+
+	TestCompareEngine("Scalar", CkScanSignatureScalar, InData, InSize, InSignature, InSeed);
+
+	if (InSignature->RunLength != 0)
+		TestCompareEngine("SkipTable", CkScanSignatureSkipTable, InData, InSize, InSignature, InSeed);
+
+#if defined(_M_AMD64)
+
+	if (InSignature->HasAnchors)
+	{
+		TestCompareEngine("Sse2", CkScanSignatureSse2, InData, InSize, InSignature, InSeed);
+
+		if (CkSignatureAvx2IsSupported())
+			TestCompareEngine("Avx2", CkScanSignatureAvx2, InData, InSize, InSignature, InSeed);
+	}
+
+#endif
+
+	// 
+	// The engine selected by the library must agree as well, through the first match and the match count.
+	// 
+
+	PVOID Result = nullptr;
+	CONST SIZE_T Expected = TestScanReference(InData, InSize, InSignature->Values, InSignature->Masks, InSignature->Length, 0);
+	CONST NTSTATUS Status = CkTryFindPattern((CONST PVOID) InData, InSize, InSignature, &Result);
+	NumberOfComparisons++;
+
+	if ((Expected == SIGNATURE_NOT_FOUND) != (Status == STATUS_NOT_FOUND) || (NT_SUCCESS(Status) && Result != &InData[Expected]))
+	{
+		printf("FAIL CkTryFindPattern: seed %llu, size %zu, length %zu, status %08X\n", (unsigned long long) InSeed, InSize, InSignature->Length, (ULONG) Status);
+		NumberOfFailures++;
+	}
+
+	ULONG ExpectedCount = 0;
+
+	for (SIZE_T Offset = 0; (Offset = TestScanReference(InData, InSize, InSignature->Values, InSignature->Masks, InSignature->Length, Offset)) != SIGNATURE_NOT_FOUND; Offset++)
+		ExpectedCount++;
+
+	ULONG Count = 0;
+	CkCountPatternMatches((CONST PVOID) InData, InSize, InSignature, MAXULONG, &Count);
+	NumberOfComparisons++;
+
+	if (Count != ExpectedCount)
+	{
+		printf("FAIL CkCountPatternMatches: seed %llu, size %zu, length %zu, expected %u, found %u\n", (unsigned long long) InSeed, InSize, InSignature->Length, ExpectedCount, Count);
+		NumberOfFailures++;
+	}
+}
+
+/// <summary>
+/// Builds a signature out of the data at a random offset, or out of random bytes, with random wildcards and nibble masks.
+/// </summary>
+static VOID TestBuildSignature(TEST_RANDOM* InRandom, CONST UINT8* InData, SIZE_T InSize, OUT std::vector<UINT8>* OutValues, OUT std::vector<UINT8>* OutMasks)
+{
+	SIZE_T Length = 1 + InRandom->Below(InRandom->Below(4) == 0 ? 80 : 24);
+
+	if (Length > InSize)
+		Length = InSize;
+
+	CONST BOOLEAN FromData = InRandom->Below(4) != 0;
+	CONST SIZE_T Offset = InRandom->Below(InSize - Length + 1);
+	CONST SIZE_T WildcardRate = InRandom->Below(5);
+
+	OutValues->resize(Length);
+	OutMasks->resize(Length);
+
+	for (SIZE_T I = 0; I < Length; I++)
+	{
+		UINT8 Mask = 0xFF;
+
+		if (WildcardRate != 0 && InRandom->Below(8) < WildcardRate)
+		{
+			CONST UINT8 Masks[] = { 0x00, 0x00, 0xF0, 0x0F, 0xFC };
+			Mask = Masks[InRandom->Below(ARRAYSIZE(Masks))];
+		}
+
+		CONST UINT8 Value = FromData ? InData[Offset + I] : (UINT8) InRandom->Next();
+		(*OutValues)[I] = Value & Mask;
+		(*OutMasks)[I] = Mask;
+	}
+}
+
+int main()
+{
+	TEST_RANDOM Random = { 0x9E3779B97F4A7C15 };
+
+	for (ULONG Iteration = 0; Iteration < TEST_NUMBER_OF_BUFFERS; Iteration++)
+	{
+		CONST UINT64 Seed = Random.Next();
+		TEST_RANDOM BufferRandom = { Seed };
+
+		// 
+		// Mix tiny buffers, which only take the tails of the vector loops, with larger ones,
+		// and small alphabets, which produce many anchor candidates, with uniform bytes.
+		// 
+
+		CONST SIZE_T Size = BufferRandom.Below(8) == 0 ? 1 + BufferRandom.Below(64) : 1 + BufferRandom.Below(0x3000);
+		CONST SIZE_T Alphabet = BufferRandom.Below(3) == 0 ? 2 + BufferRandom.Below(3) : 256;
+
+		// 
+		// The buffer ends exactly at the end of the allocation, so an over-read is caught by the sanitizers.
+		// 
+
+		std::vector<UINT8> Buffer(Size);
+
+		for (SIZE_T I = 0; I < Size; I++)
+			Buffer[I] = Alphabet == 256 ? (UINT8) BufferRandom.Next() : (UINT8) (0xCC + BufferRandom.Below(Alphabet));
+
+		for (ULONG J = 0; J < TEST_NUMBER_OF_SIGNATURES; J++)
+		{
+			std::vector<UINT8> Values;
+			std::vector<UINT8> Masks;
+			TestBuildSignature(&BufferRandom, Buffer.data(), Size, &Values, &Masks);
+
+			CK_SIGNATURE Signature;
+			CkInitializeSignature(&Signature, Values.data(), Masks.data(), Values.size());
+			TestCompareEngines(Buffer.data(), Size, &Signature, Seed);
+		}
+	}
+
+	// 
+	// Compiled signatures go through the text parser, the one the library users actually call.
+	// 
+
+	CONST UINT8 Code[] = { 0x48, 0x89, 0x5C, 0x24, 0x08, 0x57, 0x48, 0x83, 0xEC, 0x20, 0x48, 0x8B, 0xF9, 0xE8, 0x10, 0x20, 0x30, 0x40, 0xCC };
+	CONST CHAR* Texts[] = { "48 89 5C 24 08", "48 8B ? E8", "4? 8? F9 E8 ?? ?? ?? ??", "E8 ? ? ? 40 CC", "57 48 83&F0 EC" };
+
+	for (auto* Text : Texts)
+	{
+		CK_SIGNATURE* Signature = nullptr;
+
+		if (NT_ERROR(CkCompileSignature(Text, &Signature)))
+		{
+			printf("FAIL CkCompileSignature: \"%s\"\n", Text);
+			NumberOfFailures++;
+			continue;
+		}
+
+		TestCompareEngines(Code, sizeof(Code), Signature, 0);
+		CkFreeSignature(Signature);
+	}
+
+#if defined(_M_AMD64)
+	printf("engines: scalar, skip table, sse2%s\n", CkSignatureAvx2IsSupported() ? ", avx2" : "");
+#else
+	printf("engines: scalar, skip table\n");
+#endif
+
+	printf("%u comparisons, %u failures\n", NumberOfComparisons, NumberOfFailures);
+	return NumberOfFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,654 @@
+#pragma once
+
+// 
+// Host replacement of Headers/EasyNT.h, providing the NT types and the few kernel routines
+// the OS-independent scan code depends on, so it can be compiled and exercised on Linux.
+// 
+// The routines which only make sense in the kernel (threads, process and physical memory, files)
+// are stubs failing with STATUS_NOT_SUPPORTED, so the code paths built on them compile but stay inert.
+// 
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define _M_AMD64 1
+#endif
+
+// 
+// Types.
+// 
+
+typedef void VOID;
+typedef void* PVOID;
+typedef void* HANDLE;
+typedef char CHAR;
+typedef wchar_t WCHAR;
+typedef uint8_t UINT8;
+typedef uint8_t BYTE;
+typedef uint8_t BOOLEAN;
+typedef uint16_t UINT16;
+typedef uint16_t USHORT;
+typedef uint16_t WORD;
+typedef int32_t INT32;
+typedef int32_t LONG;
+typedef uint32_t UINT32;
+typedef uint32_t ULONG;
+typedef uint32_t DWORD;
+typedef int64_t INT64;
+typedef int64_t LONG64;
+typedef int64_t LONGLONG;
+typedef uint64_t UINT64;
+typedef uint64_t ULONG64;
+typedef uint64_t ULONGLONG;
+typedef uintptr_t ULONG_PTR;
+typedef size_t SIZE_T;
+typedef LONG NTSTATUS;
+typedef struct _EPROCESS* PEPROCESS;
+
+typedef union _LARGE_INTEGER
+{
+	struct
+	{
+		ULONG LowPart;
+		LONG HighPart;
+	};
+
+	LONGLONG QuadPart;
+} LARGE_INTEGER, PHYSICAL_ADDRESS;
+
+#define CONST const
+#define IN
+#define OUT
+#define OPTIONAL
+#define TRUE 1
+#define FALSE 0
+
+#define MAXUINT16 ((UINT16) ~((UINT16) 0))
+#define MAXLONG   ((LONG) 0x7FFFFFFF)
+#define MAXULONG  ((ULONG) ~((ULONG) 0))
+#define MAXULONG64 ((ULONG64) ~((ULONG64) 0))
+
+#define UNALIGNED
+
+#define ARRAYSIZE(A) (sizeof(A) / sizeof((A)[0]))
+
+#ifndef min
+#define min(A, B) (((A) < (B)) ? (A) : (B))
+#endif
+
+#ifndef max
+#define max(A, B) (((A) > (B)) ? (A) : (B))
+#endif
+
+// 
+// Status codes.
+// 
+
+#define NT_SUCCESS(Status) (((NTSTATUS) (Status)) >= 0)
+#define NT_ERROR(Status) ((((ULONG) (Status)) >> 30) == 3)
+
+#define STATUS_SUCCESS                 ((NTSTATUS) 0x00000000L)
+#define STATUS_PENDING                 ((NTSTATUS) 0x00000103L)
+#define STATUS_BUFFER_OVERFLOW         ((NTSTATUS) 0x80000005L)
+#define STATUS_NO_MORE_ENTRIES         ((NTSTATUS) 0x8000001AL)
+#define STATUS_UNSUCCESSFUL            ((NTSTATUS) 0xC0000001L)
+#define STATUS_ACCESS_VIOLATION        ((NTSTATUS) 0xC0000005L)
+#define STATUS_INVALID_PARAMETER       ((NTSTATUS) 0xC000000DL)
+#define STATUS_BUFFER_TOO_SMALL        ((NTSTATUS) 0xC0000023L)
+#define STATUS_OBJECT_NAME_NOT_FOUND   ((NTSTATUS) 0xC0000034L)
+#define STATUS_INVALID_IMAGE_FORMAT    ((NTSTATUS) 0xC000007BL)
+#define STATUS_ARRAY_BOUNDS_EXCEEDED   ((NTSTATUS) 0xC000008CL)
+#define STATUS_INSUFFICIENT_RESOURCES  ((NTSTATUS) 0xC000009AL)
+#define STATUS_NOT_SUPPORTED           ((NTSTATUS) 0xC00000BBL)
+#define STATUS_INTERNAL_ERROR          ((NTSTATUS) 0xC00000E5L)
+#define STATUS_INVALID_PARAMETER_1     ((NTSTATUS) 0xC00000EFL)
+#define STATUS_INVALID_PARAMETER_2     ((NTSTATUS) 0xC00000F0L)
+#define STATUS_INVALID_PARAMETER_3     ((NTSTATUS) 0xC00000F1L)
+#define STATUS_INVALID_PARAMETER_4     ((NTSTATUS) 0xC00000F2L)
+#define STATUS_INVALID_PARAMETER_5     ((NTSTATUS) 0xC00000F3L)
+#define STATUS_INVALID_PARAMETER_6     ((NTSTATUS) 0xC00000F4L)
+#define STATUS_INVALID_PARAMETER_7     ((NTSTATUS) 0xC00000F5L)
+#define STATUS_INVALID_PARAMETER_8     ((NTSTATUS) 0xC00000F6L)
+#define STATUS_FILE_CORRUPT_ERROR      ((NTSTATUS) 0xC0000102L)
+#define STATUS_CANCELLED               ((NTSTATUS) 0xC0000120L)
+#define STATUS_INVALID_ADDRESS         ((NTSTATUS) 0xC0000141L)
+#define STATUS_NOT_FOUND               ((NTSTATUS) 0xC0000225L)
+
+// 
+// Memory.
+// 
+
+#define PAGE_SIZE 0x1000
+#define PAGE_ROUND_UP(Value) ((((ULONG_PTR) (Value)) + PAGE_SIZE - 1) & (~((ULONG_PTR) PAGE_SIZE - 1)))
+#define BYTES_TO_PAGES(Size) (((Size) >> 12) + (((Size) & (PAGE_SIZE - 1)) != 0))
+
+#define RtlAddOffsetToPointer(Pointer, Offset) ((PVOID) ((ULONG_PTR) (Pointer) + (ULONG_PTR) (Offset)))
+#define RtlSubOffsetFromPointer(Pointer, Offset) ((PVOID) ((ULONG_PTR) (Pointer) - (ULONG_PTR) (Offset)))
+
+#define RtlZeroMemory(Destination, Length) memset((Destination), 0, (Length))
+#define RtlFillMemory(Destination, Length, Fill) memset((Destination), (Fill), (Length))
+#define RtlCopyMemory(Destination, Source, Length) memcpy((Destination), (Source), (Length))
+#define RtlMoveMemory(Destination, Source, Length) memmove((Destination), (Source), (Length))
+#define RtlEqualMemory(Destination, Source, Length) (memcmp((Destination), (Source), (Length)) == 0)
+
+typedef int POOL_TYPE;
+
+#define NonPagedPool   0
+#define PagedPool      1
+#define NonPagedPoolNx 512
+
+inline PVOID CkAllocatePool(POOL_TYPE InPoolType, SIZE_T InNumberOfBytes)
+{
+	return calloc(1, InNumberOfBytes);
+}
+
+inline VOID CkFreePool(PVOID InBuffer)
+{
+	free(InBuffer);
+}
+
+inline VOID ExFreePool(PVOID InBuffer)
+{
+	free(InBuffer);
+}
+
+inline BOOLEAN MmIsAddressValid(PVOID InVirtualAddress)
+{
+	return InVirtualAddress != nullptr;
+}
+
+// 
+// Processor.
+// 
+
+#define PASSIVE_LEVEL 0
+#define PAGED_CODE()
+
+#define XSTATE_MASK_AVX (1ULL << 2)
+
+struct XSTATE_SAVE
+{
+	ULONG64 Mask;
+};
+
+inline NTSTATUS KeSaveExtendedProcessorState(ULONG64 InMask, XSTATE_SAVE* OutSaveState)
+{
+	OutSaveState->Mask = InMask;
+	return STATUS_SUCCESS;
+}
+
+inline VOID KeRestoreExtendedProcessorState(XSTATE_SAVE* InSaveState)
+{
+}
+
+inline unsigned char _BitScanForward(ULONG* OutIndex, ULONG InMask)
+{
+	if (InMask == 0)
+		return 0;
+
+	*OutIndex = (ULONG) __builtin_ctz(InMask);
+	return 1;
+}
+
+inline unsigned char _BitScanForward64(ULONG* OutIndex, ULONG64 InMask)
+{
+	if (InMask == 0)
+		return 0;
+
+	*OutIndex = (ULONG) __builtin_ctzll(InMask);
+	return 1;
+}
+
+inline ULONG64 RotateLeft64(ULONG64 InValue, int InShift)
+{
+	return (InValue << InShift) | (InValue >> ((64 - InShift) & 63));
+}
+
+inline LONG InterlockedIncrement(volatile LONG* InOutValue)
+{
+	return __atomic_add_fetch(InOutValue, 1, __ATOMIC_SEQ_CST);
+}
+
+inline LONG InterlockedDecrement(volatile LONG* InOutValue)
+{
+	return __atomic_sub_fetch(InOutValue, 1, __ATOMIC_SEQ_CST);
+}
+
+inline LONG InterlockedExchange(volatile LONG* InOutValue, LONG InValue)
+{
+	return __atomic_exchange_n(InOutValue, InValue, __ATOMIC_SEQ_CST);
+}
+
+inline LONG InterlockedCompareExchange(volatile LONG* InOutValue, LONG InValue, LONG InComparand)
+{
+	__atomic_compare_exchange_n(InOutValue, &InComparand, InValue, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	return InComparand;
+}
+
+inline LONG64 InterlockedCompareExchange64(volatile LONG64* InOutValue, LONG64 InValue, LONG64 InComparand)
+{
+	__atomic_compare_exchange_n(InOutValue, &InComparand, InValue, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	return InComparand;
+}
+
+inline LARGE_INTEGER KeQueryPerformanceCounter(OPTIONAL OUT LARGE_INTEGER* OutFrequency)
+{
+	struct timespec Now;
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+
+	if (OutFrequency != nullptr)
+		OutFrequency->QuadPart = 1000000000;
+
+	LARGE_INTEGER Counter;
+	Counter.QuadPart = (LONGLONG) Now.tv_sec * 1000000000 + Now.tv_nsec;
+	return Counter;
+}
+
+#define ALL_PROCESSOR_GROUPS 0xFFFF
+
+inline ULONG KeQueryActiveProcessorCountEx(USHORT InGroupNumber)
+{
+	return 1;
+}
+
+// 
+// Structured exception handling, the host never raises any so only the guarded blocks run.
+// The C++ library headers use the same names, so they must be included before this header.
+// 
+
+#undef __try
+#undef __except
+#undef __finally
+
+#define __try if (true)
+#define __except(Filter) else if (false)
+#define __finally if (true)
+
+#define EXCEPTION_EXECUTE_HANDLER 1
+#define GetExceptionCode() STATUS_ACCESS_VIOLATION
+
+// 
+// Threads, only the current thread ever runs the code.
+// 
+
+struct OBJECT_ATTRIBUTES
+{
+	ULONG Attributes;
+};
+
+#define OBJ_KERNEL_HANDLE 0x00000200L
+#define SYNCHRONIZE       0x00100000L
+
+#define InitializeObjectAttributes(ObjectAttributes, Name, InAttributes, RootDirectory, SecurityDescriptor) ((ObjectAttributes)->Attributes = (InAttributes))
+
+typedef VOID(* PKSTART_ROUTINE)(PVOID InContext);
+
+inline NTSTATUS PsCreateSystemThread(HANDLE* OutThreadHandle, ULONG InDesiredAccess, OBJECT_ATTRIBUTES* InObjectAttributes, HANDLE InProcessHandle, PVOID InClientId, PKSTART_ROUTINE InStartRoutine, PVOID InStartContext)
+{
+	return STATUS_NOT_SUPPORTED;
+}
+
+inline NTSTATUS PsTerminateSystemThread(NTSTATUS InExitStatus)
+{
+	return STATUS_SUCCESS;
+}
+
+inline NTSTATUS ZwWaitForSingleObject(HANDLE InHandle, BOOLEAN InAlertable, PVOID InTimeout)
+{
+	return STATUS_SUCCESS;
+}
+
+inline NTSTATUS ZwClose(HANDLE InHandle)
+{
+	return STATUS_SUCCESS;
+}
+
+inline PEPROCESS PsGetCurrentProcess()
+{
+	return nullptr;
+}
+
+struct KAPC_STATE
+{
+	PEPROCESS Process;
+};
+
+inline VOID KeStackAttachProcess(PEPROCESS InProcess, OUT KAPC_STATE* OutApcState)
+{
+	OutApcState->Process = InProcess;
+}
+
+inline VOID KeUnstackDetachProcess(KAPC_STATE* InApcState)
+{
+}
+
+// 
+// Dispatcher objects, never waited on since no other thread is started.
+// 
+
+#define IO_NO_INCREMENT 0
+
+#define NotificationEvent     0
+#define SynchronizationEvent  1
+
+#define Executive  0
+#define KernelMode 0
+
+struct KEVENT
+{
+	LONG State;
+};
+
+struct KSEMAPHORE
+{
+	LONG Count;
+};
+
+inline VOID KeInitializeEvent(OUT KEVENT* OutEvent, int InType, BOOLEAN InState)
+{
+	OutEvent->State = InState;
+}
+
+inline LONG KeSetEvent(KEVENT* InEvent, LONG InIncrement, BOOLEAN InWait)
+{
+	return InterlockedExchange(&InEvent->State, 1);
+}
+
+inline VOID KeInitializeSemaphore(OUT KSEMAPHORE* OutSemaphore, LONG InCount, LONG InLimit)
+{
+	OutSemaphore->Count = InCount;
+}
+
+inline LONG KeReleaseSemaphore(KSEMAPHORE* InSemaphore, LONG InIncrement, LONG InAdjustment, BOOLEAN InWait)
+{
+	return __atomic_fetch_add(&InSemaphore->Count, InAdjustment, __ATOMIC_SEQ_CST);
+}
+
+inline NTSTATUS KeWaitForSingleObject(PVOID InObject, int InWaitReason, int InWaitMode, BOOLEAN InAlertable, PVOID InTimeout)
+{
+	return STATUS_SUCCESS;
+}
+
+// 
+// Virtual and physical memory, which the host cannot reach.
+// 
+
+#define MEM_COMMIT  0x00001000
+#define MEM_RESERVE 0x00002000
+
+#define PAGE_NOACCESS          0x01
+#define PAGE_READONLY          0x02
+#define PAGE_READWRITE         0x04
+#define PAGE_WRITECOPY         0x08
+#define PAGE_EXECUTE           0x10
+#define PAGE_EXECUTE_READ      0x20
+#define PAGE_EXECUTE_READWRITE 0x40
+#define PAGE_EXECUTE_WRITECOPY 0x80
+#define PAGE_GUARD             0x100
+
+struct MEMORY_BASIC_INFORMATION
+{
+	PVOID BaseAddress;
+	PVOID AllocationBase;
+	ULONG AllocationProtect;
+	SIZE_T RegionSize;
+	ULONG State;
+	ULONG Protect;
+	ULONG Type;
+};
+
+template <typename TContext = PVOID>
+using ENUMERATE_VIRTUAL_MEMORY_WITH_CONTEXT = bool(*)(ULONG InIndex, MEMORY_BASIC_INFORMATION* InMemoryInformation, TContext InContext);
+
+template <typename TContext = PVOID>
+NTSTATUS CkEnumerateVirtualMemory(CONST PEPROCESS InProcess, TContext InContext, ENUMERATE_VIRTUAL_MEMORY_WITH_CONTEXT<TContext> InCallback)
+{
+	return STATUS_NOT_SUPPORTED;
+}
+
+inline NTSTATUS CkCopyVirtualMemory(CONST PEPROCESS InSourceProcess, CONST PVOID InSourceAddress, CONST PEPROCESS InDestinationProcess, PVOID InDestinationAddress, SIZE_T InNumberOfBytes, OPTIONAL OUT SIZE_T* OutNumberOfBytesCopied = nullptr)
+{
+	return STATUS_NOT_SUPPORTED;
+}
+
+struct PHYSICAL_MEMORY_RANGE
+{
+	PHYSICAL_ADDRESS BaseAddress;
+	LARGE_INTEGER NumberOfBytes;
+};
+
+#define MmNonCached 0
+#define MmCached    1
+
+inline PHYSICAL_MEMORY_RANGE* MmGetPhysicalMemoryRanges()
+{
+	return nullptr;
+}
+
+inline PVOID MmMapIoSpace(PHYSICAL_ADDRESS InPhysicalAddress, SIZE_T InNumberOfBytes, int InCacheType)
+{
+	return nullptr;
+}
+
+inline VOID MmUnmapIoSpace(PVOID InBaseAddress, SIZE_T InNumberOfBytes)
+{
+}
+
+union MM_COPY_ADDRESS
+{
+	PVOID VirtualAddress;
+	PHYSICAL_ADDRESS PhysicalAddress;
+};
+
+#define MM_COPY_MEMORY_PHYSICAL 0x1
+#define MM_COPY_MEMORY_VIRTUAL  0x2
+
+inline NTSTATUS MmCopyMemory(PVOID InTargetAddress, MM_COPY_ADDRESS InSourceAddress, SIZE_T InNumberOfBytes, ULONG InFlags, OUT SIZE_T* OutNumberOfBytesTransferred)
+{
+	*OutNumberOfBytesTransferred = 0;
+	return STATUS_NOT_SUPPORTED;
+}
+
+// 
+// Bitmaps.
+// 
+
+struct RTL_BITMAP
+{
+	ULONG SizeOfBitMap;
+	ULONG* Buffer;
+};
+
+typedef RTL_BITMAP* PRTL_BITMAP;
+
+inline VOID RtlInitializeBitMap(PRTL_BITMAP OutBitMap, ULONG* InBuffer, ULONG InSizeOfBitMap)
+{
+	OutBitMap->SizeOfBitMap = InSizeOfBitMap;
+	OutBitMap->Buffer = InBuffer;
+}
+
+inline VOID RtlClearAllBits(PRTL_BITMAP InBitMap)
+{
+	memset(InBitMap->Buffer, 0, ((InBitMap->SizeOfBitMap + 31) / 32) * sizeof(ULONG));
+}
+
+inline VOID RtlSetBit(PRTL_BITMAP InBitMap, ULONG InBitNumber)
+{
+	InBitMap->Buffer[InBitNumber / 32] |= 1UL << (InBitNumber % 32);
+}
+
+// 
+// Files.
+// 
+
+inline NTSTATUS CkGetFileBuffer(CONST WCHAR* InFilePath, OUT PVOID* OutBuffer, OUT SIZE_T* OutBufferSize)
+{
+	return STATUS_NOT_SUPPORTED;
+}
+
+inline NTSTATUS CkSetFileBuffer(CONST WCHAR* InFilePath, CONST PVOID InBuffer, SIZE_T InBufferSize)
+{
+	return STATUS_NOT_SUPPORTED;
+}
+
+// 
+// Portable executables, parsed from the image mapped at the given address.
+// 
+
+#define IMAGE_DOS_SIGNATURE 0x5A4D
+#define IMAGE_NT_SIGNATURE  0x00004550
+
+#define IMAGE_SIZEOF_SHORT_NAME 8
+
+#define IMAGE_SCN_CNT_CODE         0x00000020
+#define IMAGE_SCN_MEM_DISCARDABLE  0x02000000
+#define IMAGE_SCN_MEM_EXECUTE      0x20000000
+#define IMAGE_SCN_MEM_READ         0x40000000
+#define IMAGE_SCN_MEM_WRITE        0x80000000
+
+struct IMAGE_DOS_HEADER
+{
+	WORD e_magic;
+	WORD e_unused[29];
+	LONG e_lfanew;
+};
+
+struct IMAGE_FILE_HEADER
+{
+	WORD Machine;
+	WORD NumberOfSections;
+	DWORD TimeDateStamp;
+	DWORD PointerToSymbolTable;
+	DWORD NumberOfSymbols;
+	WORD SizeOfOptionalHeader;
+	WORD Characteristics;
+};
+
+struct IMAGE_OPTIONAL_HEADER
+{
+	WORD Magic;
+	BYTE MajorLinkerVersion;
+	BYTE MinorLinkerVersion;
+	DWORD SizeOfCode;
+	DWORD SizeOfInitializedData;
+	DWORD SizeOfUninitializedData;
+	DWORD AddressOfEntryPoint;
+	DWORD BaseOfCode;
+	ULONGLONG ImageBase;
+	DWORD SectionAlignment;
+	DWORD FileAlignment;
+	WORD MajorOperatingSystemVersion;
+	WORD MinorOperatingSystemVersion;
+	WORD MajorImageVersion;
+	WORD MinorImageVersion;
+	WORD MajorSubsystemVersion;
+	WORD MinorSubsystemVersion;
+	DWORD Win32VersionValue;
+	DWORD SizeOfImage;
+	DWORD SizeOfHeaders;
+	DWORD CheckSum;
+};
+
+struct IMAGE_NT_HEADERS
+{
+	DWORD Signature;
+	IMAGE_FILE_HEADER FileHeader;
+	IMAGE_OPTIONAL_HEADER OptionalHeader;
+};
+
+typedef IMAGE_NT_HEADERS* PIMAGE_NT_HEADERS;
+
+struct IMAGE_SECTION_HEADER
+{
+	BYTE Name[IMAGE_SIZEOF_SHORT_NAME];
+
+	union
+	{
+		DWORD PhysicalAddress;
+		DWORD VirtualSize;
+	} Misc;
+
+	DWORD VirtualAddress;
+	DWORD SizeOfRawData;
+	DWORD PointerToRawData;
+	DWORD PointerToRelocations;
+	DWORD PointerToLinenumbers;
+	WORD NumberOfRelocations;
+	WORD NumberOfLinenumbers;
+	DWORD Characteristics;
+};
+
+inline PIMAGE_NT_HEADERS RtlModuleNtHeaders(CONST PVOID InBaseAddress)
+{
+	auto* DosHeader = (IMAGE_DOS_HEADER*) InBaseAddress;
+
+	if (DosHeader == nullptr || DosHeader->e_magic != IMAGE_DOS_SIGNATURE)
+		return nullptr;
+
+	auto* NtHeaders = (PIMAGE_NT_HEADERS) RtlAddOffsetToPointer(InBaseAddress, DosHeader->e_lfanew);
+
+	if (NtHeaders->Signature != IMAGE_NT_SIGNATURE)
+		return nullptr;
+
+	return NtHeaders;
+}
+
+template <typename TContext = PVOID>
+NTSTATUS RtlEnumerateModuleSections(CONST PVOID InBaseAddress, TContext InContext, bool(*InCallback)(ULONG InIndex, IMAGE_SECTION_HEADER* InSectionHeader, TContext InContext))
+{
+	auto* NtHeaders = RtlModuleNtHeaders(InBaseAddress);
+
+	if (NtHeaders == nullptr)
+		return STATUS_INVALID_IMAGE_FORMAT;
+
+	auto* SectionHeaders = (IMAGE_SECTION_HEADER*) RtlAddOffsetToPointer(&NtHeaders->OptionalHeader, NtHeaders->FileHeader.SizeOfOptionalHeader);
+
+	for (ULONG I = 0; I < NtHeaders->FileHeader.NumberOfSections; I++)
+	{
+		if (InCallback(I, &SectionHeaders[I], InContext))
+			break;
+	}
+
+	return STATUS_SUCCESS;
+}
+
+inline PVOID ResolveRelativeAddress(CONST PVOID InBaseAddress, ULONG InRelativeAddressOffset, ULONG InTotalInstructionLength)
+{
+	CONST INT32 RelativeAddress = *(INT32*) RtlAddOffsetToPointer(InBaseAddress, InRelativeAddressOffset);
+	return RtlAddOffsetToPointer(InBaseAddress, (LONG64) InTotalInstructionLength + RelativeAddress);
+}
+
+// 
+// Library headers compiled unchanged.
+// 
+
+#include "Extensions/ChecksumExtensions.hpp"
+#include "Extensions/VersionExtensions.hpp"
+#include "Extensions/ScanExtensions.hpp"
+
+// 
+// The capabilities of the host processor, so the scan code selects the same engines as on Windows.
+// 
+
+inline CONST CK_SYSTEM_CAPABILITIES* CkGetSystemCapabilities()
+{
+	static CONST CK_SYSTEM_CAPABILITIES Capabilities = []
+	{
+		CK_SYSTEM_CAPABILITIES Capabilities = { };
+
+		if (__builtin_cpu_supports("avx2"))
+		{
+			Capabilities.SystemFeatures |= CK_SYSTEM_FEATURE_AVX_STATE;
+			Capabilities.ProcessorFeatures |= CK_PROCESSOR_FEATURE_AVX2;
+		}
+
+		return Capabilities;
+	}();
+
+	return &Capabilities;
+}
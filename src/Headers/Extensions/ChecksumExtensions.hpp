@@ -12,4 +12,21 @@ UINT8 CkCalculateFletcher(CONST PVOID InVirtualAddress, SIZE_T InNumberOfBytes);
 /// </summary>
 /// <param name="InVirtualAddress">The virtual address.</param>
 /// <param name="InNumberOfBytes">The number of bytes.</param>
-BOOLEAN CkValidateFletcher(CONST PVOID InVirtualAddress, SIZE_T InNumberOfBytes);
\ No newline at end of file
+BOOLEAN CkValidateFletcher(CONST PVOID InVirtualAddress, SIZE_T InNumberOfBytes);
+
+/// <summary>
+/// Calculates the 64-bit FNV-1a hash of the given memory range.
+/// </summary>
+/// <param name="InVirtualAddress">The virtual address.</param>
+/// <param name="InNumberOfBytes">The number of bytes.</param>
+/// <param name="InSeed">The hash to continue from, to hash several ranges together.</param>
+UINT64 CkCalculateFnv1a(CONST PVOID InVirtualAddress, SIZE_T InNumberOfBytes, UINT64 InSeed = 0xCBF29CE484222325);
+
+/// <summary>
+/// Calculates the 64-bit xxHash of the given memory range.
+/// </summary>
+/// <param name="InVirtualAddress">The virtual address.</param>
+/// <param name="InNumberOfBytes">The number of bytes.</param>
+/// <param name="InSeed">The seed.</param>
+///	<remarks>This hash consumes eight bytes at a time and is much faster than CkCalculateFnv1a on large ranges such as whole pages.</remarks>
+UINT64 CkCalculateXxHash64(CONST PVOID InVirtualAddress, SIZE_T InNumberOfBytes, UINT64 InSeed = 0);
\ No newline at end of file
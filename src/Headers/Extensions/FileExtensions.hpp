@@ -40,6 +40,42 @@ NTSTATUS CkGetFileBuffer(CONST CHAR* InFilePath, OUT PVOID* OutFileBuffer, OUT S
 ///	<remarks>The buffer needs to be released.</remarks>
 NTSTATUS CkGetFileBuffer(CONST WCHAR* InFilePath, OUT PVOID* OutFileBuffer, OUT SIZE_T* OutFileSize);
 
+// 
+// Writing.
+// 
+
+/// <summary>
+/// Creates or overwrites a file with the given content.
+/// </summary>
+/// <param name="InFilePath">The path of the file.</param>
+/// <param name="InFileBuffer">The file's content.</param>
+/// <param name="InFileSize">The size (in bytes) of the file's content.</param>
+NTSTATUS CkSetFileBuffer(ANSI_STRING InFilePath, CONST PVOID InFileBuffer, SIZE_T InFileSize);
+
+/// <summary>
+/// Creates or overwrites a file with the given content.
+/// </summary>
+/// <param name="InFilePath">The path of the file.</param>
+/// <param name="InFileBuffer">The file's content.</param>
+/// <param name="InFileSize">The size (in bytes) of the file's content.</param>
+NTSTATUS CkSetFileBuffer(UNICODE_STRING InFilePath, CONST PVOID InFileBuffer, SIZE_T InFileSize);
+
+/// <summary>
+/// Creates or overwrites a file with the given content.
+/// </summary>
+/// <param name="InFilePath">The path of the file.</param>
+/// <param name="InFileBuffer">The file's content.</param>
+/// <param name="InFileSize">The size (in bytes) of the file's content.</param>
+NTSTATUS CkSetFileBuffer(CONST CHAR* InFilePath, CONST PVOID InFileBuffer, SIZE_T InFileSize);
+
+/// <summary>
+/// Creates or overwrites a file with the given content.
+/// </summary>
+/// <param name="InFilePath">The path of the file.</param>
+/// <param name="InFileBuffer">The file's content.</param>
+/// <param name="InFileSize">The size (in bytes) of the file's content.</param>
+NTSTATUS CkSetFileBuffer(CONST WCHAR* InFilePath, CONST PVOID InFileBuffer, SIZE_T InFileSize);
+
 // 
 // Information.
 // 
@@ -4,6 +4,53 @@ typedef bool(* ENUMERATE_VIRTUAL_MEMORY)(ULONG InIndex, MEMORY_BASIC_INFORMATION
 template <typename TContext = PVOID>
 using ENUMERATE_VIRTUAL_MEMORY_WITH_CONTEXT = bool(*)(ULONG InIndex, MEMORY_BASIC_INFORMATION* InMemoryInformation, TContext InContext);
 
+/// <summary>
+/// A process and a handle to it, opened once and reused by the virtual memory routines.
+/// </summary>
+struct CK_PROCESS_CONTEXT
+{
+	PEPROCESS Process;
+	HANDLE Handle;
+};
+
+/// <summary>
+/// Opens a context for the given process, holding a handle reused by the virtual memory routines.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="OutContext">The context.</param>
+///	<remarks>The handle is a kernel handle, so the context can be used from any thread. It needs to be closed with CkCloseProcessContext.</remarks>
+NTSTATUS CkOpenProcessContext(CONST PEPROCESS InProcess, OUT CK_PROCESS_CONTEXT* OutContext);
+
+/// <summary>
+/// Closes a context previously opened with CkOpenProcessContext.
+/// </summary>
+/// <param name="InContext">The context.</param>
+VOID CkCloseProcessContext(CK_PROCESS_CONTEXT* InContext);
+
+// 
+// Skips the zeroing of the pages, when the caller knows they hold nothing worth clearing.
+// 
+
+#define CK_VIRTUAL_MEMORY_SKIP_ZEROING 0x00000001
+
+// 
+// Zeroes the committed pages, even those the memory manager just handed out zeroed.
+// 
+
+#define CK_VIRTUAL_MEMORY_FORCE_ZEROING 0x00000002
+
+/// <summary>
+/// Allocate virtual memory in a given process.
+/// </summary>
+/// <param name="InContext">The process context.</param>
+/// <param name="InNumberOfBytes">The number of bytes to allocate.</param>
+/// <param name="InAllocationType">The type of the allocation.</param>
+/// <param name="InProtection">The page protection.</param>
+/// <param name="InOutAllocationAddress">In: The address to allocate memory at / Out: The resulting allocation address.</param>
+/// <param name="InFlags">The zeroing flags, CK_VIRTUAL_MEMORY_SKIP_ZEROING or CK_VIRTUAL_MEMORY_FORCE_ZEROING.</param>
+///	<remarks>By default, the pages are only zeroed when committed without being reserved by the same call, as they may have been committed already.</remarks>
+NTSTATUS CkAllocateVirtualMemory(CONST CK_PROCESS_CONTEXT* InContext, SIZE_T InNumberOfBytes, ULONG InAllocationType, ULONG InProtection, IN OUT PVOID* InOutAllocationAddress, ULONG InFlags = 0);
+
 /// <summary>
 /// Allocate virtual memory in a given process.
 /// </summary>
@@ -12,7 +59,9 @@ using ENUMERATE_VIRTUAL_MEMORY_WITH_CONTEXT = bool(*)(ULONG InIndex, MEMORY_BASI
 /// <param name="InAllocationType">The type of the allocation.</param>
 /// <param name="InProtection">The page protection.</param>
 /// <param name="InOutAllocationAddress">In: The address to allocate memory at / Out: The resulting allocation address.</param>
-NTSTATUS CkAllocateVirtualMemory(CONST PEPROCESS InProcess, SIZE_T InNumberOfBytes, ULONG InAllocationType, ULONG InProtection, IN OUT PVOID* InOutAllocationAddress);
+/// <param name="InFlags">The zeroing flags, CK_VIRTUAL_MEMORY_SKIP_ZEROING or CK_VIRTUAL_MEMORY_FORCE_ZEROING.</param>
+///	<remarks>By default, the pages are only zeroed when committed without being reserved by the same call, as they may have been committed already.</remarks>
+NTSTATUS CkAllocateVirtualMemory(CONST PEPROCESS InProcess, SIZE_T InNumberOfBytes, ULONG InAllocationType, ULONG InProtection, IN OUT PVOID* InOutAllocationAddress, ULONG InFlags = 0);
 
 /// <summary>
 /// Releases virtual memory previously allocated in the given process.
@@ -21,7 +70,18 @@ NTSTATUS CkAllocateVirtualMemory(CONST PEPROCESS InProcess, SIZE_T InNumberOfByt
 /// <param name="InBaseAddress">The virtual address to free.</param>
 /// <param name="InNumberOfBytes">The number of bytes to free.</param>
 /// <param name="InFreeType">The type of the free.</param>
-NTSTATUS CkFreeVirtualMemory(CONST PEPROCESS InProcess, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes, ULONG InFreeType = MEM_RELEASE);
+/// <param name="InFlags">The zeroing flags, CK_VIRTUAL_MEMORY_SKIP_ZEROING to release the pages without clearing them first.</param>
+NTSTATUS CkFreeVirtualMemory(CONST PEPROCESS InProcess, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes, ULONG InFreeType = MEM_RELEASE, ULONG InFlags = 0);
+
+/// <summary>
+/// Releases virtual memory previously allocated in the given process.
+/// </summary>
+/// <param name="InContext">The process context.</param>
+/// <param name="InBaseAddress">The virtual address to free.</param>
+/// <param name="InNumberOfBytes">The number of bytes to free.</param>
+/// <param name="InFreeType">The type of the free.</param>
+/// <param name="InFlags">The zeroing flags, CK_VIRTUAL_MEMORY_SKIP_ZEROING to release the pages without clearing them first.</param>
+NTSTATUS CkFreeVirtualMemory(CONST CK_PROCESS_CONTEXT* InContext, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes, ULONG InFreeType = MEM_RELEASE, ULONG InFlags = 0);
 
 /// <summary>
 /// Zero the virtual memory previously allocated in the given process.
@@ -29,6 +89,7 @@ NTSTATUS CkFreeVirtualMemory(CONST PEPROCESS InProcess, CONST PVOID InBaseAddres
 /// <param name="InProcess">The process.</param>
 /// <param name="InBaseAddress">The virtual address to zero.</param>
 /// <param name="InNumberOfBytes">The number of bytes to zero.</param>
+///	<remarks>Large ranges are zeroed with non-temporal stores, so they do not evict the cache.</remarks>
 NTSTATUS CkZeroVirtualMemory(CONST PEPROCESS InProcess, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes);
 
 /// <summary>
@@ -51,6 +112,151 @@ NTSTATUS CkCopyVirtualMemory(CONST PEPROCESS InSourceProcess, CONST PVOID InSour
 /// <param name="OutNumberOfBytesCopied">The number of bytes copied.</param>
 NTSTATUS CkCopyVirtualMemory(CONST PVOID InSourceAddress, PVOID InDestinationAddress, SIZE_T InNumberOfBytes, OPTIONAL OUT SIZE_T* OutNumberOfBytesCopied = nullptr);
 
+/// <summary>
+/// A range of virtual memory copied as part of a batch.
+/// </summary>
+struct CK_COPY_DESCRIPTOR
+{
+	CONST VOID* SourceAddress;
+	PVOID DestinationAddress;
+	SIZE_T NumberOfBytes;
+	SIZE_T NumberOfBytesCopied;
+	NTSTATUS Status;
+};
+
+/// <summary>
+/// Copies a batch of virtual memory ranges from the source process into system buffers, attaching only once.
+/// </summary>
+/// <param name="InSourceProcess">The source process.</param>
+/// <param name="InOutDescriptors">The descriptors, receiving their number of bytes copied and their status.</param>
+/// <param name="InNumberOfDescriptors">The number of descriptors.</param>
+/// <param name="OutNumberOfFailures">The number of descriptors which were not entirely copied.</param>
+///	<remarks>Unless the source process is the current one, the destination buffers must lie in system space, as they are written while attached to the source process.</remarks>
+///	<returns>STATUS_SUCCESS if every descriptor was entirely copied, STATUS_PARTIAL_COPY otherwise.</returns>
+NTSTATUS CkCopyVirtualMemoryBatch(CONST PEPROCESS InSourceProcess, IN OUT CK_COPY_DESCRIPTOR* InOutDescriptors, ULONG InNumberOfDescriptors, OPTIONAL OUT ULONG* OutNumberOfFailures = nullptr);
+
+/// <summary>
+/// Copies every readable page of a virtual memory range from the source process into a system buffer, zero-filling the pages which could not be read.
+/// </summary>
+/// <param name="InSourceProcess">The source process.</param>
+/// <param name="InSourceAddress">The source virtual address.</param>
+/// <param name="InDestinationAddress">The destination virtual address.</param>
+/// <param name="InNumberOfBytes">The number of bytes to copy.</param>
+/// <param name="OutCopiedPages">The bitmap receiving a set bit for every source page which was copied, at least as large as the number of pages spanned by the range.</param>
+/// <param name="OutNumberOfBytesCopied">The number of bytes copied from readable pages.</param>
+///	<remarks>Unless the source process is the current one, the destination buffer must lie in system space. The whole range is copied while attached once, so a region with guard or decommitted pages is dumped in a single call.</remarks>
+///	<returns>STATUS_SUCCESS if every page was copied, STATUS_PARTIAL_COPY if some pages were zero-filled instead.</returns>
+NTSTATUS CkCopyVirtualMemorySparse(CONST PEPROCESS InSourceProcess, CONST PVOID InSourceAddress, PVOID InDestinationAddress, SIZE_T InNumberOfBytes, OPTIONAL OUT PRTL_BITMAP OutCopiedPages = nullptr, OPTIONAL OUT SIZE_T* OutNumberOfBytesCopied = nullptr);
+
+// 
+// The maximum number of worker threads of a copy queue.
+// 
+
+#define CK_COPY_QUEUE_MAXIMUM_WORKERS 16
+
+struct CK_COPY_QUEUE;
+struct CK_COPY_REQUEST;
+
+typedef VOID(* CK_COPY_COMPLETION_ROUTINE)(CK_COPY_REQUEST* InRequest, PVOID InContext);
+
+/// <summary>
+/// A batch of virtual memory ranges copied asynchronously from a process into system buffers.
+/// </summary>
+struct CK_COPY_REQUEST
+{
+	LIST_ENTRY ListEntry;
+	PEPROCESS SourceProcess;
+	CK_COPY_DESCRIPTOR* Descriptors;
+	ULONG NumberOfDescriptors;
+	ULONG NumberOfFailures;
+	NTSTATUS Status;
+	CK_COPY_COMPLETION_ROUTINE CompletionRoutine;
+	PVOID CompletionContext;
+	PKEVENT CompletionEvent;
+};
+
+/// <summary>
+/// Creates a queue of copy requests and starts its worker threads.
+/// </summary>
+/// <param name="InNumberOfWorkers">The number of worker threads, up to CK_COPY_QUEUE_MAXIMUM_WORKERS, or zero for one per processor.</param>
+/// <param name="OutQueue">The copy queue.</param>
+///	<remarks>This function must be called at PASSIVE_LEVEL. The queue needs to be destroyed with CkDestroyCopyQueue.</remarks>
+NTSTATUS CkCreateCopyQueue(ULONG InNumberOfWorkers, OUT CK_COPY_QUEUE** OutQueue);
+
+/// <summary>
+/// Stops the worker threads of a copy queue once every pending request is completed, then releases it.
+/// </summary>
+/// <param name="InQueue">The copy queue.</param>
+///	<remarks>This function must be called at PASSIVE_LEVEL, and no request may be submitted anymore once it is called.</remarks>
+VOID CkDestroyCopyQueue(CK_COPY_QUEUE* InQueue);
+
+/// <summary>
+/// Queues a copy request, executed asynchronously by a worker thread of the queue.
+/// </summary>
+/// <param name="InQueue">The copy queue.</param>
+/// <param name="InOutRequest">The request, receiving the number of failures and the status once completed.</param>
+///	<remarks>The request and its descriptors must stay valid until it is completed, and its destinations must lie in system space. Requests reading from the same process are grouped under a single attach. The completion routine runs on a worker thread at PASSIVE_LEVEL, before the completion event is signaled. This function can be called at DISPATCH_LEVEL.</remarks>
+///	<returns>STATUS_PENDING if the request was queued.</returns>
+NTSTATUS CkSubmitCopyRequest(CK_COPY_QUEUE* InQueue, IN OUT CK_COPY_REQUEST* InOutRequest);
+
+// 
+// The maximum number of hops of a pointer chain.
+// 
+
+#define CK_POINTER_CHAIN_MAXIMUM_DEPTH 16
+
+/// <summary>
+/// A chain of pointers followed from a base address, such as [[[BaseAddress + 0x10] + 0x48] + 0x8].
+/// </summary>
+///	<remarks>Each hop reads PointerSize bytes, 4 or 8, or the pointer size of the process when it is zero.</remarks>
+struct CK_POINTER_CHAIN
+{
+	PVOID BaseAddress;
+	CONST LONG* Offsets;
+	ULONG NumberOfOffsets;
+	ULONG PointerSize;
+	PVOID Address;
+	ULONG64 Value;
+	ULONG FailedDepth;
+	NTSTATUS Status;
+};
+
+/// <summary>
+/// Follows a pointer chain in the given process, attaching only once.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InOffsets">The offset added before each hop, the first one to the base address.</param>
+/// <param name="InNumberOfOffsets">The number of offsets, up to CK_POINTER_CHAIN_MAXIMUM_DEPTH.</param>
+/// <param name="OutAddress">The address read by the last hop, or by the hop which failed.</param>
+/// <param name="OutValue">The pointer-sized value read at the final address.</param>
+/// <param name="OutFailedDepth">The index of the offset whose hop could not be read.</param>
+///	<remarks>Each hop reads a pointer of the process, 4 bytes for a WoW64 process and 8 bytes otherwise.</remarks>
+NTSTATUS CkResolvePointerChain(CONST PEPROCESS InProcess, CONST PVOID InBaseAddress, CONST LONG* InOffsets, ULONG InNumberOfOffsets, OUT PVOID* OutAddress, OPTIONAL OUT ULONG64* OutValue = nullptr, OPTIONAL OUT ULONG* OutFailedDepth = nullptr);
+
+/// <summary>
+/// Follows a batch of pointer chains in the given process, attaching only once.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InOutChains">The chains, receiving their final address, value and status.</param>
+/// <param name="InNumberOfChains">The number of chains.</param>
+/// <param name="OutNumberOfFailures">The number of chains which could not be followed to the end.</param>
+///	<remarks>Chains sharing a base address and leading offsets read the shared hops only once. A hop whose address lies outside of the user space of the process fails with STATUS_INVALID_ADDRESS.</remarks>
+///	<returns>STATUS_SUCCESS if every chain was followed to the end, STATUS_PARTIAL_COPY otherwise.</returns>
+NTSTATUS CkResolvePointerChains(CONST PEPROCESS InProcess, IN OUT CK_POINTER_CHAIN* InOutChains, ULONG InNumberOfChains, OPTIONAL OUT ULONG* OutNumberOfFailures = nullptr);
+
+/// <summary>
+/// Preallocates a bounce buffer per processor for the pool copies of CkCopyVirtualMemory.
+/// </summary>
+///	<remarks>Without them, every pool copy allocates its own bounce buffer. They are released with CkFreeCopyBuffers, typically when the driver unloads.</remarks>
+NTSTATUS CkAllocateCopyBuffers();
+
+/// <summary>
+/// Releases the bounce buffers previously allocated with CkAllocateCopyBuffers.
+/// </summary>
+///	<remarks>Waits for the copies holding a buffer to give it back, the copies started meanwhile falling back to the pool. Must be called at PASSIVE_LEVEL.</remarks>
+VOID CkFreeCopyBuffers();
+
 // 
 // Information.
 // 
@@ -63,20 +269,28 @@ NTSTATUS CkCopyVirtualMemory(CONST PVOID InSourceAddress, PVOID InDestinationAdd
 /// <param name="OutMemoryInformation">The returned memory information.</param>
 NTSTATUS CkQueryVirtualMemory(CONST PEPROCESS InProcess, CONST PVOID InVirtualAddress, OPTIONAL OUT MEMORY_BASIC_INFORMATION* OutMemoryInformation);
 
+/// <summary>
+/// Queries information about the memory region located at the given virtual address.
+/// </summary>
+/// <param name="InContext">The process context.</param>
+/// <param name="InVirtualAddress">The virtual address of the region to lookup.</param>
+/// <param name="OutMemoryInformation">The returned memory information.</param>
+NTSTATUS CkQueryVirtualMemory(CONST CK_PROCESS_CONTEXT* InContext, CONST PVOID InVirtualAddress, OPTIONAL OUT MEMORY_BASIC_INFORMATION* OutMemoryInformation);
+
 /// <summary>
 /// Enumerates the memory regions in the given process and execute a callback for each entries.
 /// </summary>
-/// <param name="InProcess">The process.</param>
+/// <param name="InProcessContext">The process context.</param>
 /// <param name="InContext">The context.</param>
 /// <param name="InCallback">The callback.</param>
 template <typename TContext = PVOID>
-NTSTATUS CkEnumerateVirtualMemory(CONST PEPROCESS InProcess, TContext InContext, ENUMERATE_VIRTUAL_MEMORY_WITH_CONTEXT<TContext> InCallback)
+NTSTATUS CkEnumerateVirtualMemory(CONST CK_PROCESS_CONTEXT* InProcessContext, TContext InContext, ENUMERATE_VIRTUAL_MEMORY_WITH_CONTEXT<TContext> InCallback)
 {
 	// 
 	// Verify the passed parameters.
 	// 
 
-	if (InProcess == nullptr)
+	if (InProcessContext == nullptr)
 		return STATUS_INVALID_PARAMETER_1;
 
 	if (InCallback == nullptr)
@@ -97,7 +311,7 @@ NTSTATUS CkEnumerateVirtualMemory(CONST PEPROCESS InProcess, TContext InContext,
 		
 		MEMORY_BASIC_INFORMATION MemoryInformation;
 
-		if (NT_ERROR(CkQueryVirtualMemory(InProcess, CurrentAddress, &MemoryInformation)))
+		if (NT_ERROR(CkQueryVirtualMemory(InProcessContext, CurrentAddress, &MemoryInformation)))
 			break;
 
 		// 
@@ -119,6 +333,41 @@ NTSTATUS CkEnumerateVirtualMemory(CONST PEPROCESS InProcess, TContext InContext,
 	return Index != 0 ? STATUS_SUCCESS : STATUS_NO_MORE_ENTRIES;
 }
 
+/// <summary>
+/// Enumerates the memory regions in the given process and execute a callback for each entries.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback.</param>
+template <typename TContext = PVOID>
+NTSTATUS CkEnumerateVirtualMemory(CONST PEPROCESS InProcess, TContext InContext, ENUMERATE_VIRTUAL_MEMORY_WITH_CONTEXT<TContext> InCallback)
+{
+	NTSTATUS Status;
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InProcess == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InCallback == nullptr)
+		return STATUS_INVALID_PARAMETER_3;
+
+	// 
+	// Open the process once for every region.
+	// 
+
+	CK_PROCESS_CONTEXT ProcessContext;
+
+	if (NT_ERROR(Status = CkOpenProcessContext(InProcess, &ProcessContext)))
+		return Status;
+
+	Status = CkEnumerateVirtualMemory<TContext>(&ProcessContext, InContext, InCallback);
+	CkCloseProcessContext(&ProcessContext);
+	return Status;
+}
+
 /// <summary>
 /// Enumerates the memory regions in the given process and execute a callback for each entries.
 /// </summary>
@@ -129,19 +378,19 @@ NTSTATUS CkEnumerateVirtualMemory(CONST PEPROCESS InProcess, ENUMERATE_VIRTUAL_M
 /// <summary>
 /// Enumerates the memory regions in the given process and execute a callback for each entries inside the specified range.
 /// </summary>
-/// <param name="InProcess">The process.</param>
+/// <param name="InProcessContext">The process context.</param>
 /// <param name="InBaseAddress">The base address.</param>
 /// <param name="InNumberOfBytes">The number of bytes.</param>
 /// <param name="InContext">The context.</param>
 /// <param name="InCallback">The callback.</param>
 template <typename TContext = PVOID>
-NTSTATUS CkEnumerateVirtualMemoryInRange(CONST PEPROCESS InProcess, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes, TContext InContext, ENUMERATE_VIRTUAL_MEMORY_WITH_CONTEXT<TContext> InCallback)
+NTSTATUS CkEnumerateVirtualMemoryInRange(CONST CK_PROCESS_CONTEXT* InProcessContext, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes, TContext InContext, ENUMERATE_VIRTUAL_MEMORY_WITH_CONTEXT<TContext> InCallback)
 {
 	// 
 	// Verify the passed parameters.
 	// 
 
-	if (InProcess == nullptr)
+	if (InProcessContext == nullptr)
 		return STATUS_INVALID_PARAMETER_1;
 	
 	if (InBaseAddress == nullptr)
@@ -169,7 +418,7 @@ NTSTATUS CkEnumerateVirtualMemoryInRange(CONST PEPROCESS InProcess, CONST PVOID
 		
 		MEMORY_BASIC_INFORMATION MemoryInformation;
 
-		if (NT_ERROR(CkQueryVirtualMemory(InProcess, CurrentAddress, &MemoryInformation)))
+		if (NT_ERROR(CkQueryVirtualMemory(InProcessContext, CurrentAddress, &MemoryInformation)))
 			break;
 
 		// 
@@ -194,6 +443,43 @@ NTSTATUS CkEnumerateVirtualMemoryInRange(CONST PEPROCESS InProcess, CONST PVOID
 	return Index != 0 ? STATUS_SUCCESS : STATUS_NO_MORE_ENTRIES;
 }
 
+/// <summary>
+/// Enumerates the memory regions in the given process and execute a callback for each entries inside the specified range.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InNumberOfBytes">The number of bytes.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback.</param>
+template <typename TContext = PVOID>
+NTSTATUS CkEnumerateVirtualMemoryInRange(CONST PEPROCESS InProcess, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes, TContext InContext, ENUMERATE_VIRTUAL_MEMORY_WITH_CONTEXT<TContext> InCallback)
+{
+	NTSTATUS Status;
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InProcess == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InCallback == nullptr)
+		return STATUS_INVALID_PARAMETER_5;
+
+	// 
+	// Open the process once for every region.
+	// 
+
+	CK_PROCESS_CONTEXT ProcessContext;
+
+	if (NT_ERROR(Status = CkOpenProcessContext(InProcess, &ProcessContext)))
+		return Status;
+
+	Status = CkEnumerateVirtualMemoryInRange<TContext>(&ProcessContext, InBaseAddress, InNumberOfBytes, InContext, InCallback);
+	CkCloseProcessContext(&ProcessContext);
+	return Status;
+}
+
 /// <summary>
 /// Enumerates the memory regions in the given process and execute a callback for each entries inside the specified range.
 /// </summary>
@@ -202,3 +488,155 @@ NTSTATUS CkEnumerateVirtualMemoryInRange(CONST PEPROCESS InProcess, CONST PVOID
 /// <param name="InNumberOfBytes">The number of bytes.</param>
 /// <param name="InCallback">The callback.</param>
 NTSTATUS CkEnumerateVirtualMemoryInRange(CONST PEPROCESS InProcess, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes, ENUMERATE_VIRTUAL_MEMORY InCallback);
+
+// 
+// Snapshots.
+// 
+
+/// <summary>
+/// A memory region recorded in a snapshot.
+/// </summary>
+struct CK_MEMORY_REGION
+{
+	PVOID BaseAddress;
+	SIZE_T RegionSize;
+	ULONG State;
+	ULONG Protect;
+	ULONG Type;
+};
+
+/// <summary>
+/// The memory regions of a process, sorted by base address and covering its user address space without gaps.
+/// </summary>
+struct CK_MEMORY_SNAPSHOT
+{
+	CK_PROCESS_CONTEXT Context;
+	CK_MEMORY_REGION* Regions;
+	ULONG NumberOfRegions;
+	ULONG MaximumNumberOfRegions;
+};
+
+/// <summary>
+/// Takes a snapshot of the memory regions of the given process.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="OutSnapshot">The snapshot.</param>
+///	<remarks>The snapshot keeps a handle to the process and needs to be released with CkFreeMemorySnapshot.</remarks>
+NTSTATUS CkCreateMemorySnapshot(CONST PEPROCESS InProcess, OUT CK_MEMORY_SNAPSHOT* OutSnapshot);
+
+/// <summary>
+/// Releases a snapshot previously taken with CkCreateMemorySnapshot.
+/// </summary>
+/// <param name="InSnapshot">The snapshot.</param>
+VOID CkFreeMemorySnapshot(CK_MEMORY_SNAPSHOT* InSnapshot);
+
+/// <summary>
+/// Queries the memory regions inside the specified range again and replaces them in the snapshot.
+/// </summary>
+/// <param name="InOutSnapshot">The snapshot.</param>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InNumberOfBytes">The number of bytes.</param>
+/// <param name="OutNumberOfChangedRegions">The number of regions that were added or modified.</param>
+///	<remarks>Only the regions overlapping the range are queried, the rest of the snapshot is kept as is.</remarks>
+NTSTATUS CkRefreshMemorySnapshot(IN OUT CK_MEMORY_SNAPSHOT* InOutSnapshot, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes, OPTIONAL OUT ULONG* OutNumberOfChangedRegions = nullptr);
+
+/// <summary>
+/// Queries every memory region of the process again and replaces them in the snapshot.
+/// </summary>
+/// <param name="InOutSnapshot">The snapshot.</param>
+/// <param name="OutNumberOfChangedRegions">The number of regions that were added or modified.</param>
+NTSTATUS CkRefreshMemorySnapshot(IN OUT CK_MEMORY_SNAPSHOT* InOutSnapshot, OPTIONAL OUT ULONG* OutNumberOfChangedRegions = nullptr);
+
+/// <summary>
+/// Finds the memory region containing the given virtual address in the snapshot.
+/// </summary>
+/// <param name="InSnapshot">The snapshot.</param>
+/// <param name="InVirtualAddress">The virtual address.</param>
+/// <param name="OutRegion">The region.</param>
+NTSTATUS CkLookupMemorySnapshot(CONST CK_MEMORY_SNAPSHOT* InSnapshot, CONST PVOID InVirtualAddress, OUT CONST CK_MEMORY_REGION** OutRegion);
+
+/// <summary>
+/// Finds the memory regions overlapping the specified range in the snapshot.
+/// </summary>
+/// <param name="InSnapshot">The snapshot.</param>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InNumberOfBytes">The number of bytes.</param>
+/// <param name="OutRegions">The first region overlapping the range.</param>
+/// <param name="OutNumberOfRegions">The number of consecutive regions overlapping the range.</param>
+NTSTATUS CkLookupMemorySnapshotRange(CONST CK_MEMORY_SNAPSHOT* InSnapshot, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes, OUT CONST CK_MEMORY_REGION** OutRegions, OUT ULONG* OutNumberOfRegions);
+
+// 
+// Page hashes.
+// 
+
+// 
+// Keeps a copy of every hashed page, so the differences report which bytes changed.
+// 
+
+#define CK_PAGE_HASHES_KEEP_CONTENTS 0x00000001
+
+/// <summary>
+/// A range of pages whose hashes are recorded.
+/// </summary>
+struct CK_PAGE_HASH_RANGE
+{
+	PVOID BaseAddress;
+	ULONG NumberOfPages;
+	ULONG FirstPage;
+};
+
+/// <summary>
+/// The hashes of the pages of selected memory regions of a process.
+/// </summary>
+struct CK_PAGE_HASHES
+{
+	PEPROCESS Process;
+	ULONG Flags;
+	CK_PAGE_HASH_RANGE* Ranges;
+	ULONG NumberOfRanges;
+	ULONG NumberOfPages;
+	UINT64* Hashes;
+	PVOID Contents;
+};
+
+/// <summary>
+/// A page whose hash changed since it was recorded.
+/// </summary>
+struct CK_PAGE_DIFFERENCE
+{
+	PVOID PageAddress;
+	UINT64 PreviousHash;
+	UINT64 CurrentHash;
+	ULONG FirstChangedByte;
+	ULONG LastChangedByte;
+	ULONG NumberOfChangedBytes;
+};
+
+/// <summary>
+/// Records the hash of every page of the given memory regions of a process.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InRegions">The regions, typically selected from a memory snapshot.</param>
+/// <param name="InNumberOfRegions">The number of regions.</param>
+/// <param name="InFlags">The flags, CK_PAGE_HASHES_KEEP_CONTENTS to be able to report the changed bytes.</param>
+/// <param name="OutPageHashes">The page hashes.</param>
+///	<remarks>The pages are read with CkCopyVirtualMemoryBatch. A page which could not be read is recorded with a hash of zero. The page hashes need to be released with CkFreePageHashes.</remarks>
+NTSTATUS CkCreatePageHashes(CONST PEPROCESS InProcess, CONST CK_MEMORY_REGION* InRegions, ULONG InNumberOfRegions, ULONG InFlags, OUT CK_PAGE_HASHES* OutPageHashes);
+
+/// <summary>
+/// Releases the page hashes previously recorded with CkCreatePageHashes.
+/// </summary>
+/// <param name="InPageHashes">The page hashes.</param>
+VOID CkFreePageHashes(CK_PAGE_HASHES* InPageHashes);
+
+/// <summary>
+/// Hashes the recorded pages again and reports those whose hash changed.
+/// </summary>
+/// <param name="InOutPageHashes">The page hashes.</param>
+/// <param name="OutDifferences">The changed pages.</param>
+/// <param name="InMaximumNumberOfDifferences">The number of changed pages the differences array can hold.</param>
+/// <param name="OutNumberOfDifferences">The number of changed pages, which may exceed the size of the differences array.</param>
+/// <param name="InUpdate">Whether the changed pages become the new reference for the next comparison.</param>
+///	<remarks>Without CK_PAGE_HASHES_KEEP_CONTENTS, the changed bytes of a difference span the whole page.</remarks>
+///	<returns>STATUS_BUFFER_OVERFLOW if more pages changed than the differences array can hold, or the failure to read the process, such as when it is exiting, in which case the pages compared so far may already have been updated.</returns>
+NTSTATUS CkDiffPageHashes(IN OUT CK_PAGE_HASHES* InOutPageHashes, OUT CK_PAGE_DIFFERENCE* OutDifferences, ULONG InMaximumNumberOfDifferences, OUT ULONG* OutNumberOfDifferences, BOOLEAN InUpdate = FALSE);
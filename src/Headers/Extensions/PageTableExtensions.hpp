@@ -93,12 +93,25 @@ struct ADDRESS_TRANSLATION_INFO
 	MMPTE* Pte;
 };
 
+/// <summary>
+/// Gets a value indicating whether the page tables of a process can be walked from its directory table base, with four levels.
+/// </summary>
+///	<remarks>Five-level paging adds a level above the PXE, and the offset of the directory table base is only known on x64.</remarks>
+inline BOOLEAN CkPageTableWalkIsSupported()
+{
+	CONST auto* Capabilities = CkGetSystemCapabilities();
+
+	return Capabilities->ProcessDirectoryTableBaseOffset != 0 &&
+		   (Capabilities->SystemFeatures & CK_SYSTEM_FEATURE_FIVE_LEVEL_PAGING) == 0;
+}
+
 /// <summary>
 /// Retrieves the page table entries translating the given virtual address.
 /// </summary>
 /// <param name="InProcess">The process.</param>
 /// <param name="InVirtualAddress">The virtual address.</param>
 /// <param name="OutTranslationInfo">The returned virtual address translation information.</param>
+///	<returns>STATUS_NOT_SUPPORTED if the page tables cannot be walked with four levels.</returns>
 NTSTATUS CkVirtualAddressTranslation(CONST PEPROCESS InProcess, CONST PVOID InVirtualAddress, OUT ADDRESS_TRANSLATION_INFO* OutTranslationInfo);
 
 /// <summary>
@@ -106,6 +119,7 @@ NTSTATUS CkVirtualAddressTranslation(CONST PEPROCESS InProcess, CONST PVOID InVi
 /// </summary>
 /// <param name="InProcess">The process.</param>
 /// <param name="InCallback">The callback.</param>
+///	<returns>STATUS_NOT_SUPPORTED if the page tables cannot be walked with four levels.</returns>
 NTSTATUS CkEnumeratePxeOfProcess(CONST PEPROCESS InProcess, void(*InCallback)(ULONG, MMPXE*));
 
 /// <summary>
@@ -114,6 +128,7 @@ NTSTATUS CkEnumeratePxeOfProcess(CONST PEPROCESS InProcess, void(*InCallback)(UL
 /// <param name="InProcess">The process.</param>
 /// <param name="InContext">The context.</param>
 /// <param name="InCallback">The callback.</param>
+///	<returns>STATUS_NOT_SUPPORTED if the page tables cannot be walked with four levels.</returns>
 template <typename TContext = PVOID>
 NTSTATUS CkEnumeratePxeOfProcess(CONST PEPROCESS InProcess, TContext InContext, void(*InCallback)(ULONG, MMPXE*, TContext))
 {
@@ -127,6 +142,9 @@ NTSTATUS CkEnumeratePxeOfProcess(CONST PEPROCESS InProcess, TContext InContext,
 	if (InCallback == nullptr)
 		return STATUS_INVALID_PARAMETER_3;
 
+	if (!CkPageTableWalkIsSupported())
+		return STATUS_NOT_SUPPORTED;
+
 	// 
 	// Attach to the process.
 	// 
@@ -138,7 +156,7 @@ NTSTATUS CkEnumeratePxeOfProcess(CONST PEPROCESS InProcess, TContext InContext,
 	// Retrieve the process page tables directory base.
 	// 
 
-	ULONGLONG ProcessDirectoryBase = *(ULONGLONG*) RtlAddOffsetToPointer(InProcess, 0x28);
+	ULONGLONG ProcessDirectoryBase = *(ULONGLONG*) RtlAddOffsetToPointer(InProcess, CkGetSystemCapabilities()->ProcessDirectoryTableBaseOffset);
 	CR3 ProcessCr3 = { .value = ProcessDirectoryBase };
 
 	// 
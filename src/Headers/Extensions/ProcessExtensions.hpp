@@ -19,6 +19,10 @@ EXTERN_C NTKERNELAPI PPEB NTAPI PsGetProcessPeb(
     IN PEPROCESS Process
 );
 
+EXTERN_C NTKERNELAPI PVOID NTAPI PsGetProcessWow64Process(
+    IN PEPROCESS Process
+);
+
 #define PROCESS_TERMINATE 0x0001
 #define PROCESS_CREATE_THREAD 0x0002
 #define PROCESS_SET_SESSIONID 0x0004
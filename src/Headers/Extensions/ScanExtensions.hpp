@@ -1,5 +1,235 @@
 #pragma once
 
+/// <summary>
+/// A signature compiled from the IDA format, reusable across scans.
+/// </summary>
+struct CK_SIGNATURE
+{
+	CONST UINT8* Values;
+	CONST UINT8* Masks;
+	SIZE_T Length;
+	SIZE_T FirstAnchor;
+	SIZE_T SecondAnchor;
+	BOOLEAN HasAnchors;
+	SIZE_T RunOffset;
+	SIZE_T RunLength;
+	UINT8 Shifts[256];
+};
+
+/// <summary>
+/// Gets the value of an hexadecimal digit, or -1 if the character is not one.
+/// </summary>
+/// <param name="InCharacter">The character.</param>
+constexpr INT32 CkSignatureNibble(CHAR InCharacter)
+{
+	if (InCharacter >= '0' && InCharacter <= '9')
+		return InCharacter - '0';
+
+	if (InCharacter >= 'A' && InCharacter <= 'F')
+		return InCharacter - 'A' + 10;
+
+	if (InCharacter >= 'a' && InCharacter <= 'f')
+		return InCharacter - 'a' + 10;
+
+	return -1;
+}
+
+/// <summary>
+/// Parses the signature entry at the given position: a byte whose nibbles can be wildcards ("48", "4?", "?F", "??" or "?"), optionally followed by an explicit bitmask ("48&amp;F8").
+/// </summary>
+/// <param name="InSignature">The signature.</param>
+/// <param name="InOutStep">In: The position of the entry / Out: The position right after it.</param>
+/// <param name="OutValue">The value, with the ignored bits cleared.</param>
+/// <param name="OutMask">The mask of the bits to compare.</param>
+constexpr BOOLEAN CkParseSignatureEntry(CONST CHAR* InSignature, IN OUT SIZE_T* InOutStep, OUT UINT8* OutValue, OUT UINT8* OutMask)
+{
+	SIZE_T Step = *InOutStep;
+
+	// 
+	// A lone question mark is a whole byte wildcard.
+	// 
+
+	if (InSignature[Step] == '?' && InSignature[Step + 1] != '?' && CkSignatureNibble(InSignature[Step + 1]) == -1)
+	{
+		*OutValue = 0x00;
+		*OutMask = 0x00;
+		*InOutStep = Step + 1;
+		return TRUE;
+	}
+
+	// 
+	// Otherwise, each of the two nibbles is either an hexadecimal digit or a wildcard.
+	// 
+
+	UINT8 Value = 0x00;
+	UINT8 Mask = 0x00;
+
+	for (SIZE_T I = 0; I < 2; I++, Step++)
+	{
+		CONST INT32 Nibble = CkSignatureNibble(InSignature[Step]);
+
+		Value <<= 4;
+		Mask <<= 4;
+
+		if (Nibble != -1)
+		{
+			Value |= (UINT8) Nibble;
+			Mask |= 0x0F;
+		}
+		else if (InSignature[Step] != '?')
+		{
+			return FALSE;
+		}
+	}
+
+	// 
+	// An explicit bitmask further restricts the compared bits.
+	// 
+
+	if (InSignature[Step] == '&')
+	{
+		CONST INT32 High = CkSignatureNibble(InSignature[Step + 1]);
+		CONST INT32 Low = High != -1 ? CkSignatureNibble(InSignature[Step + 2]) : -1;
+
+		if (Low == -1)
+			return FALSE;
+
+		Mask &= (UINT8) (High << 4 | Low);
+		Step += 3;
+	}
+
+	*OutValue = Value & Mask;
+	*OutMask = Mask;
+	*InOutStep = Step;
+	return TRUE;
+}
+
+/// <summary>
+/// Counts the entries of a signature, or returns zero if it is invalid.
+/// </summary>
+/// <param name="InSignature">The signature.</param>
+constexpr SIZE_T CkCountSignatureEntries(CONST CHAR* InSignature)
+{
+	SIZE_T Length = 0;
+	SIZE_T Step = 0;
+
+	while (InSignature[Step])
+	{
+		if (InSignature[Step] == ' ' || InSignature[Step] == '-')
+		{
+			Step++;
+			continue;
+		}
+
+		UINT8 Value = 0;
+		UINT8 Mask = 0;
+
+		if (!CkParseSignatureEntry(InSignature, &Step, &Value, &Mask))
+			return 0;
+
+		Length++;
+	}
+
+	return Length;
+}
+
+/// <summary>
+/// A signature parsed at compile time into its value and mask arrays.
+/// </summary>
+/// <typeparam name="TLength">The number of entries.</typeparam>
+///	<remarks>Declare it with CK_SIGNATURE_LITERAL_OF, an invalid signature failing the build.</remarks>
+template <SIZE_T TLength>
+struct CK_SIGNATURE_LITERAL
+{
+	static_assert(TLength != 0, "The signature literal is empty or invalid.");
+
+	UINT8 Values[TLength];
+	UINT8 Masks[TLength];
+
+	consteval CK_SIGNATURE_LITERAL(CONST CHAR* InSignature) : Values { }, Masks { }
+	{
+		SIZE_T Length = 0;
+		SIZE_T Step = 0;
+
+		while (InSignature[Step])
+		{
+			if (InSignature[Step] == ' ' || InSignature[Step] == '-')
+			{
+				Step++;
+				continue;
+			}
+
+			CkParseSignatureEntry(InSignature, &Step, &Values[Length], &Masks[Length]);
+			Length++;
+		}
+	}
+};
+
+#define CK_SIGNATURE_LITERAL_OF(InSignature) CK_SIGNATURE_LITERAL<CkCountSignatureEntries(InSignature)>(InSignature)
+
+/// <summary>
+/// A set of compiled signatures matched together in a single pass.
+/// </summary>
+struct CK_SIGNATURE_SET;
+
+/// <summary>
+/// A cache of signature scan results, keyed by module build.
+/// </summary>
+struct CK_SIGNATURE_CACHE;
+
+/// <summary>
+/// A byte pattern with alternatives, ranges and gaps, compiled into instructions.
+/// </summary>
+struct CK_BYTE_PATTERN;
+
+// 
+// The maximum number of worker threads of a scan pool.
+// 
+
+#define CK_SCAN_POOL_MAXIMUM_WORKERS 64
+
+/// <summary>
+/// A pool of worker threads kept across parallel scans.
+/// </summary>
+struct CK_SCAN_POOL;
+
+/// <summary>
+/// A run of padding bytes.
+/// </summary>
+struct CK_PADDING_RUN
+{
+	SIZE_T Offset;
+	SIZE_T Length;
+};
+
+typedef bool(* ENUMERATE_PATTERNS_WITH_CONTEXT)(ULONG InIndex, PVOID InAddress, VOID* InContext);
+typedef bool(* ENUMERATE_PHYSICAL_PATTERNS_WITH_CONTEXT)(ULONG InIndex, PHYSICAL_ADDRESS InPhysicalAddress, PVOID InMappedAddress, VOID* InContext);
+typedef bool(* PHYSICAL_SCAN_PROGRESS)(ULONG64 InNumberOfBytesScanned, ULONG64 InTotalNumberOfBytes, PHYSICAL_ADDRESS InWindowAddress, CONST RTL_BITMAP* InSkippedPages, VOID* InContext);
+
+/// <summary>
+/// Compiles a signature written in the IDA format so it can be reused across scans.
+/// </summary>
+/// <param name="InSignature">The signature.</param>
+/// <param name="OutSignature">The compiled signature.</param>
+///	<remarks>The compiled signature needs to be released with CkFreeSignature.</remarks>
+NTSTATUS CkCompileSignature(CONST CHAR* InSignature, OUT CK_SIGNATURE** OutSignature);
+
+/// <summary>
+/// Releases a signature previously compiled with CkCompileSignature.
+/// </summary>
+/// <param name="InSignature">The compiled signature.</param>
+VOID CkFreeSignature(CK_SIGNATURE* InSignature);
+
+/// <summary>
+/// Initializes a signature over existing value and mask arrays, such as the ones of a signature literal.
+/// </summary>
+/// <param name="OutSignature">The signature.</param>
+/// <param name="InValues">The values, with the ignored bits cleared.</param>
+/// <param name="InMasks">The masks.</param>
+/// <param name="InLength">The number of entries.</param>
+///	<remarks>The arrays must outlive the signature, which does not need to be released.</remarks>
+VOID CkInitializeSignature(OUT CK_SIGNATURE* OutSignature, CONST UINT8* InValues, CONST UINT8* InMasks, SIZE_T InLength);
+
 /// <summary>
 /// Searches for a certain pattern inside the given memory range.
 /// </summary>
@@ -9,6 +239,84 @@
 /// <param name="OutResult">The result.</param>
 NTSTATUS CkTryFindPattern(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CHAR* InSignature, OPTIONAL OUT PVOID* OutResult = nullptr);
 
+/// <summary>
+/// Searches for a certain pattern inside the given memory range.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="OutResult">The result.</param>
+NTSTATUS CkTryFindPattern(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, OPTIONAL OUT PVOID* OutResult = nullptr);
+
+/// <summary>
+/// Searches for a certain pattern inside the given memory range.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The signature literal.</param>
+/// <param name="OutResult">The result.</param>
+template <SIZE_T TLength>
+NTSTATUS CkTryFindPattern(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_SIGNATURE_LITERAL<TLength>& InSignature, OPTIONAL OUT PVOID* OutResult = nullptr)
+{
+	CK_SIGNATURE Signature;
+	CkInitializeSignature(&Signature, InSignature.Values, InSignature.Masks, TLength);
+	return CkTryFindPattern(InBaseAddress, InSize, &Signature, OutResult);
+}
+
+/// <summary>
+/// Searches for every match of a certain pattern inside the given memory range.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback, executed with the ordinal of every match and returning true to stop the scan.</param>
+NTSTATUS CkFindAllPatterns(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, PVOID InContext, ENUMERATE_PATTERNS_WITH_CONTEXT InCallback);
+
+/// <summary>
+/// Searches for every match of a certain pattern inside the given memory range.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="OutResults">The results.</param>
+/// <param name="InMaximumNumberOfResults">The number of results the array can hold.</param>
+/// <param name="OutNumberOfResults">The number of results.</param>
+///	<returns>STATUS_BUFFER_OVERFLOW if there are more matches than the array can hold.</returns>
+NTSTATUS CkFindAllPatterns(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, OUT PVOID* OutResults, ULONG InMaximumNumberOfResults, OUT ULONG* OutNumberOfResults);
+
+/// <summary>
+/// Searches for every match of a certain pattern inside the given memory range.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The signature.</param>
+/// <param name="OutResults">The results.</param>
+/// <param name="InMaximumNumberOfResults">The number of results the array can hold.</param>
+/// <param name="OutNumberOfResults">The number of results.</param>
+///	<returns>STATUS_BUFFER_OVERFLOW if there are more matches than the array can hold.</returns>
+NTSTATUS CkFindAllPatterns(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CHAR* InSignature, OUT PVOID* OutResults, ULONG InMaximumNumberOfResults, OUT ULONG* OutNumberOfResults);
+
+/// <summary>
+/// Counts the matches of a certain pattern inside the given memory range, stopping once the maximum is reached.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="InMaximumCount">The count to stop at, zero to count every match.</param>
+/// <param name="OutCount">The number of matches.</param>
+NTSTATUS CkCountPatternMatches(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, ULONG InMaximumCount, OUT ULONG* OutCount);
+
+/// <summary>
+/// Counts the matches of a certain pattern inside the given memory range, stopping once the maximum is reached.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The signature.</param>
+/// <param name="InMaximumCount">The count to stop at, zero to count every match.</param>
+/// <param name="OutCount">The number of matches.</param>
+NTSTATUS CkCountPatternMatches(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CHAR* InSignature, ULONG InMaximumCount, OUT ULONG* OutCount);
+
 /// <summary>
 /// Searches for a successive pattern of a specific padding byte in the given memory range.
 /// </summary>
@@ -29,6 +337,19 @@ NTSTATUS CkTryFindPadding(CONST PVOID InBaseAddress, SIZE_T InSize, UINT8 InPadd
 /// <param name="OutResult">The result.</param>
 NTSTATUS CkTryFindPaddingFromEnd(CONST PVOID InBaseAddress, SIZE_T InSize, UINT8 InPaddingByte, SIZE_T InPaddingLength, OPTIONAL OUT PVOID* OutResult = nullptr);
 
+/// <summary>
+/// Searches for every run of a specific padding byte at least as long as the given length in the given memory range.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InPaddingByte">The padding byte.</param>
+/// <param name="InPaddingLength">The minimum padding length.</param>
+/// <param name="OutRuns">The runs, as offsets from the base address sorted by decreasing length.</param>
+/// <param name="InMaximumNumberOfRuns">The maximum number of runs.</param>
+/// <param name="OutNumberOfRuns">The number of runs.</param>
+///	<remarks>When there are more runs than the given maximum, the longest ones are returned with STATUS_BUFFER_OVERFLOW.</remarks>
+NTSTATUS CkFindAllPaddings(CONST PVOID InBaseAddress, SIZE_T InSize, UINT8 InPaddingByte, SIZE_T InPaddingLength, OUT CK_PADDING_RUN* OutRuns, ULONG InMaximumNumberOfRuns, OUT ULONG* OutNumberOfRuns);
+
 /// <summary>
 /// Searches for a certain pattern inside the given module's executable sections.
 /// </summary>
@@ -36,3 +357,272 @@ NTSTATUS CkTryFindPaddingFromEnd(CONST PVOID InBaseAddress, SIZE_T InSize, UINT8
 /// <param name="InSignature">The signature.</param>
 /// <param name="OutResult">The signature scan result.</param>
 NTSTATUS CkTryFindPatternInModuleExecutableSections(CONST PVOID InBaseAddress, CONST CHAR* InSignature, OPTIONAL OUT PVOID* OutResult = nullptr);
+
+/// <summary>
+/// Searches for a certain pattern inside the given module's executable sections.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="OutResult">The signature scan result.</param>
+NTSTATUS CkTryFindPatternInModuleExecutableSections(CONST PVOID InBaseAddress, CONST CK_SIGNATURE* InSignature, OPTIONAL OUT PVOID* OutResult = nullptr);
+
+/// <summary>
+/// Searches for a certain pattern inside the given module's executable sections.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSignature">The signature literal.</param>
+/// <param name="OutResult">The signature scan result.</param>
+template <SIZE_T TLength>
+NTSTATUS CkTryFindPatternInModuleExecutableSections(CONST PVOID InBaseAddress, CONST CK_SIGNATURE_LITERAL<TLength>& InSignature, OPTIONAL OUT PVOID* OutResult = nullptr)
+{
+	CK_SIGNATURE Signature;
+	CkInitializeSignature(&Signature, InSignature.Values, InSignature.Masks, TLength);
+	return CkTryFindPatternInModuleExecutableSections(InBaseAddress, &Signature, OutResult);
+}
+
+/// <summary>
+/// Searches for every match of a certain pattern inside the given module's executable sections.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback, executed with the ordinal of every match and returning true to stop the scan.</param>
+NTSTATUS CkFindAllPatternsInModuleExecutableSections(CONST PVOID InBaseAddress, CONST CK_SIGNATURE* InSignature, PVOID InContext, ENUMERATE_PATTERNS_WITH_CONTEXT InCallback);
+
+/// <summary>
+/// Searches for every run of a specific padding byte at least as long as the given length inside the given module's executable sections.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InPaddingByte">The padding byte.</param>
+/// <param name="InPaddingLength">The minimum padding length.</param>
+/// <param name="OutRuns">The runs, as relative virtual addresses sorted by decreasing length.</param>
+/// <param name="InMaximumNumberOfRuns">The maximum number of runs.</param>
+/// <param name="OutNumberOfRuns">The number of runs.</param>
+///	<remarks>When there are more runs than the given maximum, the longest ones are returned with STATUS_BUFFER_OVERFLOW.</remarks>
+NTSTATUS CkFindAllPaddingsInModuleExecutableSections(CONST PVOID InBaseAddress, UINT8 InPaddingByte, SIZE_T InPaddingLength, OUT CK_PADDING_RUN* OutRuns, ULONG InMaximumNumberOfRuns, OUT ULONG* OutNumberOfRuns);
+
+/// <summary>
+/// Searches for a certain pattern inside the given memory range, splitting the work across every processor.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="OutResult">The lowest match.</param>
+/// <param name="InPool">The optional scan pool, otherwise worker threads are started for this scan only.</param>
+///	<remarks>The region may lie in the address space of the current process, the workers attach to it. This function must be called at PASSIVE_LEVEL.</remarks>
+NTSTATUS CkTryFindPatternParallel(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, OPTIONAL OUT PVOID* OutResult = nullptr, OPTIONAL CK_SCAN_POOL* InPool = nullptr);
+
+/// <summary>
+/// Searches for a certain pattern inside the given module's executable sections, splitting the work across every processor.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="OutResult">The lowest match.</param>
+/// <param name="InPool">The optional scan pool, otherwise worker threads are started for this scan only.</param>
+///	<remarks>The module may be mapped in the address space of the current process, the workers attach to it. This function must be called at PASSIVE_LEVEL.</remarks>
+NTSTATUS CkTryFindPatternInModuleExecutableSectionsParallel(CONST PVOID InBaseAddress, CONST CK_SIGNATURE* InSignature, OPTIONAL OUT PVOID* OutResult = nullptr, OPTIONAL CK_SCAN_POOL* InPool = nullptr);
+
+/// <summary>
+/// Creates a pool of worker threads reused by the parallel scans, saving the cost of starting threads on every scan.
+/// </summary>
+/// <param name="InNumberOfWorkers">The number of worker threads, up to CK_SCAN_POOL_MAXIMUM_WORKERS, or zero for one per processor but the current one.</param>
+/// <param name="OutPool">The scan pool.</param>
+///	<remarks>This function must be called at PASSIVE_LEVEL. The pool needs to be destroyed with CkDestroyScanPool.</remarks>
+NTSTATUS CkCreateScanPool(ULONG InNumberOfWorkers, OUT CK_SCAN_POOL** OutPool);
+
+/// <summary>
+/// Stops the worker threads of a scan pool and releases it.
+/// </summary>
+/// <param name="InPool">The scan pool.</param>
+///	<remarks>This function must be called at PASSIVE_LEVEL, once no parallel scan uses the pool anymore.</remarks>
+VOID CkDestroyScanPool(CK_SCAN_POOL* InPool);
+
+/// <summary>
+/// Searches for every match of a certain pattern inside the committed and readable memory of the given process.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback, executed with the ordinal and the address in the process of every match and returning true to stop the scan.</param>
+///	<remarks>The memory is copied out in chunks through a bounce buffer, this function must be called at PASSIVE_LEVEL.</remarks>
+NTSTATUS CkFindAllPatternsInProcess(CONST PEPROCESS InProcess, CONST CK_SIGNATURE* InSignature, PVOID InContext, ENUMERATE_PATTERNS_WITH_CONTEXT InCallback);
+
+/// <summary>
+/// Searches for a certain pattern inside the committed and readable memory of the given process.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="OutResult">The address of the lowest match in the process.</param>
+///	<remarks>The memory is copied out in chunks through a bounce buffer, this function must be called at PASSIVE_LEVEL.</remarks>
+NTSTATUS CkTryFindPatternInProcess(CONST PEPROCESS InProcess, CONST CK_SIGNATURE* InSignature, OPTIONAL OUT PVOID* OutResult = nullptr);
+
+/// <summary>
+/// Searches for every match of a certain pattern inside the physical memory.
+/// </summary>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback, executed with the ordinal, the physical address and the mapped address of every match and returning true to stop the scan.</param>
+/// <param name="InProgressCallback">The optional callback, executed after each window with the number of bytes swept so far, skipped pages included, the physical address of the window and, if some of its pages could not be read, a bitmap with a set bit for each of them, and returning true to stop the scan.</param>
+///	<remarks>Only the RAM ranges are scanned, through cached windows of a few megabytes. The windows which cannot be mapped, such as the ones holding page tables, are copied page by page instead, and the pages which cannot be copied either are skipped. The mapped address, which then points into the copy, and the bitmap of skipped pages are only valid during the callbacks, this function must be called at PASSIVE_LEVEL.</remarks>
+NTSTATUS CkFindAllPatternsInPhysicalMemory(CONST CK_SIGNATURE* InSignature, PVOID InContext, ENUMERATE_PHYSICAL_PATTERNS_WITH_CONTEXT InCallback, OPTIONAL PHYSICAL_SCAN_PROGRESS InProgressCallback = nullptr);
+
+/// <summary>
+/// Compiles a set of signatures into an automaton matching all of them in a single pass.
+/// </summary>
+/// <param name="InSignatures">The compiled signatures.</param>
+/// <param name="InNumberOfSignatures">The number of signatures.</param>
+/// <param name="OutSignatureSet">The signature set.</param>
+///	<remarks>The signatures must outlive the set, which needs to be released with CkFreeSignatureSet.</remarks>
+NTSTATUS CkCompileSignatureSet(CONST CK_SIGNATURE* CONST* InSignatures, ULONG InNumberOfSignatures, OUT CK_SIGNATURE_SET** OutSignatureSet);
+
+/// <summary>
+/// Releases a signature set previously compiled with CkCompileSignatureSet.
+/// </summary>
+/// <param name="InSignatureSet">The signature set.</param>
+VOID CkFreeSignatureSet(CK_SIGNATURE_SET* InSignatureSet);
+
+/// <summary>
+/// Gets the number of signatures in the given set.
+/// </summary>
+/// <param name="InSignatureSet">The signature set.</param>
+ULONG CkGetSignatureSetCount(CONST CK_SIGNATURE_SET* InSignatureSet);
+
+/// <summary>
+/// Searches for every signature of the set inside the given memory range in a single pass.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignatureSet">The signature set.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback, executed for every match and returning true to stop the scan.</param>
+NTSTATUS CkEnumeratePatterns(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_SIGNATURE_SET* InSignatureSet, PVOID InContext, ENUMERATE_PATTERNS_WITH_CONTEXT InCallback);
+
+/// <summary>
+/// Searches for the first match of every signature of the set inside the given memory range in a single pass.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignatureSet">The signature set.</param>
+/// <param name="OutResults">The results, one per signature of the set, null for the signatures which were not found.</param>
+///	<returns>STATUS_SUCCESS if every signature was found, STATUS_NOT_FOUND otherwise.</returns>
+NTSTATUS CkTryFindPatterns(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_SIGNATURE_SET* InSignatureSet, OUT PVOID* OutResults);
+
+/// <summary>
+/// Searches for the first match of every signature of the set inside the given module's executable sections, scanning each section once.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSignatureSet">The signature set.</param>
+/// <param name="OutResults">The results, one per signature of the set, null for the signatures which were not found.</param>
+///	<returns>STATUS_SUCCESS if every signature was found, STATUS_NOT_FOUND otherwise.</returns>
+NTSTATUS CkTryFindPatternsInModuleExecutableSections(CONST PVOID InBaseAddress, CONST CK_SIGNATURE_SET* InSignatureSet, OUT PVOID* OutResults);
+
+/// <summary>
+/// An entry of a resolution table, locating an address through a signature and the instruction it matches.
+/// </summary>
+struct CK_SIGNATURE_RESOLUTION
+{
+	CONST CHAR* Signature;
+	LONG InstructionOffset;
+	ULONG RelativeAddressOffset;
+	ULONG InstructionLength;
+	PVOID* Result;
+	NTSTATUS Status;
+};
+
+/// <summary>
+/// Resolves every entry of the table inside the given module's executable sections, scanning each section once.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InOutEntries">The entries, receiving their result and their status.</param>
+/// <param name="InNumberOfEntries">The number of entries.</param>
+/// <param name="OutNumberOfFailures">The number of entries which could not be resolved.</param>
+///	<remarks>The instruction starts at the given offset from the match. Its relative address is followed as with ResolveRelativeAddress, unless the instruction length is zero in which case the instruction address itself is the result.</remarks>
+///	<returns>STATUS_SUCCESS if every entry was resolved, STATUS_NOT_FOUND otherwise, or the failure of the signature set, which every entry then receives as its status.</returns>
+NTSTATUS CkResolveSignatures(CONST PVOID InBaseAddress, CK_SIGNATURE_RESOLUTION* InOutEntries, ULONG InNumberOfEntries, OPTIONAL OUT ULONG* OutNumberOfFailures = nullptr);
+
+/// <summary>
+/// Compiles a byte pattern, which extends the IDA format with alternatives "(48 | 4C)", ranges "70..7F" and gaps "[2-6]".
+/// </summary>
+/// <param name="InPattern">The pattern.</param>
+/// <param name="OutPattern">The compiled byte pattern.</param>
+///	<remarks>Groups can be nested and alternatives can have different lengths, gaps skipping up to 255 bytes. The compiled byte pattern needs to be released with CkFreeBytePattern.</remarks>
+NTSTATUS CkCompileBytePattern(CONST CHAR* InPattern, OUT CK_BYTE_PATTERN** OutPattern);
+
+/// <summary>
+/// Releases a byte pattern previously compiled with CkCompileBytePattern.
+/// </summary>
+/// <param name="InPattern">The compiled byte pattern.</param>
+VOID CkFreeBytePattern(CK_BYTE_PATTERN* InPattern);
+
+/// <summary>
+/// Searches for the first match of a byte pattern inside the given memory range, in a single pass.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InPattern">The compiled byte pattern.</param>
+/// <param name="OutResult">The address of the match.</param>
+/// <param name="OutLength">The length of the shortest match at that address.</param>
+NTSTATUS CkTryFindBytePattern(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_BYTE_PATTERN* InPattern, OPTIONAL OUT PVOID* OutResult = nullptr, OPTIONAL OUT SIZE_T* OutLength = nullptr);
+
+/// <summary>
+/// Searches for every offset a byte pattern matches at, inside the given memory range.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InPattern">The compiled byte pattern.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback, executed with the ordinal of every match and returning true to stop the scan.</param>
+NTSTATUS CkFindAllBytePatterns(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_BYTE_PATTERN* InPattern, PVOID InContext, ENUMERATE_PATTERNS_WITH_CONTEXT InCallback);
+
+/// <summary>
+/// Searches for the first match of a byte pattern inside the given module's executable sections.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InPattern">The compiled byte pattern.</param>
+/// <param name="OutResult">The address of the match.</param>
+NTSTATUS CkTryFindBytePatternInModuleExecutableSections(CONST PVOID InBaseAddress, CONST CK_BYTE_PATTERN* InPattern, OPTIONAL OUT PVOID* OutResult = nullptr);
+
+/// <summary>
+/// Creates an empty signature cache.
+/// </summary>
+/// <param name="OutCache">The signature cache.</param>
+///	<remarks>The signature cache needs to be released with CkFreeSignatureCache.</remarks>
+NTSTATUS CkCreateSignatureCache(OUT CK_SIGNATURE_CACHE** OutCache);
+
+/// <summary>
+/// Releases a signature cache previously created with CkCreateSignatureCache or CkLoadSignatureCache.
+/// </summary>
+/// <param name="InCache">The signature cache.</param>
+VOID CkFreeSignatureCache(CK_SIGNATURE_CACHE* InCache);
+
+/// <summary>
+/// Loads a signature cache previously saved with CkSaveSignatureCache.
+/// </summary>
+/// <param name="InFilePath">The path of the file.</param>
+/// <param name="OutCache">The signature cache.</param>
+///	<remarks>The signature cache needs to be released with CkFreeSignatureCache.</remarks>
+NTSTATUS CkLoadSignatureCache(CONST WCHAR* InFilePath, OUT CK_SIGNATURE_CACHE** OutCache);
+
+/// <summary>
+/// Saves a signature cache to a file, so it can be loaded back with CkLoadSignatureCache.
+/// </summary>
+/// <param name="InCache">The signature cache.</param>
+/// <param name="InFilePath">The path of the file.</param>
+NTSTATUS CkSaveSignatureCache(CONST CK_SIGNATURE_CACHE* InCache, CONST WCHAR* InFilePath);
+
+/// <summary>
+/// Removes every result recorded for the build of the module at the given address, typically before it unloads.
+/// </summary>
+/// <param name="InCache">The signature cache.</param>
+/// <param name="InBaseAddress">The base address of the module.</param>
+NTSTATUS CkInvalidateSignatureCache(CK_SIGNATURE_CACHE* InCache, CONST PVOID InBaseAddress);
+
+/// <summary>
+/// Searches for a certain pattern inside the given module's executable sections, reusing the result recorded for this build of the module.
+/// </summary>
+/// <param name="InCache">The signature cache.</param>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="OutResult">The signature scan result.</param>
+///	<remarks>Builds are identified by the timestamp, the size and the checksum of the image, results being stored as relative addresses and verified before being reused. The cache is not synchronized.</remarks>
+NTSTATUS CkTryFindPatternInModuleExecutableSectionsCached(CK_SIGNATURE_CACHE* InCache, CONST PVOID InBaseAddress, CONST CK_SIGNATURE* InSignature, OPTIONAL OUT PVOID* OutResult = nullptr);
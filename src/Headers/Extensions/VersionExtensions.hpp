@@ -23,3 +23,44 @@ ULONG RtlGetVersionBuildNumber();
 /// Gets a value indicating whether the current platform is the one passed as argument.
 /// </summary>
 BOOLEAN RtlCurrentPlatformIs(BYTE InPlatform);
+
+// 
+// The features of the operating system recorded in the capability table.
+// 
+
+#define CK_SYSTEM_FEATURE_WINDOWS_11			0x00000001
+#define CK_SYSTEM_FEATURE_AVX_STATE				0x00000002
+#define CK_SYSTEM_FEATURE_FIVE_LEVEL_PAGING		0x00000004
+
+// 
+// The features of the processor recorded in the capability table.
+// 
+
+#define CK_PROCESSOR_FEATURE_AVX2				0x00000001
+
+/// <summary>
+/// The capabilities of the operating system and of the processor, and the structure offsets used by the library.
+/// </summary>
+///	<remarks>The offsets which are not known for the architecture the library is built for are zero.</remarks>
+struct CK_SYSTEM_CAPABILITIES
+{
+	ULONG MajorVersion;
+	ULONG MinorVersion;
+	ULONG BuildNumber;
+	BYTE Platform;
+	ULONG SystemFeatures;
+	ULONG ProcessorFeatures;
+	ULONG ProcessDirectoryTableBaseOffset;
+};
+
+/// <summary>
+/// Populates the capability table, querying the operating system and the processor only once.
+/// </summary>
+///	<remarks>This function should be called at PASSIVE_LEVEL from the entry point of the driver, otherwise the table is populated by the first function using it, which must then run at PASSIVE_LEVEL as well.</remarks>
+NTSTATUS CkInitializeSystemCapabilities();
+
+/// <summary>
+/// Gets the capability table, populating it first if needed.
+/// </summary>
+///	<remarks>Once the table is populated, this function can be called at DISPATCH_LEVEL.</remarks>
+CONST CK_SYSTEM_CAPABILITIES* CkGetSystemCapabilities();
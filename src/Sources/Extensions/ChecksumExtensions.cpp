@@ -23,4 +23,138 @@ UINT8 CkCalculateFletcher(CONST PVOID InVirtualAddress, SIZE_T InNumberOfBytes)
 BOOLEAN CkValidateFletcher(CONST PVOID InVirtualAddress, SIZE_T InNumberOfBytes)
 {
 	return CkCalculateFletcher(InVirtualAddress, InNumberOfBytes) == (UINT8) 0x00;
-}
\ No newline at end of file
+}
+
+/// <summary>
+/// Calculates the 64-bit FNV-1a hash of the given memory range.
+/// </summary>
+/// <param name="InVirtualAddress">The virtual address.</param>
+/// <param name="InNumberOfBytes">The number of bytes.</param>
+/// <param name="InSeed">The hash to continue from, to hash several ranges together.</param>
+UINT64 CkCalculateFnv1a(CONST PVOID InVirtualAddress, SIZE_T InNumberOfBytes, UINT64 InSeed)
+{
+	UINT64 Hash = InSeed;
+
+	for (SIZE_T I = 0; I < InNumberOfBytes; I++)
+	{
+		Hash ^= *(UINT8*) RtlAddOffsetToPointer(InVirtualAddress, I);
+		Hash *= 0x100000001B3;
+	}
+
+	return Hash;
+}
+
+// 
+// The primes of the 64-bit xxHash.
+// 
+
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+
+/// <summary>
+/// Mixes an eight bytes lane into an accumulator of the 64-bit xxHash.
+/// </summary>
+/// <param name="InAccumulator">The accumulator.</param>
+/// <param name="InLane">The lane.</param>
+static UINT64 XxHash64Round(UINT64 InAccumulator, UINT64 InLane)
+{
+	InAccumulator += InLane * XXH_PRIME64_2;
+	InAccumulator = RotateLeft64(InAccumulator, 31);
+	return InAccumulator * XXH_PRIME64_1;
+}
+
+/// <summary>
+/// Merges an accumulator of the 64-bit xxHash into the hash.
+/// </summary>
+/// <param name="InHash">The hash.</param>
+/// <param name="InAccumulator">The accumulator.</param>
+static UINT64 XxHash64MergeRound(UINT64 InHash, UINT64 InAccumulator)
+{
+	InHash ^= XxHash64Round(0, InAccumulator);
+	return InHash * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+/// <summary>
+/// Calculates the 64-bit xxHash of the given memory range.
+/// </summary>
+/// <param name="InVirtualAddress">The virtual address.</param>
+/// <param name="InNumberOfBytes">The number of bytes.</param>
+/// <param name="InSeed">The seed.</param>
+///	<remarks>This hash consumes eight bytes at a time and is much faster than CkCalculateFnv1a on large ranges such as whole pages.</remarks>
+UINT64 CkCalculateXxHash64(CONST PVOID InVirtualAddress, SIZE_T InNumberOfBytes, UINT64 InSeed)
+{
+	auto const* Input = (CONST UINT8*) InVirtualAddress;
+	auto const* End = Input + InNumberOfBytes;
+	UINT64 Hash;
+
+	// 
+	// Consume 32 bytes blocks into four independent accumulators.
+	// 
+
+	if (InNumberOfBytes >= 32)
+	{
+		UINT64 Accumulator1 = InSeed + XXH_PRIME64_1 + XXH_PRIME64_2;
+		UINT64 Accumulator2 = InSeed + XXH_PRIME64_2;
+		UINT64 Accumulator3 = InSeed;
+		UINT64 Accumulator4 = InSeed - XXH_PRIME64_1;
+
+		do
+		{
+			Accumulator1 = XxHash64Round(Accumulator1, *(UNALIGNED UINT64*) (Input + 0));
+			Accumulator2 = XxHash64Round(Accumulator2, *(UNALIGNED UINT64*) (Input + 8));
+			Accumulator3 = XxHash64Round(Accumulator3, *(UNALIGNED UINT64*) (Input + 16));
+			Accumulator4 = XxHash64Round(Accumulator4, *(UNALIGNED UINT64*) (Input + 24));
+			Input += 32;
+		}
+		while (Input + 32 <= End);
+
+		Hash = RotateLeft64(Accumulator1, 1) + RotateLeft64(Accumulator2, 7) + RotateLeft64(Accumulator3, 12) + RotateLeft64(Accumulator4, 18);
+		Hash = XxHash64MergeRound(Hash, Accumulator1);
+		Hash = XxHash64MergeRound(Hash, Accumulator2);
+		Hash = XxHash64MergeRound(Hash, Accumulator3);
+		Hash = XxHash64MergeRound(Hash, Accumulator4);
+	}
+	else
+	{
+		Hash = InSeed + XXH_PRIME64_5;
+	}
+
+	Hash += (UINT64) InNumberOfBytes;
+
+	// 
+	// Consume the remaining bytes.
+	// 
+
+	for (; Input + 8 <= End; Input += 8)
+	{
+		Hash ^= XxHash64Round(0, *(UNALIGNED UINT64*) Input);
+		Hash = RotateLeft64(Hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+	}
+
+	if (Input + 4 <= End)
+	{
+		Hash ^= (UINT64) (*(UNALIGNED UINT32*) Input) * XXH_PRIME64_1;
+		Hash = RotateLeft64(Hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+		Input += 4;
+	}
+
+	for (; Input < End; Input++)
+	{
+		Hash ^= (*Input) * XXH_PRIME64_5;
+		Hash = RotateLeft64(Hash, 11) * XXH_PRIME64_1;
+	}
+
+	// 
+	// Avalanche the bits.
+	// 
+
+	Hash ^= Hash >> 33;
+	Hash *= XXH_PRIME64_2;
+	Hash ^= Hash >> 29;
+	Hash *= XXH_PRIME64_3;
+	Hash ^= Hash >> 32;
+	return Hash;
+}
@@ -138,6 +138,107 @@ NTSTATUS CkGetFileBuffer(CONST WCHAR* InFilePath, OUT PVOID* OutFileBuffer, OUT
 	return CkGetFileBuffer(FilePath, OutFileBuffer, OutFileSize);
 }
 
+/// <summary>
+/// Creates or overwrites a file with the given content.
+/// </summary>
+/// <param name="InFilePath">The path of the file.</param>
+/// <param name="InFileBuffer">The file's content.</param>
+/// <param name="InFileSize">The size (in bytes) of the file's content.</param>
+NTSTATUS CkSetFileBuffer(ANSI_STRING InFilePath, CONST PVOID InFileBuffer, SIZE_T InFileSize)
+{
+	UNICODE_STRING FilePath;
+	NTSTATUS Status = RtlAnsiStringToUnicodeString(&FilePath, &InFilePath, TRUE);
+
+	if (NT_ERROR(Status))
+		return Status;
+
+	Status = CkSetFileBuffer(FilePath, InFileBuffer, InFileSize);
+	RtlFreeUnicodeString(&FilePath);
+	return Status;
+}
+
+/// <summary>
+/// Creates or overwrites a file with the given content.
+/// </summary>
+/// <param name="InFilePath">The path of the file.</param>
+/// <param name="InFileBuffer">The file's content.</param>
+/// <param name="InFileSize">The size (in bytes) of the file's content.</param>
+NTSTATUS CkSetFileBuffer(UNICODE_STRING InFilePath, CONST PVOID InFileBuffer, SIZE_T InFileSize)
+{
+	NTSTATUS Status;
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InFilePath.Buffer == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+	
+	if (InFileBuffer == nullptr && InFileSize != 0)
+		return STATUS_INVALID_PARAMETER_2;
+	
+	if (InFileSize > MAXULONG)
+		return STATUS_INVALID_PARAMETER_3;
+
+	// 
+	// Initialize the object attributes.
+	// 
+
+	OBJECT_ATTRIBUTES ObjectAttributes;
+	InitializeObjectAttributes(&ObjectAttributes, &InFilePath, OBJ_CASE_INSENSITIVE | OBJ_KERNEL_HANDLE, NULL, NULL);
+
+	// 
+	// Create or truncate the file.
+	// 
+	
+	HANDLE FileHandle = nullptr;
+	IO_STATUS_BLOCK IoStatusBlock = { };
+	
+	if (NT_ERROR(Status = ZwCreateFile(&FileHandle, FILE_GENERIC_WRITE, &ObjectAttributes, &IoStatusBlock, NULL, FILE_ATTRIBUTE_NORMAL, 0, FILE_OVERWRITE_IF, FILE_SYNCHRONOUS_IO_NONALERT | FILE_NON_DIRECTORY_FILE, NULL, 0)))
+		return Status;
+
+	// 
+	// Write the file's content.
+	// 
+
+	if (InFileSize != 0)
+	{
+		LARGE_INTEGER ByteOffset;
+		ByteOffset.QuadPart = 0;
+
+		Status = ZwWriteFile(FileHandle, NULL, NULL, NULL, &IoStatusBlock, InFileBuffer, (ULONG) InFileSize, &ByteOffset, NULL);
+	}
+
+	ZwClose(FileHandle);
+	return Status;
+}
+
+/// <summary>
+/// Creates or overwrites a file with the given content.
+/// </summary>
+/// <param name="InFilePath">The path of the file.</param>
+/// <param name="InFileBuffer">The file's content.</param>
+/// <param name="InFileSize">The size (in bytes) of the file's content.</param>
+NTSTATUS CkSetFileBuffer(CONST CHAR* InFilePath, CONST PVOID InFileBuffer, SIZE_T InFileSize)
+{
+	ANSI_STRING FilePath;
+	RtlInitAnsiString(&FilePath, InFilePath);
+	return CkSetFileBuffer(FilePath, InFileBuffer, InFileSize);
+}
+
+/// <summary>
+/// Creates or overwrites a file with the given content.
+/// </summary>
+/// <param name="InFilePath">The path of the file.</param>
+/// <param name="InFileBuffer">The file's content.</param>
+/// <param name="InFileSize">The size (in bytes) of the file's content.</param>
+NTSTATUS CkSetFileBuffer(CONST WCHAR* InFilePath, CONST PVOID InFileBuffer, SIZE_T InFileSize)
+{
+	UNICODE_STRING FilePath;
+	RtlInitUnicodeString(&FilePath, InFilePath);
+	return CkSetFileBuffer(FilePath, InFileBuffer, InFileSize);
+}
+
 /// <summary>
 /// Opens an existing file and returns the total length of its content.
 /// </summary>
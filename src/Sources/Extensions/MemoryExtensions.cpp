@@ -1,14 +1,89 @@
 #include "../../Headers/EasyNT.h"
 
+// 
+// Process contexts.
+// 
+
 /// <summary>
-/// Allocate virtual memory in a given process.
+/// Opens a context for the given process, holding a handle reused by the virtual memory routines.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="OutContext">The context.</param>
+///	<remarks>The handle is a kernel handle, so the context can be used from any thread. It needs to be closed with CkCloseProcessContext.</remarks>
+NTSTATUS CkOpenProcessContext(CONST PEPROCESS InProcess, OUT CK_PROCESS_CONTEXT* OutContext)
+{
+	NTSTATUS Status = { };
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InProcess == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (OutContext == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	// 
+	// Open a handle to the process.
+	// 
+
+	HANDLE Handle = nullptr;
+
+	if (NT_ERROR(Status = ObOpenObjectByPointer(InProcess, OBJ_KERNEL_HANDLE | OBJ_CASE_INSENSITIVE, NULL, GENERIC_ALL, *PsProcessType, KernelMode, &Handle)))
+		return Status;
+
+	OutContext->Process = InProcess;
+	OutContext->Handle = Handle;
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Closes a context previously opened with CkOpenProcessContext.
+/// </summary>
+/// <param name="InContext">The context.</param>
+VOID CkCloseProcessContext(CK_PROCESS_CONTEXT* InContext)
+{
+	if (InContext == nullptr || InContext->Handle == nullptr)
+		return;
+
+	if (InContext->Handle != ZwCurrentProcess())
+		ZwClose(InContext->Handle);
+
+	InContext->Process = nullptr;
+	InContext->Handle = nullptr;
+}
+
+/// <summary>
+/// Opens a context for the given process for the duration of a single call, reusing the current process pseudo-handle when possible.
 /// </summary>
 /// <param name="InProcess">The process.</param>
+/// <param name="OutContext">The context, to be closed with CkCloseProcessContext.</param>
+static NTSTATUS CkOpenTemporaryProcessContext(CONST PEPROCESS InProcess, OUT CK_PROCESS_CONTEXT* OutContext)
+{
+	if (InProcess != PsGetCurrentProcess())
+		return CkOpenProcessContext(InProcess, OutContext);
+
+	OutContext->Process = InProcess;
+	OutContext->Handle = ZwCurrentProcess();
+	return STATUS_SUCCESS;
+}
+
+// 
+// Allocation.
+// 
+
+/// <summary>
+/// Allocate virtual memory in a given process.
+/// </summary>
+/// <param name="InContext">The process context.</param>
 /// <param name="InNumberOfBytes">The number of bytes to allocate.</param>
 /// <param name="InAllocationType">The type of the allocation.</param>
 /// <param name="InProtection">The page protection.</param>
 /// <param name="InOutAllocationAddress">In: The address to allocate memory at / Out: The resulting allocation address.</param>
-NTSTATUS CkAllocateVirtualMemory(CONST PEPROCESS InProcess, SIZE_T InNumberOfBytes, ULONG InAllocationType, ULONG InProtection, IN OUT PVOID* InOutAllocationAddress)
+/// <param name="InFlags">The zeroing flags, CK_VIRTUAL_MEMORY_SKIP_ZEROING or CK_VIRTUAL_MEMORY_FORCE_ZEROING.</param>
+///	<remarks>By default, the pages are only zeroed when committed without being reserved by the same call, as they may have been committed already.</remarks>
+NTSTATUS CkAllocateVirtualMemory(CONST CK_PROCESS_CONTEXT* InContext, SIZE_T InNumberOfBytes, ULONG InAllocationType, ULONG InProtection, IN OUT PVOID* InOutAllocationAddress, ULONG InFlags)
 {
 	NTSTATUS Status = { };
 
@@ -16,7 +91,7 @@ NTSTATUS CkAllocateVirtualMemory(CONST PEPROCESS InProcess, SIZE_T InNumberOfByt
 	// Verify the passed parameters.
 	// 
 
-	if (InProcess == nullptr)
+	if (InContext == nullptr || InContext->Handle == nullptr)
 		return STATUS_INVALID_PARAMETER_1;
 
 	if (InNumberOfBytes == 0)
@@ -31,15 +106,8 @@ NTSTATUS CkAllocateVirtualMemory(CONST PEPROCESS InProcess, SIZE_T InNumberOfByt
 	if (InOutAllocationAddress == nullptr)
 		return STATUS_INVALID_PARAMETER_5;
 
-	// 
-	// Open a handle to the process.
-	// 
-
-	auto* Handle = ZwCurrentProcess();
-
-	if (InProcess != PsGetCurrentProcess())
-		if (NT_ERROR(Status = ObOpenObjectByPointer(InProcess, OBJ_KERNEL_HANDLE | OBJ_CASE_INSENSITIVE, NULL, GENERIC_ALL, *PsProcessType, KernelMode, &Handle)))
-			return Status;
+	if ((InFlags & CK_VIRTUAL_MEMORY_SKIP_ZEROING) && (InFlags & CK_VIRTUAL_MEMORY_FORCE_ZEROING))
+		return STATUS_INVALID_PARAMETER_6;
 
 	// 
 	// Allocate virtual memory.
@@ -47,14 +115,7 @@ NTSTATUS CkAllocateVirtualMemory(CONST PEPROCESS InProcess, SIZE_T InNumberOfByt
 
 	SIZE_T NumberOfBytes = InNumberOfBytes;
 	PVOID BaseAddress = *InOutAllocationAddress;
-	Status = ZwAllocateVirtualMemory(Handle, &BaseAddress, 0, &NumberOfBytes, InAllocationType, InProtection);
-
-	// 
-	// If we opened a handle for the process, close it.
-	// 
-
-	if (Handle != ZwCurrentProcess())
-		ZwClose(Handle);
+	Status = ZwAllocateVirtualMemory(InContext->Handle, &BaseAddress, 0, &NumberOfBytes, InAllocationType, InProtection);
 
 	// 
 	// If the allocation was successful...
@@ -63,10 +124,19 @@ NTSTATUS CkAllocateVirtualMemory(CONST PEPROCESS InProcess, SIZE_T InNumberOfByt
 	if (NT_SUCCESS(Status))
 	{
 		// 
-		// Zero the page(s).
+		// Zero the page(s), unless they were just reserved and thus handed out zeroed.
 		// 
 
-		CkZeroVirtualMemory(InProcess, BaseAddress, NumberOfBytes);
+		BOOLEAN ZeroPages = (InAllocationType & MEM_COMMIT) && !(InAllocationType & MEM_RESERVE);
+
+		if (InFlags & CK_VIRTUAL_MEMORY_FORCE_ZEROING)
+			ZeroPages = (InAllocationType & MEM_COMMIT) != 0;
+
+		if (InFlags & CK_VIRTUAL_MEMORY_SKIP_ZEROING)
+			ZeroPages = FALSE;
+
+		if (ZeroPages)
+			CkZeroVirtualMemory(InContext->Process, BaseAddress, NumberOfBytes);
 
 		// 
 		// Return the allocation address.
@@ -79,13 +149,16 @@ NTSTATUS CkAllocateVirtualMemory(CONST PEPROCESS InProcess, SIZE_T InNumberOfByt
 }
 
 /// <summary>
-/// Releases virtual memory previously allocated in the given process.
+/// Allocate virtual memory in a given process.
 /// </summary>
 /// <param name="InProcess">The process.</param>
-/// <param name="InBaseAddress">The virtual address to free.</param>
-/// <param name="InNumberOfBytes">The number of bytes to free.</param>
-/// <param name="InFreeType">The type of the free.</param>
-NTSTATUS CkFreeVirtualMemory(CONST PEPROCESS InProcess, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes, ULONG InFreeType)
+/// <param name="InNumberOfBytes">The number of bytes to allocate.</param>
+/// <param name="InAllocationType">The type of the allocation.</param>
+/// <param name="InProtection">The page protection.</param>
+/// <param name="InOutAllocationAddress">In: The address to allocate memory at / Out: The resulting allocation address.</param>
+/// <param name="InFlags">The zeroing flags, CK_VIRTUAL_MEMORY_SKIP_ZEROING or CK_VIRTUAL_MEMORY_FORCE_ZEROING.</param>
+///	<remarks>By default, the pages are only zeroed when committed without being reserved by the same call, as they may have been committed already.</remarks>
+NTSTATUS CkAllocateVirtualMemory(CONST PEPROCESS InProcess, SIZE_T InNumberOfBytes, ULONG InAllocationType, ULONG InProtection, IN OUT PVOID* InOutAllocationAddress, ULONG InFlags)
 {
 	NTSTATUS Status = { };
 
@@ -96,6 +169,37 @@ NTSTATUS CkFreeVirtualMemory(CONST PEPROCESS InProcess, CONST PVOID InBaseAddres
 	if (InProcess == nullptr)
 		return STATUS_INVALID_PARAMETER_1;
 
+	// 
+	// Open a context for the process, for this call only.
+	// 
+
+	CK_PROCESS_CONTEXT Context;
+
+	if (NT_ERROR(Status = CkOpenTemporaryProcessContext(InProcess, &Context)))
+		return Status;
+
+	Status = CkAllocateVirtualMemory(&Context, InNumberOfBytes, InAllocationType, InProtection, InOutAllocationAddress, InFlags);
+	CkCloseProcessContext(&Context);
+	return Status;
+}
+
+/// <summary>
+/// Releases virtual memory previously allocated in the given process.
+/// </summary>
+/// <param name="InContext">The process context.</param>
+/// <param name="InBaseAddress">The virtual address to free.</param>
+/// <param name="InNumberOfBytes">The number of bytes to free.</param>
+/// <param name="InFreeType">The type of the free.</param>
+/// <param name="InFlags">The zeroing flags, CK_VIRTUAL_MEMORY_SKIP_ZEROING to release the pages without clearing them first.</param>
+NTSTATUS CkFreeVirtualMemory(CONST CK_PROCESS_CONTEXT* InContext, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes, ULONG InFreeType, ULONG InFlags)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InContext == nullptr || InContext->Handle == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
 	if (InBaseAddress == nullptr)
 		return STATUS_INVALID_PARAMETER_2;
 
@@ -106,21 +210,11 @@ NTSTATUS CkFreeVirtualMemory(CONST PEPROCESS InProcess, CONST PVOID InBaseAddres
 		return STATUS_INVALID_PARAMETER_4;
 
 	// 
-	// Open a handle to the process.
-	// 
-
-	auto* Handle = ZwCurrentProcess();
-
-	if (InProcess != PsGetCurrentProcess())
-		if (NT_ERROR(Status = ObOpenObjectByPointer(InProcess, OBJ_KERNEL_HANDLE | OBJ_CASE_INSENSITIVE, NULL, GENERIC_ALL, *PsProcessType, KernelMode, &Handle)))
-			return Status;
-
-	// 
-	// Zero the virtual memory.
+	// Zero the virtual memory, unless asked not to.
 	// 
 
-	if (InNumberOfBytes != 0)
-		CkZeroVirtualMemory(InProcess, InBaseAddress, InNumberOfBytes);
+	if (!(InFlags & CK_VIRTUAL_MEMORY_SKIP_ZEROING))
+		CkZeroVirtualMemory(InContext->Process, InBaseAddress, InNumberOfBytes);
 	
 	// 
 	// Release the virtual memory.
@@ -128,24 +222,103 @@ NTSTATUS CkFreeVirtualMemory(CONST PEPROCESS InProcess, CONST PVOID InBaseAddres
 
 	auto* VirtualAddress = InBaseAddress;
 	auto  VirtualSize = InFreeType == MEM_RELEASE ? 0 : InNumberOfBytes;
-	Status = ZwFreeVirtualMemory(Handle, &VirtualAddress, &VirtualSize, InFreeType);
+	return ZwFreeVirtualMemory(InContext->Handle, &VirtualAddress, &VirtualSize, InFreeType);
+}
+
+/// <summary>
+/// Releases virtual memory previously allocated in the given process.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InBaseAddress">The virtual address to free.</param>
+/// <param name="InNumberOfBytes">The number of bytes to free.</param>
+/// <param name="InFreeType">The type of the free.</param>
+/// <param name="InFlags">The zeroing flags, CK_VIRTUAL_MEMORY_SKIP_ZEROING to release the pages without clearing them first.</param>
+NTSTATUS CkFreeVirtualMemory(CONST PEPROCESS InProcess, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes, ULONG InFreeType, ULONG InFlags)
+{
+	NTSTATUS Status = { };
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InProcess == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
 
 	// 
-	// If we opened a handle for the process, close it.
+	// Open a context for the process, for this call only.
 	// 
 
-	if (Handle != ZwCurrentProcess())
-		ZwClose(Handle);
+	CK_PROCESS_CONTEXT Context;
+
+	if (NT_ERROR(Status = CkOpenTemporaryProcessContext(InProcess, &Context)))
+		return Status;
 
+	Status = CkFreeVirtualMemory(&Context, InBaseAddress, InNumberOfBytes, InFreeType, InFlags);
+	CkCloseProcessContext(&Context);
 	return Status;
 }
 
+// 
+// The size above which the virtual memory is zeroed with non-temporal stores.
+// 
+
+#define NON_TEMPORAL_ZERO_THRESHOLD (64 * PAGE_SIZE)
+
+/// <summary>
+/// Zeroes a range of memory with non-temporal stores, which bypass the cache.
+/// </summary>
+/// <param name="InBaseAddress">The virtual address to zero.</param>
+/// <param name="InNumberOfBytes">The number of bytes to zero.</param>
+static VOID CkZeroMemoryNonTemporal(PVOID InBaseAddress, SIZE_T InNumberOfBytes)
+{
+#if defined(_M_AMD64)
+	auto* Address = (volatile UINT8*) InBaseAddress;
+	auto* End = Address + InNumberOfBytes;
+
+	// 
+	// Zero the bytes up to the first 16 bytes boundary.
+	// 
+
+	while (Address < End && ((ULONG_PTR) Address & 15) != 0)
+		*Address++ = 0;
+
+	// 
+	// Stream the zeroes by blocks of 64 bytes, then 16 bytes.
+	// 
+
+	CONST __m128i Zero = _mm_setzero_si128();
+
+	for (; Address + 64 <= End; Address += 64)
+	{
+		_mm_stream_si128((__m128i*) (Address + 0), Zero);
+		_mm_stream_si128((__m128i*) (Address + 16), Zero);
+		_mm_stream_si128((__m128i*) (Address + 32), Zero);
+		_mm_stream_si128((__m128i*) (Address + 48), Zero);
+	}
+
+	for (; Address + 16 <= End; Address += 16)
+		_mm_stream_si128((__m128i*) Address, Zero);
+
+	// 
+	// Order the streamed stores before the remaining ones.
+	// 
+
+	_mm_sfence();
+
+	while (Address < End)
+		*Address++ = 0;
+#else
+	RtlSecureZeroMemory(InBaseAddress, InNumberOfBytes);
+#endif
+}
+
 /// <summary>
 /// Zero the virtual memory previously allocated in the given process.
 /// </summary>
 /// <param name="InProcess">The process.</param>
 /// <param name="InBaseAddress">The virtual address to zero.</param>
 /// <param name="InNumberOfBytes">The number of bytes to zero.</param>
+///	<remarks>Large ranges are zeroed with non-temporal stores, so they do not evict the cache.</remarks>
 NTSTATUS CkZeroVirtualMemory(CONST PEPROCESS InProcess, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes)
 {
 	NTSTATUS Status = { };
@@ -174,22 +347,33 @@ NTSTATUS CkZeroVirtualMemory(CONST PEPROCESS InProcess, CONST PVOID InBaseAddres
 	// Zero the virtual memory.
 	// 
 
-	RtlSecureZeroMemory(InBaseAddress, InNumberOfBytes);
+	__try
+	{
+		if (InNumberOfBytes >= NON_TEMPORAL_ZERO_THRESHOLD)
+			CkZeroMemoryNonTemporal(InBaseAddress, InNumberOfBytes);
+		else
+			RtlSecureZeroMemory(InBaseAddress, InNumberOfBytes);
+	}
+	__except (EXCEPTION_EXECUTE_HANDLER)
+	{
+		Status = GetExceptionCode();
+	}
 	
 	// 
 	// Detach from the process.
 	// 
 
 	KeUnstackDetachProcess(&ApcState);
-	return STATUS_SUCCESS;
+	return Status;
 }
 
 //
-// The maximum amount to try to Probe and Lock is 14 pages, this
-// way it always fits in a 16 page allocation.
+// The maximum amount to try to Probe and Lock is 62 pages, this
+// way it always fits in a 64 page allocation and each chunk of a
+// mapped copy costs a single pair of attaches.
 //
 
-#define MAX_LOCK_SIZE ((ULONG)(14 * PAGE_SIZE))
+#define MAX_LOCK_SIZE ((ULONG)(62 * PAGE_SIZE))
 
 //
 // The maximum to move in a single block is 64k bytes.
@@ -205,6 +389,137 @@ NTSTATUS CkZeroVirtualMemory(CONST PEPROCESS InProcess, CONST PVOID InBaseAddres
 
 #define COPY_STACK_SIZE 64
 
+//
+// The bounce buffers of the pool copies, one per processor, each of
+// them taken and given back atomically, under a rundown protection
+// so they are never released while a copy still holds one.
+//
+
+static PVOID* CopyBuffers = NULL;
+static ULONG NumberOfCopyBuffers = 0;
+static EX_RUNDOWN_REF CopyBuffersRundown = { 0 };
+
+/// <summary>
+/// Preallocates a bounce buffer per processor for the pool copies of CkCopyVirtualMemory.
+/// </summary>
+///	<remarks>Without them, every pool copy allocates its own bounce buffer. They are released with CkFreeCopyBuffers, typically when the driver unloads.</remarks>
+NTSTATUS CkAllocateCopyBuffers()
+{
+	// 
+	// Verify that the buffers were not already allocated.
+	// 
+
+	if (CopyBuffers != nullptr)
+		return STATUS_ALREADY_REGISTERED;
+
+	// 
+	// Allocate a buffer for every processor.
+	// 
+
+	CONST ULONG NumberOfProcessors = KeQueryActiveProcessorCountEx(ALL_PROCESSOR_GROUPS);
+	auto* Buffers = (PVOID*) CkAllocatePool(NonPagedPoolNx, NumberOfProcessors * sizeof(PVOID));
+
+	if (Buffers == nullptr)
+		return STATUS_INSUFFICIENT_RESOURCES;
+
+	for (ULONG I = 0; I < NumberOfProcessors; I++)
+	{
+		Buffers[I] = CkAllocatePool(NonPagedPoolNx, MAX_MOVE_SIZE);
+
+		if (Buffers[I] == nullptr)
+		{
+			while (I-- != 0)
+				CkFreePool(Buffers[I]);
+
+			CkFreePool(Buffers);
+			return STATUS_INSUFFICIENT_RESOURCES;
+		}
+	}
+
+	NumberOfCopyBuffers = NumberOfProcessors;
+	CopyBuffers = Buffers;
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Releases the bounce buffers previously allocated with CkAllocateCopyBuffers.
+/// </summary>
+///	<remarks>Waits for the copies holding a buffer to give it back, the copies started meanwhile falling back to the pool. Must be called at PASSIVE_LEVEL.</remarks>
+VOID CkFreeCopyBuffers()
+{
+	if (CopyBuffers == nullptr)
+		return;
+
+	// 
+	// Wait for every buffer to be given back to the cache.
+	// 
+
+	ExWaitForRundownProtectionRelease(&CopyBuffersRundown);
+
+	auto* Buffers = CopyBuffers;
+	CopyBuffers = nullptr;
+
+	for (ULONG I = 0; I < NumberOfCopyBuffers; I++)
+	{
+		if (Buffers[I] != nullptr)
+			CkFreePool(Buffers[I]);
+	}
+
+	NumberOfCopyBuffers = 0;
+	CkFreePool(Buffers);
+
+	// 
+	// Let the cache be allocated again.
+	// 
+
+	ExReInitializeRundownProtection(&CopyBuffersRundown);
+}
+
+/// <summary>
+/// Takes a bounce buffer out of the cache, starting with the one of the current processor.
+/// </summary>
+/// <param name="OutIndex">The index of the buffer, to give it back with MiReleaseCopyBuffer.</param>
+///	<returns>The buffer, or null if the cache was not allocated, is being released or every buffer is in use.</returns>
+static PVOID MiAcquireCopyBuffer(OUT ULONG* OutIndex)
+{
+	if (!ExAcquireRundownProtection(&CopyBuffersRundown))
+		return nullptr;
+
+	if (CopyBuffers == nullptr)
+	{
+		ExReleaseRundownProtection(&CopyBuffersRundown);
+		return nullptr;
+	}
+
+	CONST ULONG FirstIndex = KeGetCurrentProcessorNumberEx(nullptr) % NumberOfCopyBuffers;
+
+	for (ULONG I = 0; I < NumberOfCopyBuffers; I++)
+	{
+		CONST ULONG Index = (FirstIndex + I) % NumberOfCopyBuffers;
+		auto* Buffer = InterlockedExchangePointer(&CopyBuffers[Index], nullptr);
+
+		if (Buffer != nullptr)
+		{
+			*OutIndex = Index;
+			return Buffer;
+		}
+	}
+
+	ExReleaseRundownProtection(&CopyBuffersRundown);
+	return nullptr;
+}
+
+/// <summary>
+/// Gives a bounce buffer taken with MiAcquireCopyBuffer back to the cache.
+/// </summary>
+/// <param name="InIndex">The index of the buffer.</param>
+/// <param name="InBuffer">The buffer.</param>
+static VOID MiReleaseCopyBuffer(ULONG InIndex, PVOID InBuffer)
+{
+	InterlockedExchangePointer(&CopyBuffers[InIndex], InBuffer);
+	ExReleaseRundownProtection(&CopyBuffersRundown);
+}
+
 NTSTATUS
 MiDoPoolCopy(
 	IN PEPROCESS FromProcess,
@@ -247,6 +562,7 @@ Return Value:
 	PVOID PoolArea;
 	LONGLONG StackArray[COPY_STACK_SIZE];
 	ULONG FreePool;
+	ULONG CopyBufferIndex;
 	SIZE_T PageOffset;
 
 	PAGED_CODE();
@@ -274,15 +590,20 @@ Return Value:
 	}
 
 	FreePool = FALSE;
+	CopyBufferIndex = MAXULONG;
 	if (BufferSize <= sizeof(StackArray))
 	{
 		PoolArea = (PVOID)&StackArray[0];
 	}
-	else
+	else if ((PoolArea = MiAcquireCopyBuffer(&CopyBufferIndex)) == NULL)
 	{
+		//
+		// Without a cached buffer available, fall back to the pool.
+		//
+
 		do
 		{
-			PoolArea = ExAllocatePoolWithTag(NonPagedPool, MaximumMoved, 'wRmM');
+			PoolArea = ExAllocatePoolWithTag(NonPagedPoolNx, MaximumMoved, 'wRmM');
 			if (PoolArea != NULL)
 			{
 				FreePool = TRUE;
@@ -336,9 +657,14 @@ Return Value:
 			// ProbeForRead(FromAddress, BufferSize, sizeof(CHAR));
 		}
 
-		for (PageOffset = 0; PageOffset < PAGE_ROUND_UP(AmountToMove); PageOffset += PAGE_SIZE)
+		//
+		// Every source page spanned by this chunk must be resident, as the
+		// copy below runs without an exception handler.
+		//
+
+		for (PageOffset = 0; PageOffset < ADDRESS_AND_SIZE_TO_SPAN_PAGES(InVa, AmountToMove) * PAGE_SIZE; PageOffset += PAGE_SIZE)
 		{
-			if (!MmIsAddressValid(RtlAddOffsetToPointer(OutVa, PageOffset)))
+			if (!MmIsAddressValid(RtlAddOffsetToPointer(PAGE_ALIGN(InVa), PageOffset)))
 			{
 				ExceptionAddressConfirmed = TRUE;
 				goto BadAddress;
@@ -360,9 +686,9 @@ Return Value:
 			// ProbeForWrite(ToAddress, BufferSize, sizeof(CHAR));
 		}
 
-		for (PageOffset = 0; PageOffset < PAGE_ROUND_UP(AmountToMove); PageOffset += PAGE_SIZE)
+		for (PageOffset = 0; PageOffset < ADDRESS_AND_SIZE_TO_SPAN_PAGES(OutVa, AmountToMove) * PAGE_SIZE; PageOffset += PAGE_SIZE)
 		{
-			if (!MmIsAddressValid(RtlAddOffsetToPointer(OutVa, PageOffset)))
+			if (!MmIsAddressValid(RtlAddOffsetToPointer(PAGE_ALIGN(OutVa), PageOffset)))
 			{
 				ExceptionAddressConfirmed = TRUE;
 				goto BadAddress;
@@ -385,6 +711,10 @@ Return Value:
 			{
 				ExFreePool(PoolArea);
 			}
+			else if (CopyBufferIndex != MAXULONG)
+			{
+				MiReleaseCopyBuffer(CopyBufferIndex, PoolArea);
+			}
 
 			//
 			// If the failure occurred during the move operation, determine
@@ -408,6 +738,10 @@ Return Value:
 	{
 		ExFreePool(PoolArea);
 	}
+	else if (CopyBufferIndex != MAXULONG)
+	{
+		MiReleaseCopyBuffer(CopyBufferIndex, PoolArea);
+	}
 
 	//
 	// Set number of bytes moved.
@@ -418,24 +752,200 @@ Return Value:
 }
 
 NTSTATUS
-MmCopyVirtualMemoryImpl(
+MiDoMappedCopy(
 	IN PEPROCESS FromProcess,
 	IN CONST VOID* FromAddress,
 	IN PEPROCESS ToProcess,
 	OUT PVOID ToAddress,
 	IN SIZE_T BufferSize,
 	IN KPROCESSOR_MODE PreviousMode,
-	OUT PSIZE_T NumberOfBytesCopied
+	OUT PSIZE_T NumberOfBytesRead
 )
-{
-	NTSTATUS Status;
-	PEPROCESS ProcessToLock;
 
-	if (BufferSize == 0)
-	{
-		ASSERT(FALSE);         // No one should call with a zero size.
-		return STATUS_SUCCESS;
-	}
+/*++
+Routine Description:
+	This function copies the specified address range from the specified
+	process into the specified address range of the current process,
+	locking the source pages and mapping them into system space so the
+	data is only copied once.
+Arguments:
+	 FromProcess - Supplies the process to copy from.
+	 FromAddress - Supplies the base address in the FromProcess to be
+				   read.
+	 ToProcess - Supplies the process to copy to.
+	 ToAddress - Supplies the base address in the ToProcess which
+				 receives the contents.
+	 BufferSize - Supplies the requested number of bytes to copy.
+	 PreviousMode - Supplies the previous processor mode.
+	 NumberOfBytesRead - Receives the actual number of bytes
+						 transferred into the specified buffer.
+Return Value:
+	NTSTATUS.
+--*/
+
+{
+	KAPC_STATE ApcState;
+	SIZE_T AmountToMove;
+	LOGICAL ExceptionAddressConfirmed;
+	CONST VOID* InVa;
+	SIZE_T LeftToMove;
+	PVOID MappedAddress;
+	SIZE_T MaximumMoved;
+	PMDL Mdl;
+	PFN_NUMBER MdlHack[(sizeof(MDL) / sizeof(PFN_NUMBER)) + (MAX_LOCK_SIZE >> PAGE_SHIFT) + 1];
+	PVOID OutVa;
+	NTSTATUS Status;
+	SIZE_T PageOffset;
+
+	PAGED_CODE();
+
+	ASSERT(BufferSize != 0);
+
+	InVa = FromAddress;
+	OutVa = ToAddress;
+
+	MaximumMoved = MAX_LOCK_SIZE;
+	if (BufferSize <= MAX_LOCK_SIZE)
+	{
+		MaximumMoved = BufferSize;
+	}
+
+	Mdl = (PMDL)&MdlHack[0];
+
+	//
+	// Map the data into the system part of the address space, then copy it.
+	//
+
+	LeftToMove = BufferSize;
+	AmountToMove = MaximumMoved;
+
+	while (LeftToMove > 0)
+	{
+		if (LeftToMove < AmountToMove)
+		{
+			//
+			// Set to move the remaining bytes.
+			//
+
+			AmountToMove = LeftToMove;
+		}
+
+		KeStackAttachProcess(FromProcess, &ApcState);
+
+		//
+		// Lock the source pages, which raises if any of them is not
+		// accessible.
+		//
+
+		Status = STATUS_SUCCESS;
+		MmInitializeMdl(Mdl, (PVOID)InVa, AmountToMove);
+
+		__try
+		{
+			MmProbeAndLockPages(Mdl, PreviousMode, IoReadAccess);
+		}
+		__except (EXCEPTION_EXECUTE_HANDLER)
+		{
+			Status = GetExceptionCode();
+		}
+
+		KeUnstackDetachProcess(&ApcState);
+
+		if (!NT_SUCCESS(Status))
+		{
+			//
+			// Let the caller fall back to the pool copy when the working
+			// set quota is exhausted, otherwise report what was moved.
+			//
+
+			if (Status == STATUS_WORKING_SET_QUOTA)
+			{
+				return STATUS_WORKING_SET_QUOTA;
+			}
+
+			*NumberOfBytesRead = BufferSize - LeftToMove;
+			return STATUS_PARTIAL_COPY;
+		}
+
+		MappedAddress = MmMapLockedPagesSpecifyCache(Mdl,
+			KernelMode,
+			MmCached,
+			NULL,
+			FALSE,
+			HighPagePriority | MdlMappingNoExecute);
+
+		if (MappedAddress == NULL)
+		{
+			MmUnlockPages(Mdl);
+			return STATUS_WORKING_SET_QUOTA;
+		}
+
+		KeStackAttachProcess(ToProcess, &ApcState);
+
+		//
+		// Now operating in the context of the ToProcess, copy straight
+		// out of the mapping.
+		//
+
+		ExceptionAddressConfirmed = FALSE;
+
+		for (PageOffset = 0; PageOffset < ADDRESS_AND_SIZE_TO_SPAN_PAGES(OutVa, AmountToMove) * PAGE_SIZE; PageOffset += PAGE_SIZE)
+		{
+			if (!MmIsAddressValid(RtlAddOffsetToPointer(PAGE_ALIGN(OutVa), PageOffset)))
+			{
+				ExceptionAddressConfirmed = TRUE;
+				break;
+			}
+		}
+
+		if (!ExceptionAddressConfirmed)
+		{
+			RtlCopyMemory(OutVa, MappedAddress, AmountToMove);
+		}
+
+		KeUnstackDetachProcess(&ApcState);
+
+		MmUnmapLockedPages(MappedAddress, Mdl);
+		MmUnlockPages(Mdl);
+
+		if (ExceptionAddressConfirmed)
+		{
+			*NumberOfBytesRead = BufferSize - LeftToMove;
+			return STATUS_PARTIAL_COPY;
+		}
+
+		LeftToMove -= AmountToMove;
+		InVa = (PVOID)((ULONG_PTR)InVa + AmountToMove);
+		OutVa = (PVOID)((ULONG_PTR)OutVa + AmountToMove);
+	}
+
+	//
+	// Set number of bytes moved.
+	//
+
+	*NumberOfBytesRead = BufferSize;
+	return STATUS_SUCCESS;
+}
+
+NTSTATUS
+MmCopyVirtualMemoryImpl(
+	IN PEPROCESS FromProcess,
+	IN CONST VOID* FromAddress,
+	IN PEPROCESS ToProcess,
+	OUT PVOID ToAddress,
+	IN SIZE_T BufferSize,
+	IN KPROCESSOR_MODE PreviousMode,
+	OUT PSIZE_T NumberOfBytesCopied
+)
+{
+	NTSTATUS Status;
+	PEPROCESS ProcessToLock;
+
+	if (BufferSize == 0)
+	{
+		ASSERT(FALSE);         // No one should call with a zero size.
+		return STATUS_SUCCESS;
+	}
 
 	ProcessToLock = FromProcess;
 	if (FromProcess == PsGetCurrentProcess())
@@ -457,15 +967,15 @@ MmCopyVirtualMemoryImpl(
 	// then attempt to write the memory via direct mapping.
 	//
 
-	/*if (BufferSize > POOL_MOVE_THRESHOLD)
+	if (BufferSize > POOL_MOVE_THRESHOLD)
 	{
 		Status = MiDoMappedCopy(FromProcess,
-								FromAddress,
-								ToProcess,
-								ToAddress,
-								BufferSize,
-								PreviousMode,
-								NumberOfBytesCopied);
+			FromAddress,
+			ToProcess,
+			ToAddress,
+			BufferSize,
+			PreviousMode,
+			NumberOfBytesCopied);
 
 		//
 		// If the completion status is not a working quota problem,
@@ -479,7 +989,7 @@ MmCopyVirtualMemoryImpl(
 		}
 
 		*NumberOfBytesCopied = 0;
-	}*/
+	}
 
 	//
 	// There was not enough working set quota to write the memory via
@@ -555,7 +1065,7 @@ NTSTATUS CkCopyVirtualMemory(CONST PEPROCESS InSourceProcess, CONST PVOID InSour
 	// 
 
 	SIZE_T NumberOfBytesCopied = 0;
-	if (RtlGetVersionBuildNumber() >= 22000)
+	if (CkGetSystemCapabilities()->SystemFeatures & CK_SYSTEM_FEATURE_WINDOWS_11)
 		Status = MmCopyVirtualMemoryImpl(InSourceProcess, InSourceAddress, InDestinationProcess, InDestinationAddress, InNumberOfBytes, KernelMode, &NumberOfBytesCopied);
 	else
 		Status = MmCopyVirtualMemory(InSourceProcess, InSourceAddress, InDestinationProcess, InDestinationAddress, InNumberOfBytes, KernelMode, &NumberOfBytesCopied);
@@ -582,92 +1092,1719 @@ NTSTATUS CkCopyVirtualMemory(CONST PVOID InSourceAddress, PVOID InDestinationAdd
 	return CkCopyVirtualMemory(PsGetCurrentProcess(), InSourceAddress, PsGetCurrentProcess(), InDestinationAddress, InNumberOfBytes, OutNumberOfBytesCopied);
 }
 
-// 
-// Information.
-// 
+/// <summary>
+/// Copies a single descriptor of a batch, from the context of the source process.
+/// </summary>
+/// <param name="InOutDescriptor">The descriptor, receiving the number of bytes copied.</param>
+///	<remarks>User addresses are copied under an exception handler, page by page so a partial copy is accounted for, while system addresses are checked with MmIsAddressValid beforehand.</remarks>
+static NTSTATUS CkCopyVirtualMemoryDescriptor(IN OUT CK_COPY_DESCRIPTOR* InOutDescriptor)
+{
+	CONST BOOLEAN UserSource = InOutDescriptor->SourceAddress <= MmHighestUserAddress;
+	CONST BOOLEAN UserDestination = InOutDescriptor->DestinationAddress <= MmHighestUserAddress;
+	SIZE_T NumberOfBytesCopied = 0;
+	NTSTATUS Status = STATUS_SUCCESS;
+
+	while (NumberOfBytesCopied < InOutDescriptor->NumberOfBytes)
+	{
+		// 
+		// Copy up to the end of the current source page.
+		// 
+
+		auto* Source = RtlAddOffsetToPointer(InOutDescriptor->SourceAddress, NumberOfBytesCopied);
+		auto* Destination = RtlAddOffsetToPointer(InOutDescriptor->DestinationAddress, NumberOfBytesCopied);
+		SIZE_T AmountToMove = PAGE_SIZE - BYTE_OFFSET(Source);
+
+		if (AmountToMove > InOutDescriptor->NumberOfBytes - NumberOfBytesCopied)
+			AmountToMove = InOutDescriptor->NumberOfBytes - NumberOfBytesCopied;
+
+		if (!UserSource && (!MmIsAddressValid(Source) || !MmIsAddressValid(RtlAddOffsetToPointer(Source, AmountToMove - 1))))
+		{
+			Status = STATUS_PARTIAL_COPY;
+			break;
+		}
+
+		if (UserSource || UserDestination)
+		{
+			__try
+			{
+				RtlCopyMemory(Destination, Source, AmountToMove);
+			}
+			__except (EXCEPTION_EXECUTE_HANDLER)
+			{
+				Status = STATUS_PARTIAL_COPY;
+			}
+
+			if (!NT_SUCCESS(Status))
+				break;
+		}
+		else
+		{
+			RtlCopyMemory(Destination, Source, AmountToMove);
+		}
+
+		NumberOfBytesCopied += AmountToMove;
+	}
+
+	InOutDescriptor->NumberOfBytesCopied = NumberOfBytesCopied;
+	return Status;
+}
 
 /// <summary>
-/// Queries information about the memory region located at the given virtual address.
+/// Copies the descriptors of a batch, from the context of the source process.
 /// </summary>
-/// <param name="InProcess">The process.</param>
-/// <param name="InVirtualAddress">The virtual address of the region to lookup.</param>
-/// <param name="OutMemoryInformation">The returned memory information.</param>
-NTSTATUS CkQueryVirtualMemory(CONST PEPROCESS InProcess, CONST PVOID InVirtualAddress, OPTIONAL OUT MEMORY_BASIC_INFORMATION* OutMemoryInformation)
+/// <param name="InAttached">Whether the current thread is attached to the source process, in which case the destinations must lie in system space.</param>
+/// <param name="InOutDescriptors">The descriptors, receiving their number of bytes copied and their status.</param>
+/// <param name="InNumberOfDescriptors">The number of descriptors.</param>
+///	<returns>The number of descriptors which were not entirely copied.</returns>
+static ULONG CkCopyVirtualMemoryDescriptors(BOOLEAN InAttached, IN OUT CK_COPY_DESCRIPTOR* InOutDescriptors, ULONG InNumberOfDescriptors)
 {
-	NTSTATUS Status = { };
+	ULONG NumberOfFailures = 0;
+
+	for (ULONG I = 0; I < InNumberOfDescriptors; I++)
+	{
+		auto* Descriptor = &InOutDescriptors[I];
+		Descriptor->NumberOfBytesCopied = 0;
+
+		if (Descriptor->SourceAddress == nullptr || Descriptor->DestinationAddress == nullptr)
+			Descriptor->Status = STATUS_INVALID_PARAMETER;
+		else if (InAttached && Descriptor->DestinationAddress <= MmHighestUserAddress)
+			Descriptor->Status = STATUS_INVALID_ADDRESS;
+		else
+			Descriptor->Status = CkCopyVirtualMemoryDescriptor(Descriptor);
+
+		if (!NT_SUCCESS(Descriptor->Status))
+			NumberOfFailures++;
+	}
+
+	return NumberOfFailures;
+}
+
+/// <summary>
+/// Copies a batch of virtual memory ranges from the source process into system buffers, attaching only once.
+/// </summary>
+/// <param name="InSourceProcess">The source process.</param>
+/// <param name="InOutDescriptors">The descriptors, receiving their number of bytes copied and their status.</param>
+/// <param name="InNumberOfDescriptors">The number of descriptors.</param>
+/// <param name="OutNumberOfFailures">The number of descriptors which were not entirely copied.</param>
+///	<remarks>Unless the source process is the current one, the destination buffers must lie in system space, as they are written while attached to the source process.</remarks>
+///	<returns>STATUS_SUCCESS if every descriptor was entirely copied, STATUS_PARTIAL_COPY otherwise.</returns>
+NTSTATUS CkCopyVirtualMemoryBatch(CONST PEPROCESS InSourceProcess, IN OUT CK_COPY_DESCRIPTOR* InOutDescriptors, ULONG InNumberOfDescriptors, OPTIONAL OUT ULONG* OutNumberOfFailures)
+{
+	NTSTATUS Status;
 
 	// 
 	// Verify the passed parameters.
 	// 
 
-	if (InProcess == nullptr)
+	if (InSourceProcess == nullptr)
 		return STATUS_INVALID_PARAMETER_1;
 
-	if (InVirtualAddress == nullptr)
+	if (InOutDescriptors == nullptr)
 		return STATUS_INVALID_PARAMETER_2;
 
-	if (OutMemoryInformation == nullptr)
+	if (InNumberOfDescriptors == 0)
 		return STATUS_INVALID_PARAMETER_3;
 
 	// 
-	// Open a handle to the process.
+	// Make sure the process keeps its address space, then attach to it once for the whole batch.
 	// 
 
-	auto* Handle = ZwCurrentProcess();
+	if (NT_ERROR(Status = PsAcquireProcessExitSynchronization(InSourceProcess)))
+		return Status;
 
-	if (InProcess != PsGetCurrentProcess())
-		if (NT_ERROR(Status = ObOpenObjectByPointer(InProcess, OBJ_KERNEL_HANDLE | OBJ_CASE_INSENSITIVE, NULL, GENERIC_ALL, *PsProcessType, KernelMode, &Handle)))
-			return Status;
+	CONST BOOLEAN Attach = InSourceProcess != PsGetCurrentProcess();
+	KAPC_STATE ApcState;
+
+	if (Attach)
+		KeStackAttachProcess(InSourceProcess, &ApcState);
 
 	// 
-	// Retrieve the memory region information.
+	// Copy every descriptor.
 	// 
 
-	MEMORY_BASIC_INFORMATION MemoryInformation = { };
-	SIZE_T NumberOfBytesRead = 0;
-	Status = ZwQueryVirtualMemory(Handle, InVirtualAddress, (MEMORY_INFORMATION_CLASS) MemoryBasicInformation, &MemoryInformation, sizeof(MEMORY_BASIC_INFORMATION), &NumberOfBytesRead);
+	auto const NumberOfFailures = CkCopyVirtualMemoryDescriptors(Attach, InOutDescriptors, InNumberOfDescriptors);
 
 	// 
-	// If we opened a handle to the process, close it.
+	// Detach from the process.
 	// 
 
-	if (Handle != ZwCurrentProcess())
-		ZwClose(Handle);
+	if (Attach)
+		KeUnstackDetachProcess(&ApcState);
 
-	// 
-	// Return the result.
-	// 
+	PsReleaseProcessExitSynchronization(InSourceProcess);
 
-	if (OutMemoryInformation != nullptr)
-		RtlCopyMemory(OutMemoryInformation, &MemoryInformation, sizeof(MEMORY_BASIC_INFORMATION));
-	
-	return Status;
+	if (OutNumberOfFailures != nullptr)
+		*OutNumberOfFailures = NumberOfFailures;
+
+	return NumberOfFailures == 0 ? STATUS_SUCCESS : STATUS_PARTIAL_COPY;
 }
 
 /// <summary>
-/// Enumerates the memory regions in the given process and execute a callback for each entries.
+/// Copies every readable page of a virtual memory range from the source process into a system buffer, zero-filling the pages which could not be read.
 /// </summary>
-/// <param name="InProcess">The process.</param>
-/// <param name="InCallback">The callback.</param>
-NTSTATUS CkEnumerateVirtualMemory(CONST PEPROCESS InProcess, ENUMERATE_VIRTUAL_MEMORY InCallback)
+/// <param name="InSourceProcess">The source process.</param>
+/// <param name="InSourceAddress">The source virtual address.</param>
+/// <param name="InDestinationAddress">The destination virtual address.</param>
+/// <param name="InNumberOfBytes">The number of bytes to copy.</param>
+/// <param name="OutCopiedPages">The bitmap receiving a set bit for every source page which was copied, at least as large as the number of pages spanned by the range.</param>
+/// <param name="OutNumberOfBytesCopied">The number of bytes copied from readable pages.</param>
+///	<remarks>Unless the source process is the current one, the destination buffer must lie in system space. The whole range is copied while attached once, so a region with guard or decommitted pages is dumped in a single call. Uncommitted, no-access and guard pages are zero-filled without being touched, so the guard pages of the source process are left armed.</remarks>
+///	<returns>STATUS_SUCCESS if every page was copied, STATUS_PARTIAL_COPY if some pages were zero-filled instead, or the exception raised by writing to a user-space destination.</returns>
+NTSTATUS CkCopyVirtualMemorySparse(CONST PEPROCESS InSourceProcess, CONST PVOID InSourceAddress, PVOID InDestinationAddress, SIZE_T InNumberOfBytes, OPTIONAL OUT PRTL_BITMAP OutCopiedPages, OPTIONAL OUT SIZE_T* OutNumberOfBytesCopied)
 {
-	return CkEnumerateVirtualMemory<ENUMERATE_VIRTUAL_MEMORY>(InProcess, InCallback, [] (ULONG InIndex, MEMORY_BASIC_INFORMATION* InMemoryInformation, ENUMERATE_VIRTUAL_MEMORY InContext) -> bool
+	NTSTATUS Status;
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InSourceProcess == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSourceAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InDestinationAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_3;
+
+	if (InSourceProcess != PsGetCurrentProcess() && InDestinationAddress <= MmHighestUserAddress)
+		return STATUS_INVALID_PARAMETER_3;
+
+	if (InNumberOfBytes == 0)
+		return STATUS_INVALID_PARAMETER_4;
+
+	if (OutCopiedPages != nullptr && OutCopiedPages->SizeOfBitMap < ADDRESS_AND_SIZE_TO_SPAN_PAGES(InSourceAddress, InNumberOfBytes))
+		return STATUS_INVALID_PARAMETER_5;
+
+	if (OutCopiedPages != nullptr)
+		RtlClearAllBits(OutCopiedPages);
+
+	// 
+	// Make sure the process keeps its address space, then attach to it once for the whole range.
+	// 
+
+	if (NT_ERROR(Status = PsAcquireProcessExitSynchronization(InSourceProcess)))
+		return Status;
+
+	CONST BOOLEAN Attach = InSourceProcess != PsGetCurrentProcess();
+	KAPC_STATE ApcState;
+
+	if (Attach)
+		KeStackAttachProcess(InSourceProcess, &ApcState);
+
+	// 
+	// Copy the range page by page, zero-filling the pages which cannot be read. The regions are queried
+	// through the current process pseudo-handle, which refers to the source process once attached.
+	// 
+
+	CK_PROCESS_CONTEXT Context;
+	Context.Process = InSourceProcess;
+	Context.Handle = ZwCurrentProcess();
+
+	MEMORY_BASIC_INFORMATION Region = { };
+	PVOID RegionEnd = nullptr;
+	BOOLEAN Readable = FALSE;
+
+	SIZE_T NumberOfBytesCopied = 0;
+	SIZE_T Offset = 0;
+	ULONG PageIndex = 0;
+
+	while (Offset < InNumberOfBytes)
 	{
-		return InContext(InIndex, InMemoryInformation);
-	});
-}
+		CK_COPY_DESCRIPTOR Descriptor;
+		Descriptor.SourceAddress = RtlAddOffsetToPointer(InSourceAddress, Offset);
+		Descriptor.DestinationAddress = RtlAddOffsetToPointer(InDestinationAddress, Offset);
+		Descriptor.NumberOfBytes = PAGE_SIZE - BYTE_OFFSET(Descriptor.SourceAddress);
 
-/// <summary>
-/// Enumerates the memory regions in the given process and execute a callback for each entries inside the specified range.
-/// </summary>
-/// <param name="InProcess">The process.</param>
-/// <param name="InBaseAddress">The base address.</param>
-/// <param name="InNumberOfBytes">The number of bytes.</param>
-/// <param name="InCallback">The callback.</param>
+		if (Descriptor.NumberOfBytes > InNumberOfBytes - Offset)
+			Descriptor.NumberOfBytes = InNumberOfBytes - Offset;
+
+		// 
+		// Query the region of the page when leaving the previous one, so the guard pages are never read.
+		// 
+
+		if (Descriptor.SourceAddress >= RegionEnd)
+		{
+			if (NT_SUCCESS(CkQueryVirtualMemory(&Context, Descriptor.SourceAddress, &Region)))
+			{
+				RegionEnd = RtlAddOffsetToPointer(Region.BaseAddress, Region.RegionSize);
+				Readable = Region.State == MEM_COMMIT && (Region.Protect & (PAGE_GUARD | PAGE_NOACCESS)) == 0;
+			}
+			else
+			{
+				RegionEnd = RtlAddOffsetToPointer(PAGE_ALIGN(Descriptor.SourceAddress), PAGE_SIZE);
+				Readable = FALSE;
+			}
+		}
+
+		if (Readable && NT_SUCCESS(CkCopyVirtualMemoryDescriptor(&Descriptor)))
+		{
+			if (OutCopiedPages != nullptr)
+				RtlSetBit(OutCopiedPages, PageIndex);
+
+			NumberOfBytesCopied += Descriptor.NumberOfBytes;
+		}
+		else
+		{
+			// 
+			// The destination may lie in user space, and be the reason the copy failed.
+			// 
+
+			__try
+			{
+				RtlZeroMemory(Descriptor.DestinationAddress, Descriptor.NumberOfBytes);
+			}
+			__except (EXCEPTION_EXECUTE_HANDLER)
+			{
+				Status = GetExceptionCode();
+			}
+
+			if (NT_ERROR(Status))
+				break;
+		}
+
+		Offset += Descriptor.NumberOfBytes;
+		PageIndex++;
+	}
+
+	// 
+	// Detach from the process.
+	// 
+
+	if (Attach)
+		KeUnstackDetachProcess(&ApcState);
+
+	PsReleaseProcessExitSynchronization(InSourceProcess);
+
+	if (OutNumberOfBytesCopied != nullptr)
+		*OutNumberOfBytesCopied = NumberOfBytesCopied;
+
+	if (NT_ERROR(Status))
+		return Status;
+
+	return NumberOfBytesCopied == InNumberOfBytes ? STATUS_SUCCESS : STATUS_PARTIAL_COPY;
+}
+
+// 
+// Copy queues.
+// 
+
+// 
+// The maximum number of requests for the same process copied under a single attach.
+// 
+
+#define COPY_QUEUE_MAXIMUM_GROUP_SIZE 32
+
+/// <summary>
+/// A queue of copy requests executed asynchronously by worker threads.
+/// </summary>
+struct CK_COPY_QUEUE
+{
+	KSPIN_LOCK Lock;
+	LIST_ENTRY Requests;
+	KSEMAPHORE Semaphore;
+	BOOLEAN Stopping;
+	ULONG NumberOfWorkers;
+	HANDLE Workers[CK_COPY_QUEUE_MAXIMUM_WORKERS];
+};
+
+/// <summary>
+/// Executes a group of copy requests reading from the same process, attaching only once, then completes them.
+/// </summary>
+/// <param name="InProcess">The source process of every request of the group.</param>
+/// <param name="InRequests">The list of requests.</param>
+static VOID CkExecuteCopyRequests(PEPROCESS InProcess, PLIST_ENTRY InRequests)
+{
+	NTSTATUS Status;
+
+	// 
+	// Make sure the process keeps its address space, then attach to it once for the whole group.
+	// 
+
+	if (NT_SUCCESS(Status = PsAcquireProcessExitSynchronization(InProcess)))
+	{
+		KAPC_STATE ApcState;
+		KeStackAttachProcess(InProcess, &ApcState);
+
+		for (auto* Entry = InRequests->Flink; Entry != InRequests; Entry = Entry->Flink)
+		{
+			auto* Request = CONTAINING_RECORD(Entry, CK_COPY_REQUEST, ListEntry);
+			Request->NumberOfFailures = CkCopyVirtualMemoryDescriptors(TRUE, Request->Descriptors, Request->NumberOfDescriptors);
+			Request->Status = Request->NumberOfFailures == 0 ? STATUS_SUCCESS : STATUS_PARTIAL_COPY;
+		}
+
+		KeUnstackDetachProcess(&ApcState);
+		PsReleaseProcessExitSynchronization(InProcess);
+	}
+
+	// 
+	// Complete the requests, which may be freed by their owner as soon as they are signaled.
+	// 
+
+	while (!IsListEmpty(InRequests))
+	{
+		auto* Request = CONTAINING_RECORD(RemoveHeadList(InRequests), CK_COPY_REQUEST, ListEntry);
+		auto* SourceProcess = Request->SourceProcess;
+		auto* CompletionEvent = Request->CompletionEvent;
+
+		if (NT_ERROR(Status))
+		{
+			Request->NumberOfFailures = Request->NumberOfDescriptors;
+			Request->Status = Status;
+		}
+
+		if (Request->CompletionRoutine != nullptr)
+			Request->CompletionRoutine(Request, Request->CompletionContext);
+
+		if (CompletionEvent != nullptr)
+			KeSetEvent(CompletionEvent, IO_NO_INCREMENT, FALSE);
+
+		ObDereferenceObject(SourceProcess);
+	}
+}
+
+/// <summary>
+/// The routine executed by the worker threads of a copy queue.
+/// </summary>
+/// <param name="InContext">The copy queue.</param>
+static VOID CkCopyQueueWorkerRoutine(PVOID InContext)
+{
+	auto* Queue = (CK_COPY_QUEUE*) InContext;
+
+	while (TRUE)
+	{
+		KeWaitForSingleObject(&Queue->Semaphore, Executive, KernelMode, FALSE, NULL);
+
+		// 
+		// Take the oldest request, along with the other pending requests reading from the same process.
+		// 
+
+		LIST_ENTRY Group;
+		InitializeListHead(&Group);
+
+		KIRQL OldIrql;
+		KeAcquireSpinLock(&Queue->Lock, &OldIrql);
+
+		if (IsListEmpty(&Queue->Requests))
+		{
+			auto const Stopping = Queue->Stopping;
+			KeReleaseSpinLock(&Queue->Lock, OldIrql);
+
+			if (Stopping)
+				break;
+
+			continue;
+		}
+
+		auto* First = CONTAINING_RECORD(RemoveHeadList(&Queue->Requests), CK_COPY_REQUEST, ListEntry);
+		InsertTailList(&Group, &First->ListEntry);
+		ULONG GroupSize = 1;
+
+		for (auto* Entry = Queue->Requests.Flink; Entry != &Queue->Requests && GroupSize < COPY_QUEUE_MAXIMUM_GROUP_SIZE; )
+		{
+			auto* Request = CONTAINING_RECORD(Entry, CK_COPY_REQUEST, ListEntry);
+			Entry = Entry->Flink;
+
+			if (Request->SourceProcess != First->SourceProcess)
+				continue;
+
+			RemoveEntryList(&Request->ListEntry);
+			InsertTailList(&Group, &Request->ListEntry);
+			GroupSize++;
+		}
+
+		KeReleaseSpinLock(&Queue->Lock, OldIrql);
+
+		// 
+		// Execute the group.
+		// 
+
+		CkExecuteCopyRequests(First->SourceProcess, &Group);
+	}
+
+	PsTerminateSystemThread(STATUS_SUCCESS);
+}
+
+/// <summary>
+/// Creates a queue of copy requests and starts its worker threads.
+/// </summary>
+/// <param name="InNumberOfWorkers">The number of worker threads, up to CK_COPY_QUEUE_MAXIMUM_WORKERS, or zero for one per processor.</param>
+/// <param name="OutQueue">The copy queue.</param>
+///	<remarks>This function must be called at PASSIVE_LEVEL. The queue needs to be destroyed with CkDestroyCopyQueue.</remarks>
+NTSTATUS CkCreateCopyQueue(ULONG InNumberOfWorkers, OUT CK_COPY_QUEUE** OutQueue)
+{
+	PAGED_CODE();
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InNumberOfWorkers > CK_COPY_QUEUE_MAXIMUM_WORKERS)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (OutQueue == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InNumberOfWorkers == 0)
+		InNumberOfWorkers = min(KeQueryActiveProcessorCountEx(ALL_PROCESSOR_GROUPS), CK_COPY_QUEUE_MAXIMUM_WORKERS);
+
+	// 
+	// Allocate and initialize the queue.
+	// 
+
+	auto* Queue = (CK_COPY_QUEUE*) CkAllocatePool(NonPagedPoolNx, sizeof(CK_COPY_QUEUE));
+
+	if (Queue == nullptr)
+		return STATUS_INSUFFICIENT_RESOURCES;
+
+	RtlZeroMemory(Queue, sizeof(CK_COPY_QUEUE));
+	KeInitializeSpinLock(&Queue->Lock);
+	InitializeListHead(&Queue->Requests);
+	KeInitializeSemaphore(&Queue->Semaphore, 0, MAXLONG);
+
+	// 
+	// Start the worker threads.
+	// 
+
+	for (ULONG I = 0; I < InNumberOfWorkers; I++)
+	{
+		OBJECT_ATTRIBUTES ObjectAttributes;
+		InitializeObjectAttributes(&ObjectAttributes, NULL, OBJ_KERNEL_HANDLE, NULL, NULL);
+
+		if (NT_ERROR(PsCreateSystemThread(&Queue->Workers[Queue->NumberOfWorkers], SYNCHRONIZE, &ObjectAttributes, NULL, NULL, CkCopyQueueWorkerRoutine, Queue)))
+			break;
+
+		Queue->NumberOfWorkers++;
+	}
+
+	if (Queue->NumberOfWorkers == 0)
+	{
+		CkFreePool(Queue);
+		return STATUS_INSUFFICIENT_RESOURCES;
+	}
+
+	*OutQueue = Queue;
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Stops the worker threads of a copy queue once every pending request is completed, then releases it.
+/// </summary>
+/// <param name="InQueue">The copy queue.</param>
+///	<remarks>This function must be called at PASSIVE_LEVEL, and no request may be submitted anymore once it is called.</remarks>
+VOID CkDestroyCopyQueue(CK_COPY_QUEUE* InQueue)
+{
+	PAGED_CODE();
+
+	if (InQueue == nullptr)
+		return;
+
+	// 
+	// Wake every worker, each of them exiting once the queue is drained.
+	// 
+
+	KIRQL OldIrql;
+	KeAcquireSpinLock(&InQueue->Lock, &OldIrql);
+	InQueue->Stopping = TRUE;
+	KeReleaseSpinLock(&InQueue->Lock, OldIrql);
+
+	KeReleaseSemaphore(&InQueue->Semaphore, IO_NO_INCREMENT, (LONG) InQueue->NumberOfWorkers, FALSE);
+
+	for (ULONG I = 0; I < InQueue->NumberOfWorkers; I++)
+	{
+		ZwWaitForSingleObject(InQueue->Workers[I], FALSE, NULL);
+		ZwClose(InQueue->Workers[I]);
+	}
+
+	CkFreePool(InQueue);
+}
+
+/// <summary>
+/// Queues a copy request, executed asynchronously by a worker thread of the queue.
+/// </summary>
+/// <param name="InQueue">The copy queue.</param>
+/// <param name="InOutRequest">The request, receiving the number of failures and the status once completed.</param>
+///	<remarks>The request and its descriptors must stay valid until it is completed, and its destinations must lie in system space. Requests reading from the same process are grouped under a single attach. The completion routine runs on a worker thread at PASSIVE_LEVEL, before the completion event is signaled. This function can be called at DISPATCH_LEVEL.</remarks>
+///	<returns>STATUS_PENDING if the request was queued.</returns>
+NTSTATUS CkSubmitCopyRequest(CK_COPY_QUEUE* InQueue, IN OUT CK_COPY_REQUEST* InOutRequest)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InQueue == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InOutRequest == nullptr || InOutRequest->SourceProcess == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InOutRequest->Descriptors == nullptr || InOutRequest->NumberOfDescriptors == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	// 
+	// Keep the process alive until the request is completed.
+	// 
+
+	ObReferenceObject(InOutRequest->SourceProcess);
+	InOutRequest->NumberOfFailures = 0;
+	InOutRequest->Status = STATUS_PENDING;
+
+	// 
+	// Queue the request and wake a worker.
+	// 
+
+	KIRQL OldIrql;
+	KeAcquireSpinLock(&InQueue->Lock, &OldIrql);
+
+	if (InQueue->Stopping)
+	{
+		KeReleaseSpinLock(&InQueue->Lock, OldIrql);
+		ObDereferenceObject(InOutRequest->SourceProcess);
+		return STATUS_TOO_LATE;
+	}
+
+	InsertTailList(&InQueue->Requests, &InOutRequest->ListEntry);
+	KeReleaseSpinLock(&InQueue->Lock, OldIrql);
+
+	KeReleaseSemaphore(&InQueue->Semaphore, IO_NO_INCREMENT, 1, FALSE);
+	return STATUS_PENDING;
+}
+
+// 
+// Pointer chains.
+// 
+
+/// <summary>
+/// Compares two pointer chains by base address, then offset by offset.
+/// </summary>
+/// <param name="InFirstChain">The first chain.</param>
+/// <param name="InSecondChain">The second chain.</param>
+///	<returns>A negative value if the first chain sorts first, a positive value if the second one does, zero if they are equal.</returns>
+static LONG CkComparePointerChains(CONST CK_POINTER_CHAIN* InFirstChain, CONST CK_POINTER_CHAIN* InSecondChain)
+{
+	if (InFirstChain->BaseAddress != InSecondChain->BaseAddress)
+		return InFirstChain->BaseAddress < InSecondChain->BaseAddress ? -1 : 1;
+
+	for (ULONG I = 0; I < InFirstChain->NumberOfOffsets && I < InSecondChain->NumberOfOffsets; I++)
+	{
+		if (InFirstChain->Offsets[I] != InSecondChain->Offsets[I])
+			return InFirstChain->Offsets[I] < InSecondChain->Offsets[I] ? -1 : 1;
+	}
+
+	return (LONG) InFirstChain->NumberOfOffsets - (LONG) InSecondChain->NumberOfOffsets;
+}
+
+/// <summary>
+/// Sorts the indexes of pointer chains so chains sharing a prefix end up next to each other.
+/// </summary>
+/// <param name="InChains">The chains.</param>
+/// <param name="InOutOrder">The indexes of the chains, sorted in place.</param>
+/// <param name="InNumberOfChains">The number of chains.</param>
+static VOID CkSortPointerChains(CONST CK_POINTER_CHAIN* InChains, IN OUT ULONG* InOutOrder, ULONG InNumberOfChains)
+{
+	// 
+	// Heap sort, as it needs no additional memory.
+	// 
+
+	auto const SiftDown = [&] (ULONG InRoot, ULONG InEnd)
+	{
+		while (InRoot * 2 + 1 < InEnd)
+		{
+			auto Child = InRoot * 2 + 1;
+
+			if (Child + 1 < InEnd && CkComparePointerChains(&InChains[InOutOrder[Child]], &InChains[InOutOrder[Child + 1]]) < 0)
+				Child++;
+
+			if (CkComparePointerChains(&InChains[InOutOrder[InRoot]], &InChains[InOutOrder[Child]]) >= 0)
+				return;
+
+			auto const Swap = InOutOrder[InRoot];
+			InOutOrder[InRoot] = InOutOrder[Child];
+			InOutOrder[Child] = Swap;
+			InRoot = Child;
+		}
+	};
+
+	for (ULONG I = InNumberOfChains / 2; I > 0; I--)
+		SiftDown(I - 1, InNumberOfChains);
+
+	for (ULONG End = InNumberOfChains; End > 1; End--)
+	{
+		auto const Swap = InOutOrder[0];
+		InOutOrder[0] = InOutOrder[End - 1];
+		InOutOrder[End - 1] = Swap;
+		SiftDown(0, End - 1);
+	}
+}
+
+/// <summary>
+/// Follows a batch of pointer chains in the given process, attaching only once.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InOutChains">The chains, receiving their final address, value and status.</param>
+/// <param name="InNumberOfChains">The number of chains.</param>
+/// <param name="OutNumberOfFailures">The number of chains which could not be followed to the end.</param>
+///	<remarks>Chains sharing a base address and leading offsets read the shared hops only once. A hop whose address lies outside of the user space of the process fails with STATUS_INVALID_ADDRESS.</remarks>
+///	<returns>STATUS_SUCCESS if every chain was followed to the end, STATUS_PARTIAL_COPY otherwise.</returns>
+NTSTATUS CkResolvePointerChains(CONST PEPROCESS InProcess, IN OUT CK_POINTER_CHAIN* InOutChains, ULONG InNumberOfChains, OPTIONAL OUT ULONG* OutNumberOfFailures)
+{
+	NTSTATUS Status;
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InProcess == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InOutChains == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InNumberOfChains == 0)
+		return STATUS_INVALID_PARAMETER_3;
+
+	ULONG SingleOrder = 0;
+	auto* Order = InNumberOfChains == 1 ? &SingleOrder : (ULONG*) CkAllocatePool(NonPagedPoolNx, InNumberOfChains * sizeof(ULONG));
+
+	if (Order == nullptr)
+		return STATUS_INSUFFICIENT_RESOURCES;
+
+	// 
+	// Validate the chains first, as the sort reads their offsets, and leave the invalid ones out of it.
+	// 
+
+	ULONG NumberOfValidChains = 0;
+	ULONG NumberOfFailures = 0;
+
+	for (ULONG I = 0; I < InNumberOfChains; I++)
+	{
+		auto* Chain = &InOutChains[I];
+		Chain->Address = nullptr;
+		Chain->Value = 0;
+		Chain->FailedDepth = 0;
+
+		if (Chain->Offsets == nullptr || Chain->NumberOfOffsets == 0 || Chain->NumberOfOffsets > CK_POINTER_CHAIN_MAXIMUM_DEPTH
+		 || (Chain->PointerSize != 0 && Chain->PointerSize != sizeof(ULONG) && Chain->PointerSize != sizeof(ULONG64)))
+		{
+			Chain->Status = STATUS_INVALID_PARAMETER;
+			NumberOfFailures++;
+			continue;
+		}
+
+		Order[NumberOfValidChains++] = I;
+	}
+
+	// 
+	// Sort the chains, so each one shares the longest possible prefix with the one before it.
+	// 
+
+	CkSortPointerChains(InOutChains, Order, NumberOfValidChains);
+
+	// 
+	// The chains which do not specify the size of their pointers read the ones of the process, 4 bytes under WoW64.
+	// 
+
+#if _WIN64
+	CONST ULONG ProcessPointerSize = PsGetProcessWow64Process(InProcess) != nullptr ? sizeof(ULONG) : sizeof(PVOID);
+#else
+	CONST ULONG ProcessPointerSize = sizeof(PVOID);
+#endif
+
+	// 
+	// Make sure the process keeps its address space, then attach to it once for the whole batch.
+	// 
+
+	if (NT_ERROR(Status = PsAcquireProcessExitSynchronization(InProcess)))
+	{
+		if (Order != &SingleOrder)
+			CkFreePool(Order);
+
+		return Status;
+	}
+
+	CONST BOOLEAN Attach = InProcess != PsGetCurrentProcess();
+	KAPC_STATE ApcState;
+
+	if (Attach)
+		KeStackAttachProcess(InProcess, &ApcState);
+
+	// 
+	// Follow every chain, starting from the last hop it shares with the previous one.
+	// 
+
+	ULONG64 Values[CK_POINTER_CHAIN_MAXIMUM_DEPTH];
+	CONST CK_POINTER_CHAIN* PreviousChain = nullptr;
+	ULONG PreviousPointerSize = 0;
+	ULONG NumberOfKnownHops = 0;
+
+	for (ULONG I = 0; I < NumberOfValidChains; I++)
+	{
+		auto* Chain = &InOutChains[Order[I]];
+		CONST ULONG PointerSize = Chain->PointerSize != 0 ? Chain->PointerSize : ProcessPointerSize;
+
+		// 
+		// Reuse the hops shared with the previous chain, as long as they were read with the same size.
+		// 
+
+		ULONG Depth = 0;
+
+		if (PreviousChain != nullptr && PreviousChain->BaseAddress == Chain->BaseAddress && PreviousPointerSize == PointerSize)
+		{
+			while (Depth < NumberOfKnownHops && Depth < Chain->NumberOfOffsets && PreviousChain->Offsets[Depth] == Chain->Offsets[Depth])
+				Depth++;
+		}
+
+		auto* Pointer = Depth != 0 ? (PVOID) (ULONG_PTR) Values[Depth - 1] : Chain->BaseAddress;
+		Chain->Address = Depth != 0 ? RtlAddOffsetToPointer(Depth > 1 ? (PVOID) (ULONG_PTR) Values[Depth - 2] : Chain->BaseAddress, (LONG_PTR) Chain->Offsets[Depth - 1]) : nullptr;
+		Chain->Status = STATUS_SUCCESS;
+
+		// 
+		// Read the remaining hops, a 4-byte pointer being zero-extended into the low half of the value. The pointers
+		// are controlled by the process, so a hop leaving its user space fails instead of reading system memory.
+		// 
+
+		for (; Depth < Chain->NumberOfOffsets; Depth++)
+		{
+			ULONG64 Value = 0;
+			CK_COPY_DESCRIPTOR Descriptor;
+			Descriptor.SourceAddress = RtlAddOffsetToPointer(Pointer, (LONG_PTR) Chain->Offsets[Depth]);
+			Descriptor.DestinationAddress = &Value;
+			Descriptor.NumberOfBytes = PointerSize;
+			Chain->Address = (PVOID) Descriptor.SourceAddress;
+
+			if (Descriptor.SourceAddress > MmHighestUserAddress || RtlAddOffsetToPointer(Descriptor.SourceAddress, PointerSize - 1) > MmHighestUserAddress
+			 || !NT_SUCCESS(CkCopyVirtualMemoryDescriptor(&Descriptor)))
+			{
+				Chain->Status = STATUS_INVALID_ADDRESS;
+				Chain->FailedDepth = Depth;
+				break;
+			}
+
+			Values[Depth] = Value;
+			Pointer = (PVOID) (ULONG_PTR) Value;
+		}
+
+		if (NT_SUCCESS(Chain->Status))
+			Chain->Value = Values[Chain->NumberOfOffsets - 1];
+		else
+			NumberOfFailures++;
+
+		PreviousChain = Chain;
+		PreviousPointerSize = PointerSize;
+		NumberOfKnownHops = Depth;
+	}
+
+	// 
+	// Detach from the process.
+	// 
+
+	if (Attach)
+		KeUnstackDetachProcess(&ApcState);
+
+	PsReleaseProcessExitSynchronization(InProcess);
+
+	if (Order != &SingleOrder)
+		CkFreePool(Order);
+
+	if (OutNumberOfFailures != nullptr)
+		*OutNumberOfFailures = NumberOfFailures;
+
+	return NumberOfFailures == 0 ? STATUS_SUCCESS : STATUS_PARTIAL_COPY;
+}
+
+/// <summary>
+/// Follows a pointer chain in the given process, attaching only once.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InOffsets">The offset added before each hop, the first one to the base address.</param>
+/// <param name="InNumberOfOffsets">The number of offsets, up to CK_POINTER_CHAIN_MAXIMUM_DEPTH.</param>
+/// <param name="OutAddress">The address read by the last hop, or by the hop which failed.</param>
+/// <param name="OutValue">The pointer-sized value read at the final address.</param>
+/// <param name="OutFailedDepth">The index of the offset whose hop could not be read.</param>
+///	<remarks>Each hop reads a pointer of the process, 4 bytes for a WoW64 process and 8 bytes otherwise.</remarks>
+NTSTATUS CkResolvePointerChain(CONST PEPROCESS InProcess, CONST PVOID InBaseAddress, CONST LONG* InOffsets, ULONG InNumberOfOffsets, OUT PVOID* OutAddress, OPTIONAL OUT ULONG64* OutValue, OPTIONAL OUT ULONG* OutFailedDepth)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InProcess == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InOffsets == nullptr)
+		return STATUS_INVALID_PARAMETER_3;
+
+	if (InNumberOfOffsets == 0 || InNumberOfOffsets > CK_POINTER_CHAIN_MAXIMUM_DEPTH)
+		return STATUS_INVALID_PARAMETER_4;
+
+	if (OutAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_5;
+
+	// 
+	// Follow the chain as a batch of one.
+	// 
+
+	CK_POINTER_CHAIN Chain = { };
+	Chain.BaseAddress = InBaseAddress;
+	Chain.Offsets = InOffsets;
+	Chain.NumberOfOffsets = InNumberOfOffsets;
+	CkResolvePointerChains(InProcess, &Chain, 1);
+
+	*OutAddress = Chain.Address;
+
+	if (OutValue != nullptr)
+		*OutValue = Chain.Value;
+
+	if (OutFailedDepth != nullptr)
+		*OutFailedDepth = Chain.FailedDepth;
+
+	return Chain.Status;
+}
+
+// 
+// Information.
+// 
+
+/// <summary>
+/// Queries information about the memory region located at the given virtual address.
+/// </summary>
+/// <param name="InContext">The process context.</param>
+/// <param name="InVirtualAddress">The virtual address of the region to lookup.</param>
+/// <param name="OutMemoryInformation">The returned memory information.</param>
+NTSTATUS CkQueryVirtualMemory(CONST CK_PROCESS_CONTEXT* InContext, CONST PVOID InVirtualAddress, OPTIONAL OUT MEMORY_BASIC_INFORMATION* OutMemoryInformation)
+{
+	NTSTATUS Status = { };
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InContext == nullptr || InContext->Handle == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InVirtualAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (OutMemoryInformation == nullptr)
+		return STATUS_INVALID_PARAMETER_3;
+
+	// 
+	// Retrieve the memory region information.
+	// 
+
+	MEMORY_BASIC_INFORMATION MemoryInformation = { };
+	SIZE_T NumberOfBytesRead = 0;
+	Status = ZwQueryVirtualMemory(InContext->Handle, InVirtualAddress, (MEMORY_INFORMATION_CLASS) MemoryBasicInformation, &MemoryInformation, sizeof(MEMORY_BASIC_INFORMATION), &NumberOfBytesRead);
+
+	// 
+	// Return the result.
+	// 
+
+	if (OutMemoryInformation != nullptr)
+		RtlCopyMemory(OutMemoryInformation, &MemoryInformation, sizeof(MEMORY_BASIC_INFORMATION));
+	
+	return Status;
+}
+
+/// <summary>
+/// Queries information about the memory region located at the given virtual address.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InVirtualAddress">The virtual address of the region to lookup.</param>
+/// <param name="OutMemoryInformation">The returned memory information.</param>
+NTSTATUS CkQueryVirtualMemory(CONST PEPROCESS InProcess, CONST PVOID InVirtualAddress, OPTIONAL OUT MEMORY_BASIC_INFORMATION* OutMemoryInformation)
+{
+	NTSTATUS Status = { };
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InProcess == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	// 
+	// Open a context for the process, for this call only.
+	// 
+
+	CK_PROCESS_CONTEXT Context;
+
+	if (NT_ERROR(Status = CkOpenTemporaryProcessContext(InProcess, &Context)))
+		return Status;
+
+	Status = CkQueryVirtualMemory(&Context, InVirtualAddress, OutMemoryInformation);
+	CkCloseProcessContext(&Context);
+	return Status;
+}
+
+/// <summary>
+/// Enumerates the memory regions in the given process and execute a callback for each entries.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InCallback">The callback.</param>
+NTSTATUS CkEnumerateVirtualMemory(CONST PEPROCESS InProcess, ENUMERATE_VIRTUAL_MEMORY InCallback)
+{
+	return CkEnumerateVirtualMemory<ENUMERATE_VIRTUAL_MEMORY>(InProcess, InCallback, [] (ULONG InIndex, MEMORY_BASIC_INFORMATION* InMemoryInformation, ENUMERATE_VIRTUAL_MEMORY InContext) -> bool
+	{
+		return InContext(InIndex, InMemoryInformation);
+	});
+}
+
+/// <summary>
+/// Enumerates the memory regions in the given process and execute a callback for each entries inside the specified range.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InNumberOfBytes">The number of bytes.</param>
+/// <param name="InCallback">The callback.</param>
 NTSTATUS CkEnumerateVirtualMemoryInRange(CONST PEPROCESS InProcess, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes, ENUMERATE_VIRTUAL_MEMORY InCallback)
 {
-	return CkEnumerateVirtualMemoryInRange<ENUMERATE_VIRTUAL_MEMORY>(InProcess, InBaseAddress, InNumberOfBytes, InCallback, [] (ULONG InIndex, MEMORY_BASIC_INFORMATION* InMemoryInformation, ENUMERATE_VIRTUAL_MEMORY InContext) -> bool
+	return CkEnumerateVirtualMemoryInRange<ENUMERATE_VIRTUAL_MEMORY>(InProcess, InBaseAddress, InNumberOfBytes, InCallback, [] (ULONG InIndex, MEMORY_BASIC_INFORMATION* InMemoryInformation, ENUMERATE_VIRTUAL_MEMORY InContext) -> bool
+	{
+		return InContext(InIndex, InMemoryInformation);
+	});
+}
+
+// 
+// Snapshots.
+// 
+
+/// <summary>
+/// Finds the index of the last region of the snapshot starting at or below the given virtual address.
+/// </summary>
+/// <param name="InSnapshot">The snapshot.</param>
+/// <param name="InVirtualAddress">The virtual address.</param>
+///	<returns>The index of the region, or MAXULONG if every region starts above the address.</returns>
+static ULONG CkFindMemorySnapshotRegion(CONST CK_MEMORY_SNAPSHOT* InSnapshot, ULONG_PTR InVirtualAddress)
+{
+	ULONG Lower = 0;
+	ULONG Upper = InSnapshot->NumberOfRegions;
+
+	while (Lower < Upper)
+	{
+		auto const Middle = Lower + (Upper - Lower) / 2;
+
+		if ((ULONG_PTR) InSnapshot->Regions[Middle].BaseAddress <= InVirtualAddress)
+			Lower = Middle + 1;
+		else
+			Upper = Middle;
+	}
+
+	return Lower != 0 ? Lower - 1 : MAXULONG;
+}
+
+/// <summary>
+/// Checks whether a region of the snapshot starts exactly at the given virtual address.
+/// </summary>
+/// <param name="InSnapshot">The snapshot.</param>
+/// <param name="InVirtualAddress">The virtual address.</param>
+static BOOLEAN CkIsMemorySnapshotBoundary(CONST CK_MEMORY_SNAPSHOT* InSnapshot, ULONG_PTR InVirtualAddress)
+{
+	auto const Index = CkFindMemorySnapshotRegion(InSnapshot, InVirtualAddress);
+	return Index != MAXULONG && (ULONG_PTR) InSnapshot->Regions[Index].BaseAddress == InVirtualAddress;
+}
+
+/// <summary>
+/// Queries the memory regions covering the specified range and replaces the overlapping regions of the snapshot with them.
+/// </summary>
+/// <param name="InOutSnapshot">The snapshot.</param>
+/// <param name="InStartAddress">The start address of the range.</param>
+/// <param name="InEndAddress">The end address of the range, exclusive.</param>
+/// <param name="OutNumberOfChangedRegions">The number of regions that were added or modified.</param>
+static NTSTATUS CkUpdateMemorySnapshot(IN OUT CK_MEMORY_SNAPSHOT* InOutSnapshot, ULONG_PTR InStartAddress, ULONG_PTR InEndAddress, OPTIONAL OUT ULONG* OutNumberOfChangedRegions)
+{
+	NTSTATUS Status = { };
+
+	// 
+	// Start at the base of the recorded region preceding the range, so the
+	// queried regions line up with the ones they replace, and a change that
+	// merged the first region with its predecessor is picked up as well.
+	// 
+
+	auto StartAddress = (ULONG_PTR) MM_LOWEST_USER_ADDRESS;
+	auto StartIndex = CkFindMemorySnapshotRegion(InOutSnapshot, InStartAddress);
+
+	if (StartIndex != MAXULONG && StartIndex != 0)
+		StartIndex--;
+
+	if (StartIndex != MAXULONG && (ULONG_PTR) InOutSnapshot->Regions[StartIndex].BaseAddress > StartAddress)
+		StartAddress = (ULONG_PTR) InOutSnapshot->Regions[StartIndex].BaseAddress;
+
+	// 
+	// Query the regions until the end of the range is reached and the walk
+	// lands back on a recorded boundary.
+	// 
+
+	CK_MEMORY_REGION* Regions = nullptr;
+	ULONG NumberOfRegions = 0;
+	ULONG MaximumNumberOfRegions = 0;
+	auto CurrentAddress = StartAddress;
+
+	while (CurrentAddress < (ULONG_PTR) MM_HIGHEST_USER_ADDRESS)
+	{
+		if (CurrentAddress >= InEndAddress && CkIsMemorySnapshotBoundary(InOutSnapshot, CurrentAddress))
+			break;
+
+		MEMORY_BASIC_INFORMATION MemoryInformation;
+
+		if (NT_ERROR(Status = CkQueryVirtualMemory(&InOutSnapshot->Context, (PVOID) CurrentAddress, &MemoryInformation)))
+		{
+			if (Regions != nullptr)
+				CkFreePool(Regions);
+
+			return Status;
+		}
+
+		// 
+		// Grow the array of queried regions if needed.
+		// 
+
+		if (NumberOfRegions == MaximumNumberOfRegions)
+		{
+			auto const NewMaximumNumberOfRegions = MaximumNumberOfRegions != 0 ? MaximumNumberOfRegions * 2 : 64;
+			auto* NewRegions = (CK_MEMORY_REGION*) CkAllocatePool(NonPagedPoolNx, NewMaximumNumberOfRegions * sizeof(CK_MEMORY_REGION));
+
+			if (NewRegions == nullptr)
+			{
+				if (Regions != nullptr)
+					CkFreePool(Regions);
+
+				return STATUS_INSUFFICIENT_RESOURCES;
+			}
+
+			if (Regions != nullptr)
+			{
+				RtlCopyMemory(NewRegions, Regions, NumberOfRegions * sizeof(CK_MEMORY_REGION));
+				CkFreePool(Regions);
+			}
+
+			Regions = NewRegions;
+			MaximumNumberOfRegions = NewMaximumNumberOfRegions;
+		}
+
+		auto* Region = &Regions[NumberOfRegions++];
+		Region->BaseAddress = MemoryInformation.BaseAddress;
+		Region->RegionSize = MemoryInformation.RegionSize;
+		Region->State = MemoryInformation.State;
+		Region->Protect = MemoryInformation.Protect;
+		Region->Type = MemoryInformation.Type;
+
+		CurrentAddress = (ULONG_PTR) MemoryInformation.BaseAddress + MemoryInformation.RegionSize;
+	}
+
+	// 
+	// Count the regions which were not already recorded as is.
+	// 
+
+	ULONG NumberOfChangedRegions = 0;
+
+	for (ULONG I = 0; I < NumberOfRegions; I++)
+	{
+		auto const Index = CkFindMemorySnapshotRegion(InOutSnapshot, (ULONG_PTR) Regions[I].BaseAddress);
+
+		if (Index == MAXULONG)
+		{
+			NumberOfChangedRegions++;
+			continue;
+		}
+
+		auto const* Recorded = &InOutSnapshot->Regions[Index];
+
+		if (Recorded->BaseAddress != Regions[I].BaseAddress || Recorded->RegionSize != Regions[I].RegionSize)
+			NumberOfChangedRegions++;
+		else if (Recorded->State != Regions[I].State || Recorded->Protect != Regions[I].Protect || Recorded->Type != Regions[I].Type)
+			NumberOfChangedRegions++;
+	}
+
+	// 
+	// Find the recorded regions being replaced, those starting inside the walked range.
+	// 
+
+	ULONG FirstIndex = 0;
+	ULONG LastIndex = 0;
+
+	while (FirstIndex < InOutSnapshot->NumberOfRegions && (ULONG_PTR) InOutSnapshot->Regions[FirstIndex].BaseAddress < StartAddress)
+		FirstIndex++;
+
+	LastIndex = CkFindMemorySnapshotRegion(InOutSnapshot, CurrentAddress - 1);
+	LastIndex = LastIndex != MAXULONG && LastIndex >= FirstIndex ? LastIndex + 1 : FirstIndex;
+
+	auto const NumberOfTrailingRegions = InOutSnapshot->NumberOfRegions - LastIndex;
+	auto const NewNumberOfRegions = FirstIndex + NumberOfRegions + NumberOfTrailingRegions;
+
+	// 
+	// Grow the snapshot if needed, then splice the queried regions in.
+	// 
+
+	if (NewNumberOfRegions > InOutSnapshot->MaximumNumberOfRegions)
+	{
+		auto const NewMaximumNumberOfRegions = NewNumberOfRegions + NewNumberOfRegions / 4;
+		auto* NewRegions = (CK_MEMORY_REGION*) CkAllocatePool(NonPagedPoolNx, NewMaximumNumberOfRegions * sizeof(CK_MEMORY_REGION));
+
+		if (NewRegions == nullptr)
+		{
+			if (Regions != nullptr)
+				CkFreePool(Regions);
+
+			return STATUS_INSUFFICIENT_RESOURCES;
+		}
+
+		if (InOutSnapshot->Regions != nullptr)
+		{
+			RtlCopyMemory(NewRegions, InOutSnapshot->Regions, FirstIndex * sizeof(CK_MEMORY_REGION));
+			RtlCopyMemory(&NewRegions[FirstIndex + NumberOfRegions], &InOutSnapshot->Regions[LastIndex], NumberOfTrailingRegions * sizeof(CK_MEMORY_REGION));
+			CkFreePool(InOutSnapshot->Regions);
+		}
+
+		InOutSnapshot->Regions = NewRegions;
+		InOutSnapshot->MaximumNumberOfRegions = NewMaximumNumberOfRegions;
+	}
+	else
+	{
+		RtlMoveMemory(&InOutSnapshot->Regions[FirstIndex + NumberOfRegions], &InOutSnapshot->Regions[LastIndex], NumberOfTrailingRegions * sizeof(CK_MEMORY_REGION));
+	}
+
+	if (Regions != nullptr)
+	{
+		RtlCopyMemory(&InOutSnapshot->Regions[FirstIndex], Regions, NumberOfRegions * sizeof(CK_MEMORY_REGION));
+		CkFreePool(Regions);
+	}
+
+	InOutSnapshot->NumberOfRegions = NewNumberOfRegions;
+
+	if (OutNumberOfChangedRegions != nullptr)
+		*OutNumberOfChangedRegions = NumberOfChangedRegions;
+
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Takes a snapshot of the memory regions of the given process.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="OutSnapshot">The snapshot.</param>
+///	<remarks>The snapshot keeps a handle to the process and needs to be released with CkFreeMemorySnapshot.</remarks>
+NTSTATUS CkCreateMemorySnapshot(CONST PEPROCESS InProcess, OUT CK_MEMORY_SNAPSHOT* OutSnapshot)
+{
+	NTSTATUS Status = { };
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InProcess == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (OutSnapshot == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	// 
+	// Open the process once for the lifetime of the snapshot.
+	// 
+
+	RtlZeroMemory(OutSnapshot, sizeof(CK_MEMORY_SNAPSHOT));
+
+	if (NT_ERROR(Status = CkOpenProcessContext(InProcess, &OutSnapshot->Context)))
+		return Status;
+
+	// 
+	// Query every region of the user address space.
+	// 
+
+	if (NT_ERROR(Status = CkUpdateMemorySnapshot(OutSnapshot, (ULONG_PTR) MM_LOWEST_USER_ADDRESS, (ULONG_PTR) MM_HIGHEST_USER_ADDRESS, nullptr)))
+	{
+		CkFreeMemorySnapshot(OutSnapshot);
+		return Status;
+	}
+
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Releases a snapshot previously taken with CkCreateMemorySnapshot.
+/// </summary>
+/// <param name="InSnapshot">The snapshot.</param>
+VOID CkFreeMemorySnapshot(CK_MEMORY_SNAPSHOT* InSnapshot)
+{
+	if (InSnapshot == nullptr)
+		return;
+
+	if (InSnapshot->Regions != nullptr)
+		CkFreePool(InSnapshot->Regions);
+
+	CkCloseProcessContext(&InSnapshot->Context);
+	RtlZeroMemory(InSnapshot, sizeof(CK_MEMORY_SNAPSHOT));
+}
+
+/// <summary>
+/// Queries the memory regions inside the specified range again and replaces them in the snapshot.
+/// </summary>
+/// <param name="InOutSnapshot">The snapshot.</param>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InNumberOfBytes">The number of bytes.</param>
+/// <param name="OutNumberOfChangedRegions">The number of regions that were added or modified.</param>
+///	<remarks>Only the regions overlapping the range are queried, the rest of the snapshot is kept as is.</remarks>
+NTSTATUS CkRefreshMemorySnapshot(IN OUT CK_MEMORY_SNAPSHOT* InOutSnapshot, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes, OPTIONAL OUT ULONG* OutNumberOfChangedRegions)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InOutSnapshot == nullptr || InOutSnapshot->Context.Handle == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InNumberOfBytes == 0)
+		return STATUS_INVALID_PARAMETER_3;
+
+	if ((ULONG_PTR) InBaseAddress + InNumberOfBytes < (ULONG_PTR) InBaseAddress)
+		return STATUS_INVALID_PARAMETER_3;
+
+	// 
+	// Update the regions overlapping the range.
+	// 
+
+	return CkUpdateMemorySnapshot(InOutSnapshot, (ULONG_PTR) InBaseAddress, (ULONG_PTR) InBaseAddress + InNumberOfBytes, OutNumberOfChangedRegions);
+}
+
+/// <summary>
+/// Queries every memory region of the process again and replaces them in the snapshot.
+/// </summary>
+/// <param name="InOutSnapshot">The snapshot.</param>
+/// <param name="OutNumberOfChangedRegions">The number of regions that were added or modified.</param>
+NTSTATUS CkRefreshMemorySnapshot(IN OUT CK_MEMORY_SNAPSHOT* InOutSnapshot, OPTIONAL OUT ULONG* OutNumberOfChangedRegions)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InOutSnapshot == nullptr || InOutSnapshot->Context.Handle == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	// 
+	// Update every region.
+	// 
+
+	return CkUpdateMemorySnapshot(InOutSnapshot, (ULONG_PTR) MM_LOWEST_USER_ADDRESS, (ULONG_PTR) MM_HIGHEST_USER_ADDRESS, OutNumberOfChangedRegions);
+}
+
+/// <summary>
+/// Finds the memory region containing the given virtual address in the snapshot.
+/// </summary>
+/// <param name="InSnapshot">The snapshot.</param>
+/// <param name="InVirtualAddress">The virtual address.</param>
+/// <param name="OutRegion">The region.</param>
+NTSTATUS CkLookupMemorySnapshot(CONST CK_MEMORY_SNAPSHOT* InSnapshot, CONST PVOID InVirtualAddress, OUT CONST CK_MEMORY_REGION** OutRegion)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InSnapshot == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (OutRegion == nullptr)
+		return STATUS_INVALID_PARAMETER_3;
+
+	// 
+	// Search the last region starting at or below the address.
+	// 
+
+	auto const Index = CkFindMemorySnapshotRegion(InSnapshot, (ULONG_PTR) InVirtualAddress);
+
+	if (Index == MAXULONG)
+		return STATUS_NOT_FOUND;
+
+	auto const* Region = &InSnapshot->Regions[Index];
+
+	if ((ULONG_PTR) InVirtualAddress - (ULONG_PTR) Region->BaseAddress >= Region->RegionSize)
+		return STATUS_NOT_FOUND;
+
+	*OutRegion = Region;
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Finds the memory regions overlapping the specified range in the snapshot.
+/// </summary>
+/// <param name="InSnapshot">The snapshot.</param>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InNumberOfBytes">The number of bytes.</param>
+/// <param name="OutRegions">The first region overlapping the range.</param>
+/// <param name="OutNumberOfRegions">The number of consecutive regions overlapping the range.</param>
+NTSTATUS CkLookupMemorySnapshotRange(CONST CK_MEMORY_SNAPSHOT* InSnapshot, CONST PVOID InBaseAddress, SIZE_T InNumberOfBytes, OUT CONST CK_MEMORY_REGION** OutRegions, OUT ULONG* OutNumberOfRegions)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InSnapshot == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InNumberOfBytes == 0)
+		return STATUS_INVALID_PARAMETER_3;
+
+	if (OutRegions == nullptr)
+		return STATUS_INVALID_PARAMETER_4;
+
+	if (OutNumberOfRegions == nullptr)
+		return STATUS_INVALID_PARAMETER_5;
+
+	auto const StartAddress = (ULONG_PTR) InBaseAddress;
+	auto const LastAddress = StartAddress + InNumberOfBytes - 1;
+
+	if (LastAddress < StartAddress)
+		return STATUS_INVALID_PARAMETER_3;
+
+	// 
+	// Find the first and last regions overlapping the range.
+	// 
+
+	auto const LastIndex = CkFindMemorySnapshotRegion(InSnapshot, LastAddress);
+
+	if (LastIndex == MAXULONG)
+		return STATUS_NOT_FOUND;
+
+	auto FirstIndex = CkFindMemorySnapshotRegion(InSnapshot, StartAddress);
+
+	if (FirstIndex == MAXULONG)
+		FirstIndex = 0;
+	else if (StartAddress - (ULONG_PTR) InSnapshot->Regions[FirstIndex].BaseAddress >= InSnapshot->Regions[FirstIndex].RegionSize)
+		FirstIndex++;
+
+	if (FirstIndex > LastIndex)
+		return STATUS_NOT_FOUND;
+
+	*OutRegions = &InSnapshot->Regions[FirstIndex];
+	*OutNumberOfRegions = LastIndex - FirstIndex + 1;
+	return STATUS_SUCCESS;
+}
+
+// 
+// Page hashes.
+// 
+
+// 
+// The number of pages read in a single batch.
+// 
+
+#define CK_PAGE_HASH_BATCH_SIZE 16
+
+/// <summary>
+/// Hashes a page read into a system buffer, reserving zero for the pages which could not be read.
+/// </summary>
+/// <param name="InPage">The page.</param>
+static UINT64 CkHashPage(CONST PVOID InPage)
+{
+	auto const Hash = CkCalculateXxHash64(InPage, PAGE_SIZE);
+	return Hash != 0 ? Hash : 1;
+}
+
+/// <summary>
+/// Reads every recorded page by batches, then either records its hash or compares it to the recorded one.
+/// </summary>
+/// <param name="InOutPageHashes">The page hashes.</param>
+/// <param name="InCompare">Whether the pages are compared, or only recorded.</param>
+/// <param name="InUpdate">Whether the changed pages are recorded, when comparing.</param>
+/// <param name="OutDifferences">The changed pages.</param>
+/// <param name="InMaximumNumberOfDifferences">The number of changed pages the differences array can hold.</param>
+/// <param name="OutNumberOfDifferences">The number of changed pages.</param>
+static NTSTATUS CkHashPages(IN OUT CK_PAGE_HASHES* InOutPageHashes, BOOLEAN InCompare, BOOLEAN InUpdate, OPTIONAL OUT CK_PAGE_DIFFERENCE* OutDifferences, ULONG InMaximumNumberOfDifferences, OPTIONAL OUT ULONG* OutNumberOfDifferences)
+{
+	NTSTATUS Status;
+
+	// 
+	// Allocate the buffer the pages are read into.
+	// 
+
+	auto* Buffer = CkAllocatePool(NonPagedPoolNx, CK_PAGE_HASH_BATCH_SIZE * PAGE_SIZE);
+
+	if (Buffer == nullptr)
+		return STATUS_INSUFFICIENT_RESOURCES;
+
+	CK_COPY_DESCRIPTOR Descriptors[CK_PAGE_HASH_BATCH_SIZE];
+	ULONG PageIndexes[CK_PAGE_HASH_BATCH_SIZE];
+	RtlZeroMemory(Descriptors, sizeof(Descriptors));
+
+	ULONG NumberOfDifferences = 0;
+	ULONG RangeIndex = 0;
+	ULONG PageInRange = 0;
+
+	while (RangeIndex < InOutPageHashes->NumberOfRanges)
 	{
-		return InContext(InIndex, InMemoryInformation);
-	});
+		// 
+		// Describe the next batch of pages.
+		// 
+
+		ULONG NumberOfDescriptors = 0;
+
+		while (NumberOfDescriptors < CK_PAGE_HASH_BATCH_SIZE && RangeIndex < InOutPageHashes->NumberOfRanges)
+		{
+			auto const* Range = &InOutPageHashes->Ranges[RangeIndex];
+
+			if (PageInRange == Range->NumberOfPages)
+			{
+				RangeIndex++;
+				PageInRange = 0;
+				continue;
+			}
+
+			auto* Descriptor = &Descriptors[NumberOfDescriptors];
+			Descriptor->SourceAddress = RtlAddOffsetToPointer(Range->BaseAddress, (SIZE_T) PageInRange * PAGE_SIZE);
+			Descriptor->DestinationAddress = RtlAddOffsetToPointer(Buffer, (SIZE_T) NumberOfDescriptors * PAGE_SIZE);
+			Descriptor->NumberOfBytes = PAGE_SIZE;
+			PageIndexes[NumberOfDescriptors++] = Range->FirstPage + PageInRange++;
+		}
+
+		if (NumberOfDescriptors == 0)
+			break;
+
+		// 
+		// Read the pages, attaching to the process only once. The unreadable pages only make the batch a partial copy,
+		// any other failure, such as the process exiting, leaves the statuses unset and ends the pass.
+		// 
+
+		if (NT_ERROR(Status = CkCopyVirtualMemoryBatch(InOutPageHashes->Process, Descriptors, NumberOfDescriptors)))
+		{
+			CkFreePool(Buffer);
+			return Status;
+		}
+
+		for (ULONG I = 0; I < NumberOfDescriptors; I++)
+		{
+			auto* Page = Descriptors[I].DestinationAddress;
+			auto const PageIndex = PageIndexes[I];
+			auto const Hash = NT_SUCCESS(Descriptors[I].Status) ? CkHashPage(Page) : 0;
+			auto* Contents = InOutPageHashes->Contents != nullptr ? RtlAddOffsetToPointer(InOutPageHashes->Contents, (SIZE_T) PageIndex * PAGE_SIZE) : nullptr;
+
+			// 
+			// Record the page right away when not comparing.
+			// 
+
+			if (!InCompare)
+			{
+				InOutPageHashes->Hashes[PageIndex] = Hash;
+
+				if (Contents != nullptr && Hash != 0)
+					RtlCopyMemory(Contents, Page, PAGE_SIZE);
+
+				continue;
+			}
+
+			if (Hash == InOutPageHashes->Hashes[PageIndex])
+				continue;
+
+			// 
+			// Report the changed page, along with its changed bytes when the previous contents are known.
+			// 
+
+			if (NumberOfDifferences < InMaximumNumberOfDifferences)
+			{
+				auto* Difference = &OutDifferences[NumberOfDifferences];
+				Difference->PageAddress = (PVOID) Descriptors[I].SourceAddress;
+				Difference->PreviousHash = InOutPageHashes->Hashes[PageIndex];
+				Difference->CurrentHash = Hash;
+				Difference->FirstChangedByte = 0;
+				Difference->LastChangedByte = PAGE_SIZE - 1;
+				Difference->NumberOfChangedBytes = PAGE_SIZE;
+
+				if (Contents != nullptr && Hash != 0 && InOutPageHashes->Hashes[PageIndex] != 0)
+				{
+					auto const* Previous = (CONST UINT8*) Contents;
+					auto const* Current = (CONST UINT8*) Page;
+					ULONG NumberOfChangedBytes = 0;
+					ULONG FirstChangedByte = MAXULONG;
+					ULONG LastChangedByte = 0;
+
+					for (ULONG J = 0; J < PAGE_SIZE; J++)
+					{
+						if (Previous[J] == Current[J])
+							continue;
+
+						if (FirstChangedByte == MAXULONG)
+							FirstChangedByte = J;
+
+						LastChangedByte = J;
+						NumberOfChangedBytes++;
+					}
+
+					Difference->FirstChangedByte = FirstChangedByte != MAXULONG ? FirstChangedByte : 0;
+					Difference->LastChangedByte = LastChangedByte;
+					Difference->NumberOfChangedBytes = NumberOfChangedBytes;
+				}
+			}
+
+			NumberOfDifferences++;
+
+			// 
+			// Make the current page the new reference if asked to.
+			// 
+
+			if (InUpdate)
+			{
+				InOutPageHashes->Hashes[PageIndex] = Hash;
+
+				if (Contents != nullptr && Hash != 0)
+					RtlCopyMemory(Contents, Page, PAGE_SIZE);
+			}
+		}
+	}
+
+	CkFreePool(Buffer);
+
+	if (OutNumberOfDifferences != nullptr)
+		*OutNumberOfDifferences = NumberOfDifferences;
+
+	return NumberOfDifferences > InMaximumNumberOfDifferences ? STATUS_BUFFER_OVERFLOW : STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Records the hash of every page of the given memory regions of a process.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InRegions">The regions, typically selected from a memory snapshot.</param>
+/// <param name="InNumberOfRegions">The number of regions.</param>
+/// <param name="InFlags">The flags, CK_PAGE_HASHES_KEEP_CONTENTS to be able to report the changed bytes.</param>
+/// <param name="OutPageHashes">The page hashes.</param>
+///	<remarks>The pages are read with CkCopyVirtualMemoryBatch. A page which could not be read is recorded with a hash of zero. The page hashes need to be released with CkFreePageHashes.</remarks>
+NTSTATUS CkCreatePageHashes(CONST PEPROCESS InProcess, CONST CK_MEMORY_REGION* InRegions, ULONG InNumberOfRegions, ULONG InFlags, OUT CK_PAGE_HASHES* OutPageHashes)
+{
+	NTSTATUS Status = { };
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InProcess == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InRegions == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InNumberOfRegions == 0)
+		return STATUS_INVALID_PARAMETER_3;
+
+	if ((InFlags & ~CK_PAGE_HASHES_KEEP_CONTENTS) != 0)
+		return STATUS_INVALID_PARAMETER_4;
+
+	if (OutPageHashes == nullptr)
+		return STATUS_INVALID_PARAMETER_5;
+
+	RtlZeroMemory(OutPageHashes, sizeof(CK_PAGE_HASHES));
+
+	// 
+	// Count the pages spanned by the regions.
+	// 
+
+	ULONG64 NumberOfPages = 0;
+
+	for (ULONG I = 0; I < InNumberOfRegions; I++)
+		NumberOfPages += ADDRESS_AND_SIZE_TO_SPAN_PAGES(InRegions[I].BaseAddress, InRegions[I].RegionSize);
+
+	if (NumberOfPages == 0 || NumberOfPages > MAXULONG / PAGE_SIZE)
+		return STATUS_INVALID_PARAMETER_2;
+
+	// 
+	// Allocate the ranges and the hashes, and the copies of the pages if asked to.
+	// 
+
+	OutPageHashes->Ranges = (CK_PAGE_HASH_RANGE*) CkAllocatePool(NonPagedPoolNx, InNumberOfRegions * sizeof(CK_PAGE_HASH_RANGE));
+	OutPageHashes->Hashes = (UINT64*) CkAllocatePool(NonPagedPoolNx, (SIZE_T) NumberOfPages * sizeof(UINT64));
+
+	if (InFlags & CK_PAGE_HASHES_KEEP_CONTENTS)
+		OutPageHashes->Contents = CkAllocatePool(PagedPool, (SIZE_T) NumberOfPages * PAGE_SIZE);
+
+	if (OutPageHashes->Ranges == nullptr || OutPageHashes->Hashes == nullptr || ((InFlags & CK_PAGE_HASHES_KEEP_CONTENTS) && OutPageHashes->Contents == nullptr))
+	{
+		CkFreePageHashes(OutPageHashes);
+		return STATUS_INSUFFICIENT_RESOURCES;
+	}
+
+	ULONG FirstPage = 0;
+
+	for (ULONG I = 0; I < InNumberOfRegions; I++)
+	{
+		auto* Range = &OutPageHashes->Ranges[I];
+		Range->BaseAddress = PAGE_ALIGN(InRegions[I].BaseAddress);
+		Range->NumberOfPages = (ULONG) ADDRESS_AND_SIZE_TO_SPAN_PAGES(InRegions[I].BaseAddress, InRegions[I].RegionSize);
+		Range->FirstPage = FirstPage;
+		FirstPage += Range->NumberOfPages;
+	}
+
+	ObReferenceObject(InProcess);
+	OutPageHashes->Process = InProcess;
+	OutPageHashes->Flags = InFlags;
+	OutPageHashes->NumberOfRanges = InNumberOfRegions;
+	OutPageHashes->NumberOfPages = (ULONG) NumberOfPages;
+
+	// 
+	// Record the hash of every page.
+	// 
+
+	if (NT_ERROR(Status = CkHashPages(OutPageHashes, FALSE, FALSE, nullptr, 0, nullptr)))
+	{
+		CkFreePageHashes(OutPageHashes);
+		return Status;
+	}
+
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Releases the page hashes previously recorded with CkCreatePageHashes.
+/// </summary>
+/// <param name="InPageHashes">The page hashes.</param>
+VOID CkFreePageHashes(CK_PAGE_HASHES* InPageHashes)
+{
+	if (InPageHashes == nullptr)
+		return;
+
+	if (InPageHashes->Contents != nullptr)
+		CkFreePool(InPageHashes->Contents);
+
+	if (InPageHashes->Hashes != nullptr)
+		CkFreePool(InPageHashes->Hashes);
+
+	if (InPageHashes->Ranges != nullptr)
+		CkFreePool(InPageHashes->Ranges);
+
+	if (InPageHashes->Process != nullptr)
+		ObDereferenceObject(InPageHashes->Process);
+
+	RtlZeroMemory(InPageHashes, sizeof(CK_PAGE_HASHES));
+}
+
+/// <summary>
+/// Hashes the recorded pages again and reports those whose hash changed.
+/// </summary>
+/// <param name="InOutPageHashes">The page hashes.</param>
+/// <param name="OutDifferences">The changed pages.</param>
+/// <param name="InMaximumNumberOfDifferences">The number of changed pages the differences array can hold.</param>
+/// <param name="OutNumberOfDifferences">The number of changed pages, which may exceed the size of the differences array.</param>
+/// <param name="InUpdate">Whether the changed pages become the new reference for the next comparison.</param>
+///	<remarks>Without CK_PAGE_HASHES_KEEP_CONTENTS, the changed bytes of a difference span the whole page.</remarks>
+///	<returns>STATUS_BUFFER_OVERFLOW if more pages changed than the differences array can hold, or the failure to read the process, such as when it is exiting, in which case the pages compared so far may already have been updated.</returns>
+NTSTATUS CkDiffPageHashes(IN OUT CK_PAGE_HASHES* InOutPageHashes, OUT CK_PAGE_DIFFERENCE* OutDifferences, ULONG InMaximumNumberOfDifferences, OUT ULONG* OutNumberOfDifferences, BOOLEAN InUpdate)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InOutPageHashes == nullptr || InOutPageHashes->Process == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (OutDifferences == nullptr && InMaximumNumberOfDifferences != 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (OutNumberOfDifferences == nullptr)
+		return STATUS_INVALID_PARAMETER_4;
+
+	// 
+	// Compare every page to its recorded hash.
+	// 
+
+	return CkHashPages(InOutPageHashes, TRUE, InUpdate, OutDifferences, InMaximumNumberOfDifferences, OutNumberOfDifferences);
 }
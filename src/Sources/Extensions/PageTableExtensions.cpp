@@ -6,6 +6,7 @@
 /// <param name="InProcess">The process.</param>
 /// <param name="InVirtualAddress">The virtual address.</param>
 /// <param name="OutTranslationInfo">The returned virtual address translation information.</param>
+///	<returns>STATUS_NOT_SUPPORTED if the page tables cannot be walked with four levels.</returns>
 NTSTATUS CkVirtualAddressTranslation(CONST PEPROCESS InProcess, CONST PVOID InVirtualAddress, OUT ADDRESS_TRANSLATION_INFO* OutTranslationInfo)
 {
 	// 
@@ -21,6 +22,9 @@ NTSTATUS CkVirtualAddressTranslation(CONST PEPROCESS InProcess, CONST PVOID InVi
 	if (OutTranslationInfo == nullptr)
 		return STATUS_INVALID_PARAMETER_3;
 
+	if (!CkPageTableWalkIsSupported())
+		return STATUS_NOT_SUPPORTED;
+
 	// 
 	// Attach to the process.
 	// 
@@ -33,7 +37,7 @@ NTSTATUS CkVirtualAddressTranslation(CONST PEPROCESS InProcess, CONST PVOID InVi
 	// 
 
 	ADDRESS_TRANSLATION_INFO AddressTranslationInfo = { };
-	ULONGLONG ProcessDirectoryBase = *(ULONGLONG*) RtlAddOffsetToPointer(InProcess, 0x28);
+	ULONGLONG ProcessDirectoryBase = *(ULONGLONG*) RtlAddOffsetToPointer(InProcess, CkGetSystemCapabilities()->ProcessDirectoryTableBaseOffset);
 	CONST VIRTUAL_ADDRESS TranslationIndexes = { .Pointer = InVirtualAddress };
 	CONST CR3 ProcessCr3 = { .value = ProcessDirectoryBase };
 
@@ -89,6 +93,7 @@ NTSTATUS CkVirtualAddressTranslation(CONST PEPROCESS InProcess, CONST PVOID InVi
 /// </summary>
 /// <param name="InProcess">The process.</param>
 /// <param name="InCallback">The callback.</param>
+///	<returns>STATUS_NOT_SUPPORTED if the page tables cannot be walked with four levels.</returns>
 NTSTATUS CkEnumeratePxeOfProcess(CONST PEPROCESS InProcess, void(*InCallback)(ULONG, MMPXE*))
 {
 	return CkEnumeratePxeOfProcess<PVOID>(InProcess, InCallback, [] (ULONG InIdx, MMPXE* InPxe, PVOID InContext)
@@ -1,277 +1,4175 @@
 #include "../../Headers/EasyNT.h"
 
+
+// 
+// The number of entries a signature can have to be parsed on the stack.
+// 
+
+#define SIGNATURE_STACK_LENGTH 128
+
+// 
+// The value returned by the scan engines when no match was found.
+// 
+
+#define SIGNATURE_NOT_FOUND ((SIZE_T) -1)
+
+// 
+// The minimum size of a region for the AVX2 engine to be worth saving the extended processor state.
+// 
+
+#define SIGNATURE_AVX2_THRESHOLD 0x1000
+
+// 
+// The length of the longest solid run from which the skip table beats the byte per byte scan.
+// 
+
+#define SIGNATURE_SKIP_MINIMUM_RUN 8
+
+// 
+// The maximum length of the solid run used by the skip table, so every shift fits in a byte.
+// 
+
+#define SIGNATURE_SKIP_MAXIMUM_RUN 255
+
+/// <summary>
+/// The most frequent bytes found in x86/x64 machine code, ordered from the most to the least frequent.
+/// </summary>
+CONST UINT8 SignatureFrequentBytes[] =
+{
+	0x00, 0xFF, 0x48, 0x8B, 0xCC, 0x89, 0x4C, 0x24,
+	0x0F, 0xE8, 0x44, 0x85, 0x01, 0x83, 0xC0, 0x90,
+	0x74, 0x8D, 0x75, 0x08, 0x10, 0x45, 0x41, 0xC3,
+	0x33, 0x49, 0x20, 0x28, 0x30, 0x40, 0x38, 0x18,
+	0xC7, 0xE9, 0x84, 0xEB, 0x4D, 0xC1, 0x02, 0x03,
+	0x04, 0x50, 0x58, 0x60, 0x68, 0x70, 0x78, 0x80,
+};
+
+/// <summary>
+/// Gets the frequency rank of the given byte in machine code, higher meaning more frequent.
+/// </summary>
+/// <param name="InValue">The byte.</param>
+static ULONG CkSignatureByteFrequency(UINT8 InValue)
+{
+	for (ULONG I = 0; I < ARRAYSIZE(SignatureFrequentBytes); I++)
+	{
+		if (SignatureFrequentBytes[I] == InValue)
+			return ARRAYSIZE(SignatureFrequentBytes) - I;
+	}
+
+	return 0;
+}
+
+/// <summary>
+/// Parses a signature written in the IDA format, extended with nibble wildcards and bitmasks, into separate value and mask arrays.
+/// </summary>
+/// <param name="InSignature">The signature.</param>
+/// <param name="OutValues">The values, or null to only count the entries.</param>
+/// <param name="OutMasks">The masks, or null to only count the entries.</param>
+/// <param name="InCapacity">The number of entries the arrays can hold.</param>
+/// <param name="OutLength">The number of entries in the signature.</param>
+static NTSTATUS CkParseSignature(CONST CHAR* InSignature, OPTIONAL OUT UINT8* OutValues, OPTIONAL OUT UINT8* OutMasks, SIZE_T InCapacity, OUT SIZE_T* OutLength)
+{
+	SIZE_T SignatureLength = 0;
+	SIZE_T SignatureStep = 0;
+
+	while (InSignature[SignatureStep])
+	{
+		// 
+		// Skip the separators.
+		// 
+
+		if (InSignature[SignatureStep] == ' ' ||
+			InSignature[SignatureStep] == '-')
+		{
+			SignatureStep += 1;
+			continue;
+		}
+
+		// 
+		// Parse the entry.
+		// 
+
+		UINT8 Value;
+		UINT8 Mask;
+
+		if (!CkParseSignatureEntry(InSignature, &SignatureStep, &Value, &Mask))
+			return STATUS_INVALID_PARAMETER;
+
+		// 
+		// Store the entry, unless we are only counting them.
+		// 
+
+		if (OutValues != nullptr && OutMasks != nullptr)
+		{
+			if (SignatureLength >= InCapacity)
+				return STATUS_BUFFER_OVERFLOW;
+
+			OutValues[SignatureLength] = Value;
+			OutMasks[SignatureLength] = Mask;
+		}
+
+		SignatureLength++;
+	}
+
+	*OutLength = SignatureLength;
+	return SignatureLength != 0 ? STATUS_SUCCESS : STATUS_INVALID_PARAMETER;
+}
+
+/// <summary>
+/// Selects the two rarest solid bytes of the signature, used by the vectorized scan engines to find candidates.
+/// </summary>
+/// <param name="InOutSignature">The signature plan.</param>
+static VOID CkSelectSignatureAnchors(IN OUT CK_SIGNATURE* InOutSignature)
+{
+	SIZE_T FirstAnchor = SIGNATURE_NOT_FOUND;
+	SIZE_T SecondAnchor = SIGNATURE_NOT_FOUND;
+
+	for (SIZE_T I = 0; I < InOutSignature->Length; I++)
+	{
+		if (InOutSignature->Masks[I] != 0xFF)
+			continue;
+
+		CONST ULONG Frequency = CkSignatureByteFrequency(InOutSignature->Values[I]);
+
+		if (FirstAnchor == SIGNATURE_NOT_FOUND || Frequency < CkSignatureByteFrequency(InOutSignature->Values[FirstAnchor]))
+		{
+			SecondAnchor = FirstAnchor;
+			FirstAnchor = I;
+		}
+		else if (SecondAnchor == SIGNATURE_NOT_FOUND || Frequency < CkSignatureByteFrequency(InOutSignature->Values[SecondAnchor]))
+		{
+			SecondAnchor = I;
+		}
+	}
+
+	// 
+	// A signature with a single solid byte uses it for both anchors.
+	// 
+
+	if (SecondAnchor == SIGNATURE_NOT_FOUND)
+		SecondAnchor = FirstAnchor;
+
+	InOutSignature->FirstAnchor = FirstAnchor;
+	InOutSignature->SecondAnchor = SecondAnchor;
+	InOutSignature->HasAnchors = FirstAnchor != SIGNATURE_NOT_FOUND;
+}
+
+/// <summary>
+/// Selects the longest run of solid bytes of the signature and builds its bad character shift table.
+/// </summary>
+/// <param name="InOutSignature">The signature plan.</param>
+static VOID CkBuildSignatureSkipTable(IN OUT CK_SIGNATURE* InOutSignature)
+{
+	SIZE_T RunOffset = 0;
+	SIZE_T RunLength = 0;
+
+	for (SIZE_T I = 0; I < InOutSignature->Length; )
+	{
+		if (InOutSignature->Masks[I] != 0xFF)
+		{
+			I++;
+			continue;
+		}
+
+		SIZE_T J = I;
+
+		while (J < InOutSignature->Length && InOutSignature->Masks[J] == 0xFF)
+			J++;
+
+		if (J - I > RunLength)
+		{
+			RunOffset = I;
+			RunLength = J - I;
+		}
+
+		I = J;
+	}
+
+	if (RunLength > SIGNATURE_SKIP_MAXIMUM_RUN)
+		RunLength = SIGNATURE_SKIP_MAXIMUM_RUN;
+
+	InOutSignature->RunOffset = RunOffset;
+	InOutSignature->RunLength = RunLength;
+
+	// 
+	// A byte absent from the run moves the window past it, otherwise the window aligns on its last occurrence.
+	// 
+
+	RtlFillMemory(InOutSignature->Shifts, sizeof(InOutSignature->Shifts), (UINT8) RunLength);
+
+	for (SIZE_T I = 0; I + 1 < RunLength; I++)
+		InOutSignature->Shifts[InOutSignature->Values[RunOffset + I]] = (UINT8) (RunLength - 1 - I);
+}
+
+/// <summary>
+/// Precomputes the data used by the scan engines.
+/// </summary>
+/// <param name="InOutSignature">The signature plan.</param>
+static VOID CkPlanSignature(IN OUT CK_SIGNATURE* InOutSignature)
+{
+	CkSelectSignatureAnchors(InOutSignature);
+	CkBuildSignatureSkipTable(InOutSignature);
+}
+
+/// <summary>
+/// Checks whether the signature matches the data at the given address.
+/// </summary>
+/// <param name="InData">The data.</param>
+/// <param name="InSignature">The signature.</param>
+static BOOLEAN CkMatchSignature(CONST UINT8* InData, CONST CK_SIGNATURE* InSignature)
+{
+	for (SIZE_T I = 0; I < InSignature->Length; I++)
+	{
+		if ((InData[I] & InSignature->Masks[I]) != InSignature->Values[I])
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+/// <summary>
+/// Searches for the signature byte per byte, starting at the given offset.
+/// </summary>
+/// <param name="InData">The data.</param>
+/// <param name="InSize">The size of the data in bytes.</param>
+/// <param name="InSignature">The signature.</param>
+/// <param name="InOffset">The offset to start searching at.</param>
+static SIZE_T CkScanSignatureScalar(CONST UINT8* InData, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, SIZE_T InOffset)
+{
+	for (SIZE_T X = InOffset; X <= InSize - InSignature->Length; X++)
+	{
+		if (CkMatchSignature(&InData[X], InSignature))
+			return X;
+	}
+
+	return SIGNATURE_NOT_FOUND;
+}
+
+/// <summary>
+/// Searches for the signature with the skip table of its longest solid run, starting at the given offset.
+/// </summary>
+/// <param name="InData">The data.</param>
+/// <param name="InSize">The size of the data in bytes.</param>
+/// <param name="InSignature">The signature.</param>
+/// <param name="InOffset">The offset to start searching at.</param>
+static SIZE_T CkScanSignatureSkipTable(CONST UINT8* InData, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, SIZE_T InOffset)
+{
+	CONST UINT8* Run = &InSignature->Values[InSignature->RunOffset];
+	CONST SIZE_T RunLast = InSignature->RunLength - 1;
+
+	for (SIZE_T X = InOffset; X <= InSize - InSignature->Length; )
+	{
+		CONST UINT8* Window = &InData[X + InSignature->RunOffset];
+		CONST UINT8 Last = Window[RunLast];
+
+		if (Last == Run[RunLast] && RtlEqualMemory(Window, Run, RunLast) && CkMatchSignature(&InData[X], InSignature))
+			return X;
+
+		X += InSignature->Shifts[Last];
+	}
+
+	return SIGNATURE_NOT_FOUND;
+}
+
+#if defined(_M_AMD64)
+
+/// <summary>
+/// Searches for the signature 16 bytes at a time, using the anchors to filter candidates.
+/// </summary>
+/// <param name="InData">The data.</param>
+/// <param name="InSize">The size of the data in bytes.</param>
+/// <param name="InSignature">The signature.</param>
+/// <param name="InOffset">The offset to start searching at.</param>
+static SIZE_T CkScanSignatureSse2(CONST UINT8* InData, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, SIZE_T InOffset)
+{
+	CONST SIZE_T NumberOfCandidates = InSize - InSignature->Length + 1;
+	CONST __m128i FirstAnchor = _mm_set1_epi8((CHAR) InSignature->Values[InSignature->FirstAnchor]);
+	CONST __m128i SecondAnchor = _mm_set1_epi8((CHAR) InSignature->Values[InSignature->SecondAnchor]);
+
+	SIZE_T X = InOffset;
+
+	for (; X + 16 <= NumberOfCandidates; X += 16)
+	{
+		CONST __m128i FirstBlock = _mm_loadu_si128((CONST __m128i*) &InData[X + InSignature->FirstAnchor]);
+		CONST __m128i SecondBlock = _mm_loadu_si128((CONST __m128i*) &InData[X + InSignature->SecondAnchor]);
+		ULONG Candidates = (ULONG) _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(FirstBlock, FirstAnchor), _mm_cmpeq_epi8(SecondBlock, SecondAnchor)));
+
+		while (Candidates != 0)
+		{
+			ULONG Bit;
+			_BitScanForward(&Bit, Candidates);
+
+			if (CkMatchSignature(&InData[X + Bit], InSignature))
+				return X + Bit;
+
+			Candidates &= Candidates - 1;
+		}
+	}
+
+	return CkScanSignatureScalar(InData, InSize, InSignature, X);
+}
+
+/// <summary>
+/// Searches for the signature 32 bytes at a time, using the anchors to filter candidates.
+/// </summary>
+/// <param name="InData">The data.</param>
+/// <param name="InSize">The size of the data in bytes.</param>
+/// <param name="InSignature">The signature.</param>
+/// <param name="InOffset">The offset to start searching at.</param>
+///	<remarks>The caller must have saved the extended processor state.</remarks>
+static SIZE_T CkScanSignatureAvx2(CONST UINT8* InData, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, SIZE_T InOffset)
+{
+	CONST SIZE_T NumberOfCandidates = InSize - InSignature->Length + 1;
+	CONST __m256i FirstAnchor = _mm256_set1_epi8((CHAR) InSignature->Values[InSignature->FirstAnchor]);
+	CONST __m256i SecondAnchor = _mm256_set1_epi8((CHAR) InSignature->Values[InSignature->SecondAnchor]);
+
+	SIZE_T X = InOffset;
+
+	for (; X + 32 <= NumberOfCandidates; X += 32)
+	{
+		CONST __m256i FirstBlock = _mm256_loadu_si256((CONST __m256i*) &InData[X + InSignature->FirstAnchor]);
+		CONST __m256i SecondBlock = _mm256_loadu_si256((CONST __m256i*) &InData[X + InSignature->SecondAnchor]);
+		ULONG Candidates = (ULONG) _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(FirstBlock, FirstAnchor), _mm256_cmpeq_epi8(SecondBlock, SecondAnchor)));
+
+		while (Candidates != 0)
+		{
+			ULONG Bit;
+			_BitScanForward(&Bit, Candidates);
+
+			if (CkMatchSignature(&InData[X + Bit], InSignature))
+				return X + Bit;
+
+			Candidates &= Candidates - 1;
+		}
+	}
+
+	return CkScanSignatureScalar(InData, InSize, InSignature, X);
+}
+
+/// <summary>
+/// Gets a value indicating whether the processor and the operating system support AVX2.
+/// </summary>
+static BOOLEAN CkSignatureAvx2IsSupported()
+{
+	CONST auto* Capabilities = CkGetSystemCapabilities();
+
+	return (Capabilities->ProcessorFeatures & CK_PROCESSOR_FEATURE_AVX2) != 0 &&
+		   (Capabilities->SystemFeatures & CK_SYSTEM_FEATURE_AVX_STATE) != 0;
+}
+
+#endif
+
+typedef SIZE_T(* SIGNATURE_SCAN_ENGINE)(CONST UINT8* InData, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, SIZE_T InOffset);
+typedef bool(* SIGNATURE_MATCH_CALLBACK)(SIZE_T InOffset, PVOID InContext);
+
+/// <summary>
+/// Searches for every match of the signature with the fastest scan engine available, executing the callback for each of them.
+/// </summary>
+/// <param name="InData">The data.</param>
+/// <param name="InSize">The size of the data in bytes.</param>
+/// <param name="InSignature">The signature.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback, returning true to stop the scan.</param>
+static VOID CkScanSignatureMatches(CONST UINT8* InData, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, PVOID InContext, SIGNATURE_MATCH_CALLBACK InCallback)
+{
+	if (InSize < InSignature->Length)
+		return;
+
+	// 
+	// Signatures with a long solid run skip ahead with its shift table, the others, made
+	// of short runs or without any solid byte, are scanned byte per byte.
+	// 
+
+	SIGNATURE_SCAN_ENGINE Engine = CkScanSignatureScalar;
+
+	if (InSignature->RunLength >= SIGNATURE_SKIP_MINIMUM_RUN)
+		Engine = CkScanSignatureSkipTable;
+
+#if defined(_M_AMD64)
+
+	BOOLEAN ExtendedStateSaved = FALSE;
+	XSTATE_SAVE SaveState;
+
+	// 
+	// On x64, the anchor filter outperforms the skip table whatever the length of the run.
+	// 
+
+	if (InSignature->HasAnchors)
+	{
+		Engine = CkScanSignatureSse2;
+
+		// 
+		// Use AVX2 when the region is large enough to amortize saving the extended state.
+		// 
+
+		if (InSize >= SIGNATURE_AVX2_THRESHOLD && CkSignatureAvx2IsSupported())
+		{
+			if (NT_SUCCESS(KeSaveExtendedProcessorState(XSTATE_MASK_AVX, &SaveState)))
+			{
+				Engine = CkScanSignatureAvx2;
+				ExtendedStateSaved = TRUE;
+			}
+		}
+	}
+
+#endif
+
+	// 
+	// Resume the scan right after every match, so enumerating them all is a single linear pass.
+	// The extended state is restored even when reading the data raises an exception.
+	// 
+
+	__try
+	{
+		for (SIZE_T Offset = 0; (Offset = Engine(InData, InSize, InSignature, Offset)) != SIGNATURE_NOT_FOUND; Offset++)
+		{
+			if (InCallback(Offset, InContext))
+				break;
+		}
+	}
+	__finally
+	{
+
+#if defined(_M_AMD64)
+
+		if (ExtendedStateSaved)
+			KeRestoreExtendedProcessorState(&SaveState);
+
+#endif
+
+	}
+}
+
+/// <summary>
+/// Searches for the first match of the signature with the fastest scan engine available.
+/// </summary>
+/// <param name="InData">The data.</param>
+/// <param name="InSize">The size of the data in bytes.</param>
+/// <param name="InSignature">The signature.</param>
+static SIZE_T CkScanSignature(CONST UINT8* InData, SIZE_T InSize, CONST CK_SIGNATURE* InSignature)
+{
+	SIZE_T Result = SIGNATURE_NOT_FOUND;
+
+	CkScanSignatureMatches(InData, InSize, InSignature, &Result, [] (SIZE_T InOffset, PVOID InContext) -> bool
+	{
+		*(SIZE_T*) InContext = InOffset;
+		return true;
+	});
+
+	return Result;
+}
+
+/// <summary>
+/// Compiles a signature written in the IDA format so it can be reused across scans.
+/// </summary>
+/// <param name="InSignature">The signature.</param>
+/// <param name="OutSignature">The compiled signature.</param>
+///	<remarks>The compiled signature needs to be released with CkFreeSignature.</remarks>
+NTSTATUS CkCompileSignature(CONST CHAR* InSignature, OUT CK_SIGNATURE** OutSignature)
+{
+	NTSTATUS Status;
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InSignature == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (OutSignature == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	// 
+	// Count the number of entries in the signature.
+	// 
+
+	SIZE_T SignatureLength = 0;
+
+	if (NT_ERROR(Status = CkParseSignature(InSignature, nullptr, nullptr, 0, &SignatureLength)))
+		return STATUS_INVALID_PARAMETER_1;
+
+	// 
+	// Allocate the signature, its values and its masks in a single block.
+	// 
+
+	auto* Signature = (CK_SIGNATURE*) CkAllocatePool(NonPagedPoolNx, sizeof(CK_SIGNATURE) + SignatureLength * 2);
+
+	if (Signature == nullptr)
+		return STATUS_INSUFFICIENT_RESOURCES;
+
+	auto* SignatureValues = (UINT8*) RtlAddOffsetToPointer(Signature, sizeof(CK_SIGNATURE));
+	auto* SignatureMasks = (UINT8*) RtlAddOffsetToPointer(SignatureValues, SignatureLength);
+
+	if (NT_ERROR(Status = CkParseSignature(InSignature, SignatureValues, SignatureMasks, SignatureLength, &SignatureLength)))
+	{
+		CkFreePool(Signature);
+		return STATUS_INVALID_PARAMETER_1;
+	}
+
+	// 
+	// Precompute the scan data.
+	// 
+
+	Signature->Values = SignatureValues;
+	Signature->Masks = SignatureMasks;
+	Signature->Length = SignatureLength;
+	CkPlanSignature(Signature);
+
+	*OutSignature = Signature;
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Releases a signature previously compiled with CkCompileSignature.
+/// </summary>
+/// <param name="InSignature">The compiled signature.</param>
+VOID CkFreeSignature(CK_SIGNATURE* InSignature)
+{
+	CkFreePool(InSignature);
+}
+
+/// <summary>
+/// Initializes a signature over existing value and mask arrays, such as the ones of a signature literal.
+/// </summary>
+/// <param name="OutSignature">The signature.</param>
+/// <param name="InValues">The values, with the ignored bits cleared.</param>
+/// <param name="InMasks">The masks.</param>
+/// <param name="InLength">The number of entries.</param>
+VOID CkInitializeSignature(OUT CK_SIGNATURE* OutSignature, CONST UINT8* InValues, CONST UINT8* InMasks, SIZE_T InLength)
+{
+	OutSignature->Values = InValues;
+	OutSignature->Masks = InMasks;
+	OutSignature->Length = InLength;
+	CkPlanSignature(OutSignature);
+}
+
+/// <summary>
+/// Searches for a certain pattern inside the given memory range.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="OutResult">The result.</param>
+NTSTATUS CkTryFindPattern(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, OPTIONAL OUT PVOID* OutResult)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSize == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InSignature == nullptr || InSignature->Length == 0)
+		return STATUS_INVALID_PARAMETER_3;
+
+	// 
+	// The signature cannot be bigger than the region of memory we are about to scan.
+	// 
+
+	if (InSize < InSignature->Length)
+		return STATUS_ARRAY_BOUNDS_EXCEEDED;
+
+	// 
+	// Scan the memory region.
+	// 
+
+	CONST SIZE_T Offset = CkScanSignature((CONST UINT8*) InBaseAddress, InSize, InSignature);
+
+	if (Offset == SIGNATURE_NOT_FOUND)
+		return STATUS_NOT_FOUND;
+
+	if (OutResult != nullptr)
+		*OutResult = RtlAddOffsetToPointer(InBaseAddress, Offset);
+
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Searches for a certain pattern inside the given memory range.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The signature.</param>
+/// <param name="OutResult">The result.</param>
+NTSTATUS CkTryFindPattern(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CHAR* InSignature, OPTIONAL OUT PVOID* OutResult)
+{
+	NTSTATUS Status;
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSize == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InSignature == nullptr)
+		return STATUS_INVALID_PARAMETER_3;
+
+	// 
+	// Parse the signature on the stack when it is small enough.
+	// 
+
+	UINT8 SignatureValues[SIGNATURE_STACK_LENGTH];
+	UINT8 SignatureMasks[SIGNATURE_STACK_LENGTH];
+	SIZE_T SignatureLength = 0;
+
+	Status = CkParseSignature(InSignature, SignatureValues, SignatureMasks, SIGNATURE_STACK_LENGTH, &SignatureLength);
+
+	if (Status == STATUS_BUFFER_OVERFLOW)
+	{
+		// 
+		// Otherwise, compile it in the pool.
+		// 
+
+		CK_SIGNATURE* Signature = nullptr;
+
+		if (NT_ERROR(Status = CkCompileSignature(InSignature, &Signature)))
+			return Status == STATUS_INVALID_PARAMETER_1 ? STATUS_INVALID_PARAMETER_3 : Status;
+
+		Status = CkTryFindPattern(InBaseAddress, InSize, Signature, OutResult);
+		CkFreeSignature(Signature);
+		return Status;
+	}
+
+	if (NT_ERROR(Status))
+		return STATUS_INVALID_PARAMETER_3;
+
+	// 
+	// Plan the signature and scan the memory region.
+	// 
+
+	CK_SIGNATURE Signature;
+	Signature.Values = SignatureValues;
+	Signature.Masks = SignatureMasks;
+	Signature.Length = SignatureLength;
+	CkPlanSignature(&Signature);
+
+	return CkTryFindPattern(InBaseAddress, InSize, &Signature, OutResult);
+}
+
+/// <summary>
+/// Searches for every match of a certain pattern inside the given memory range.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback, executed with the ordinal of every match and returning true to stop the scan.</param>
+NTSTATUS CkFindAllPatterns(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, PVOID InContext, ENUMERATE_PATTERNS_WITH_CONTEXT InCallback)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSize == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InSignature == nullptr || InSignature->Length == 0)
+		return STATUS_INVALID_PARAMETER_3;
+
+	if (InCallback == nullptr)
+		return STATUS_INVALID_PARAMETER_5;
+
+	// 
+	// Setup the scan context.
+	// 
+
+	struct SCAN_CONTEXT
+	{
+		PVOID BaseAddress;
+		PVOID Context;
+		ENUMERATE_PATTERNS_WITH_CONTEXT Callback;
+		ULONG NumberOfMatches;
+	};
+
+	SCAN_CONTEXT ScanContext;
+	ScanContext.BaseAddress = InBaseAddress;
+	ScanContext.Context = InContext;
+	ScanContext.Callback = InCallback;
+	ScanContext.NumberOfMatches = 0;
+
+	// 
+	// Scan the memory region.
+	// 
+
+	CkScanSignatureMatches((CONST UINT8*) InBaseAddress, InSize, InSignature, &ScanContext, [] (SIZE_T InOffset, PVOID InContext) -> bool
+	{
+		auto* ScanContext = (SCAN_CONTEXT*) InContext;
+		return ScanContext->Callback(ScanContext->NumberOfMatches++, RtlAddOffsetToPointer(ScanContext->BaseAddress, InOffset), ScanContext->Context);
+	});
+
+	return ScanContext.NumberOfMatches != 0 ? STATUS_SUCCESS : STATUS_NOT_FOUND;
+}
+
+/// <summary>
+/// Searches for every match of a certain pattern inside the given memory range.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="OutResults">The results.</param>
+/// <param name="InMaximumNumberOfResults">The number of results the array can hold.</param>
+/// <param name="OutNumberOfResults">The number of results.</param>
+///	<returns>STATUS_BUFFER_OVERFLOW if there are more matches than the array can hold.</returns>
+NTSTATUS CkFindAllPatterns(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, OUT PVOID* OutResults, ULONG InMaximumNumberOfResults, OUT ULONG* OutNumberOfResults)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSize == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InSignature == nullptr || InSignature->Length == 0)
+		return STATUS_INVALID_PARAMETER_3;
+
+	if (OutResults == nullptr)
+		return STATUS_INVALID_PARAMETER_4;
+
+	if (InMaximumNumberOfResults == 0)
+		return STATUS_INVALID_PARAMETER_5;
+
+	if (OutNumberOfResults == nullptr)
+		return STATUS_INVALID_PARAMETER_6;
+
+	// 
+	// Setup the scan context.
+	// 
+
+	struct SCAN_CONTEXT
+	{
+		PVOID BaseAddress;
+		PVOID* Results;
+		ULONG MaximumNumberOfResults;
+		ULONG NumberOfResults;
+		BOOLEAN Overflow;
+	};
+
+	SCAN_CONTEXT ScanContext;
+	ScanContext.BaseAddress = InBaseAddress;
+	ScanContext.Results = OutResults;
+	ScanContext.MaximumNumberOfResults = InMaximumNumberOfResults;
+	ScanContext.NumberOfResults = 0;
+	ScanContext.Overflow = FALSE;
+
+	// 
+	// Scan the memory region, stopping at the first match which does not fit.
+	// 
+
+	CkScanSignatureMatches((CONST UINT8*) InBaseAddress, InSize, InSignature, &ScanContext, [] (SIZE_T InOffset, PVOID InContext) -> bool
+	{
+		auto* ScanContext = (SCAN_CONTEXT*) InContext;
+
+		if (ScanContext->NumberOfResults == ScanContext->MaximumNumberOfResults)
+		{
+			ScanContext->Overflow = TRUE;
+			return true;
+		}
+
+		ScanContext->Results[ScanContext->NumberOfResults++] = RtlAddOffsetToPointer(ScanContext->BaseAddress, InOffset);
+		return false;
+	});
+
+	*OutNumberOfResults = ScanContext.NumberOfResults;
+
+	if (ScanContext.NumberOfResults == 0)
+		return STATUS_NOT_FOUND;
+
+	return ScanContext.Overflow ? STATUS_BUFFER_OVERFLOW : STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Searches for every match of a certain pattern inside the given memory range.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The signature.</param>
+/// <param name="OutResults">The results.</param>
+/// <param name="InMaximumNumberOfResults">The number of results the array can hold.</param>
+/// <param name="OutNumberOfResults">The number of results.</param>
+///	<returns>STATUS_BUFFER_OVERFLOW if there are more matches than the array can hold.</returns>
+NTSTATUS CkFindAllPatterns(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CHAR* InSignature, OUT PVOID* OutResults, ULONG InMaximumNumberOfResults, OUT ULONG* OutNumberOfResults)
+{
+	NTSTATUS Status;
+
+	if (InSignature == nullptr)
+		return STATUS_INVALID_PARAMETER_3;
+
+	CK_SIGNATURE* Signature = nullptr;
+
+	if (NT_ERROR(Status = CkCompileSignature(InSignature, &Signature)))
+		return Status == STATUS_INVALID_PARAMETER_1 ? STATUS_INVALID_PARAMETER_3 : Status;
+
+	Status = CkFindAllPatterns(InBaseAddress, InSize, Signature, OutResults, InMaximumNumberOfResults, OutNumberOfResults);
+	CkFreeSignature(Signature);
+	return Status;
+}
+
+/// <summary>
+/// Counts the matches of a certain pattern inside the given memory range, stopping once the maximum is reached.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="InMaximumCount">The count to stop at, zero to count every match.</param>
+/// <param name="OutCount">The number of matches.</param>
+NTSTATUS CkCountPatternMatches(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, ULONG InMaximumCount, OUT ULONG* OutCount)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSize == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InSignature == nullptr || InSignature->Length == 0)
+		return STATUS_INVALID_PARAMETER_3;
+
+	if (OutCount == nullptr)
+		return STATUS_INVALID_PARAMETER_5;
+
+	// 
+	// Setup the scan context.
+	// 
+
+	struct SCAN_CONTEXT
+	{
+		ULONG MaximumCount;
+		ULONG Count;
+	};
+
+	SCAN_CONTEXT ScanContext;
+	ScanContext.MaximumCount = InMaximumCount;
+	ScanContext.Count = 0;
+
+	// 
+	// Scan the memory region.
+	// 
+
+	CkScanSignatureMatches((CONST UINT8*) InBaseAddress, InSize, InSignature, &ScanContext, [] (SIZE_T InOffset, PVOID InContext) -> bool
+	{
+		auto* ScanContext = (SCAN_CONTEXT*) InContext;
+		return ++ScanContext->Count == ScanContext->MaximumCount;
+	});
+
+	*OutCount = ScanContext.Count;
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Counts the matches of a certain pattern inside the given memory range, stopping once the maximum is reached.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The signature.</param>
+/// <param name="InMaximumCount">The count to stop at, zero to count every match.</param>
+/// <param name="OutCount">The number of matches.</param>
+NTSTATUS CkCountPatternMatches(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CHAR* InSignature, ULONG InMaximumCount, OUT ULONG* OutCount)
+{
+	NTSTATUS Status;
+
+	if (InSignature == nullptr)
+		return STATUS_INVALID_PARAMETER_3;
+
+	CK_SIGNATURE* Signature = nullptr;
+
+	if (NT_ERROR(Status = CkCompileSignature(InSignature, &Signature)))
+		return Status == STATUS_INVALID_PARAMETER_1 ? STATUS_INVALID_PARAMETER_3 : Status;
+
+	Status = CkCountPatternMatches(InBaseAddress, InSize, Signature, InMaximumCount, OutCount);
+	CkFreeSignature(Signature);
+	return Status;
+}
+
+typedef bool(* PADDING_RUN_CALLBACK)(SIZE_T InOffset, SIZE_T InLength, PVOID InContext);
+
+/// <summary>
+/// Searches for every run of the padding byte at least as long as the given length in a single pass, executing the callback for each of them.
+/// </summary>
+/// <param name="InData">The data.</param>
+/// <param name="InSize">The size of the data in bytes.</param>
+/// <param name="InPaddingByte">The padding byte.</param>
+/// <param name="InPaddingLength">The minimum length of a run.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback, returning true to stop the scan.</param>
+static VOID CkScanPaddingRuns(CONST UINT8* InData, SIZE_T InSize, UINT8 InPaddingByte, SIZE_T InPaddingLength, PVOID InContext, PADDING_RUN_CALLBACK InCallback)
+{
+	SIZE_T RunStart = SIGNATURE_NOT_FOUND;
+	SIZE_T X = 0;
+
+#if defined(_M_AMD64)
+
+	// 
+	// Build a mask of the bytes equal to the padding byte 64 bytes at a time, and only
+	// look at the bits where a run starts or ends.
+	// 
+
+	CONST __m128i Padding = _mm_set1_epi8((CHAR) InPaddingByte);
+
+	for (; X + 64 <= InSize; X += 64)
+	{
+		CONST ULONG64 Mask = (ULONG64) (UINT16) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((CONST __m128i*) &InData[X]), Padding))
+			| (ULONG64) (UINT16) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((CONST __m128i*) &InData[X + 16]), Padding)) << 16
+			| (ULONG64) (UINT16) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((CONST __m128i*) &InData[X + 32]), Padding)) << 32
+			| (ULONG64) (UINT16) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((CONST __m128i*) &InData[X + 48]), Padding)) << 48;
+
+		for (ULONG Bit = 0; Bit < 64; )
+		{
+			// 
+			// Look for the next padding byte outside of a run, or for the next other byte inside one.
+			// 
+
+			CONST ULONG64 Remaining = (RunStart == SIGNATURE_NOT_FOUND ? Mask : ~Mask) >> Bit;
+			ULONG Index;
+
+			if (!_BitScanForward64(&Index, Remaining))
+				break;
+
+			Bit += Index;
+
+			if (RunStart == SIGNATURE_NOT_FOUND)
+			{
+				RunStart = X + Bit;
+				continue;
+			}
+
+			if (X + Bit - RunStart >= InPaddingLength && InCallback(RunStart, X + Bit - RunStart, InContext))
+				return;
+
+			RunStart = SIGNATURE_NOT_FOUND;
+		}
+	}
+
+#endif
+
+	for (; X < InSize; X++)
+	{
+		if (InData[X] == InPaddingByte)
+		{
+			if (RunStart == SIGNATURE_NOT_FOUND)
+				RunStart = X;
+
+			continue;
+		}
+
+		if (RunStart != SIGNATURE_NOT_FOUND)
+		{
+			if (X - RunStart >= InPaddingLength && InCallback(RunStart, X - RunStart, InContext))
+				return;
+
+			RunStart = SIGNATURE_NOT_FOUND;
+		}
+	}
+
+	// 
+	// Report the run reaching the end of the data.
+	// 
+
+	if (RunStart != SIGNATURE_NOT_FOUND && InSize - RunStart >= InPaddingLength)
+		InCallback(RunStart, InSize - RunStart, InContext);
+}
+
+/// <summary>
+/// Searches for a successive pattern of a specific padding byte in the given memory range.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InPaddingByte">The padding byte.</param>
+/// <param name="InPaddingLength">The padding length.</param>
+/// <param name="OutResult">The result.</param>
+NTSTATUS CkTryFindPadding(CONST PVOID InBaseAddress, SIZE_T InSize, UINT8 InPaddingByte, SIZE_T InPaddingLength, OPTIONAL OUT PVOID* OutResult)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSize == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InPaddingLength == 0)
+		return STATUS_INVALID_PARAMETER_4;
+
+	// 
+	// The padding cannot be bigger than the region of memory we are about to scan.
+	// 
+
+	if (InSize < InPaddingLength)
+		return STATUS_ARRAY_BOUNDS_EXCEEDED;
+
+	// 
+	// Stop at the first run long enough.
+	// 
+
+	SIZE_T Offset = SIGNATURE_NOT_FOUND;
+
+	CkScanPaddingRuns((CONST UINT8*) InBaseAddress, InSize, InPaddingByte, InPaddingLength, &Offset, [] (SIZE_T InOffset, SIZE_T InLength, PVOID InContext) -> bool
+	{
+		*(SIZE_T*) InContext = InOffset;
+		return true;
+	});
+
+	if (Offset == SIGNATURE_NOT_FOUND)
+		return STATUS_NOT_FOUND;
+
+	if (OutResult != nullptr)
+		*OutResult = RtlAddOffsetToPointer(InBaseAddress, Offset);
+
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Searches for a successive pattern of a specific padding byte in the given memory range, starting from the end.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InPaddingByte">The padding byte.</param>
+/// <param name="InPaddingLength">The padding length.</param>
+/// <param name="OutResult">The result.</param>
+NTSTATUS CkTryFindPaddingFromEnd(CONST PVOID InBaseAddress, SIZE_T InSize, UINT8 InPaddingByte, SIZE_T InPaddingLength, OPTIONAL OUT PVOID* OutResult)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSize == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InPaddingLength == 0)
+		return STATUS_INVALID_PARAMETER_4;
+
+	// 
+	// The padding cannot be bigger than the region of memory we are about to scan.
+	// 
+
+	if (InSize < InPaddingLength)
+		return STATUS_ARRAY_BOUNDS_EXCEEDED;
+
+	// 
+	// Keep the end of the last run long enough, the result being the last padding of that length.
+	// 
+
+	SIZE_T RunEnd = SIGNATURE_NOT_FOUND;
+
+	CkScanPaddingRuns((CONST UINT8*) InBaseAddress, InSize, InPaddingByte, InPaddingLength, &RunEnd, [] (SIZE_T InOffset, SIZE_T InLength, PVOID InContext) -> bool
+	{
+		*(SIZE_T*) InContext = InOffset + InLength;
+		return false;
+	});
+
+	if (RunEnd == SIGNATURE_NOT_FOUND)
+		return STATUS_NOT_FOUND;
+
+	if (OutResult != nullptr)
+		*OutResult = RtlAddOffsetToPointer(InBaseAddress, RunEnd - InPaddingLength);
+
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// The runs collected by a padding scan, sorted by decreasing length.
+/// </summary>
+struct PADDING_RUN_RESULTS
+{
+	CK_PADDING_RUN* Runs;
+	ULONG NumberOfRuns;
+	ULONG MaximumNumberOfRuns;
+	SIZE_T BaseOffset;
+	BOOLEAN Overflowed;
+};
+
+/// <summary>
+/// Inserts a run in the results, keeping them sorted by decreasing length and dropping the shortest when full.
+/// </summary>
+/// <param name="InOffset">The offset of the run.</param>
+/// <param name="InLength">The length of the run.</param>
+/// <param name="InContext">The results.</param>
+static bool CkRecordPaddingRun(SIZE_T InOffset, SIZE_T InLength, PVOID InContext)
+{
+	auto* Results = (PADDING_RUN_RESULTS*) InContext;
+
+	if (Results->NumberOfRuns == Results->MaximumNumberOfRuns)
+	{
+		Results->Overflowed = TRUE;
+
+		if (Results->NumberOfRuns == 0 || Results->Runs[Results->NumberOfRuns - 1].Length >= InLength)
+			return false;
+
+		Results->NumberOfRuns--;
+	}
+
+	// 
+	// Runs of equal length stay in ascending order of offset.
+	// 
+
+	ULONG Index = Results->NumberOfRuns;
+
+	while (Index != 0 && Results->Runs[Index - 1].Length < InLength)
+	{
+		Results->Runs[Index] = Results->Runs[Index - 1];
+		Index--;
+	}
+
+	Results->Runs[Index].Offset = Results->BaseOffset + InOffset;
+	Results->Runs[Index].Length = InLength;
+	Results->NumberOfRuns++;
+	return false;
+}
+
+/// <summary>
+/// Searches for every run of a specific padding byte at least as long as the given length in the given memory range.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InPaddingByte">The padding byte.</param>
+/// <param name="InPaddingLength">The minimum padding length.</param>
+/// <param name="OutRuns">The runs, as offsets from the base address sorted by decreasing length.</param>
+/// <param name="InMaximumNumberOfRuns">The maximum number of runs.</param>
+/// <param name="OutNumberOfRuns">The number of runs.</param>
+NTSTATUS CkFindAllPaddings(CONST PVOID InBaseAddress, SIZE_T InSize, UINT8 InPaddingByte, SIZE_T InPaddingLength, OUT CK_PADDING_RUN* OutRuns, ULONG InMaximumNumberOfRuns, OUT ULONG* OutNumberOfRuns)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSize == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InPaddingLength == 0)
+		return STATUS_INVALID_PARAMETER_4;
+
+	if (OutRuns == nullptr)
+		return STATUS_INVALID_PARAMETER_5;
+
+	if (InMaximumNumberOfRuns == 0)
+		return STATUS_INVALID_PARAMETER_6;
+
+	if (OutNumberOfRuns == nullptr)
+		return STATUS_INVALID_PARAMETER_7;
+
+	// 
+	// Collect the runs.
+	// 
+
+	PADDING_RUN_RESULTS Results;
+	Results.Runs = OutRuns;
+	Results.NumberOfRuns = 0;
+	Results.MaximumNumberOfRuns = InMaximumNumberOfRuns;
+	Results.BaseOffset = 0;
+	Results.Overflowed = FALSE;
+
+	CkScanPaddingRuns((CONST UINT8*) InBaseAddress, InSize, InPaddingByte, InPaddingLength, &Results, CkRecordPaddingRun);
+
+	*OutNumberOfRuns = Results.NumberOfRuns;
+
+	if (Results.NumberOfRuns == 0)
+		return STATUS_NOT_FOUND;
+
+	return Results.Overflowed ? STATUS_BUFFER_OVERFLOW : STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Gets the address of a section's data if the section is mapped and contains code.
+/// </summary>
+/// <param name="InBaseAddress">The base address of the module.</param>
+/// <param name="InSectionHeader">The section header.</param>
+static PVOID CkGetExecutableSectionData(CONST PVOID InBaseAddress, CONST IMAGE_SECTION_HEADER* InSectionHeader)
+{
+	// 
+	// Parse the section's characteristics.
+	// 
+
+	auto Executable	 = (InSectionHeader->Characteristics & IMAGE_SCN_MEM_EXECUTE) != 0;
+	auto Discardable = (InSectionHeader->Characteristics & IMAGE_SCN_MEM_DISCARDABLE) != 0;
+	auto ContainCode = (InSectionHeader->Characteristics & IMAGE_SCN_CNT_CODE) != 0;
+
+	// 
+	// Discardable sections are not mapped.
+	// 
+
+	if (Discardable)
+		return nullptr;
+
+	// 
+	// Check if the section is executable or contains code.
+	// 
+
+	if (!Executable && !ContainCode)
+		return nullptr;
+
+	// 
+	// Verify the validity of the address.
+	// 
+
+	auto* SectionData = RtlAddOffsetToPointer(InBaseAddress, InSectionHeader->VirtualAddress);
+
+	if (InSectionHeader->Misc.VirtualSize == 0 || !MmIsAddressValid(SectionData))
+		return nullptr;
+
+	return SectionData;
+}
+
+/// <summary>
+/// Searches for a certain pattern inside the given module's executable sections.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="OutResult">The signature scan result.</param>
+NTSTATUS CkTryFindPatternInModuleExecutableSections(CONST PVOID InBaseAddress, CONST CK_SIGNATURE* InSignature, OPTIONAL OUT PVOID* OutResult)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSignature == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	// 
+	// Setup the scan context.
+	// 
+
+	struct SCAN_CONTEXT
+	{
+		PVOID BaseAddress;
+		CONST CK_SIGNATURE* Signature;
+		PVOID Result;
+	};
+
+	SCAN_CONTEXT ScanContext;
+	ScanContext.BaseAddress = InBaseAddress;
+	ScanContext.Signature = InSignature;
+	ScanContext.Result = nullptr;
+
+	// 
+	// Enumerate the sections of the module.
+	// 
+
+	RtlEnumerateModuleSections<SCAN_CONTEXT*>(InBaseAddress, &ScanContext, [] (ULONG InIndex, IMAGE_SECTION_HEADER* InSectionHeader, SCAN_CONTEXT* InContext) -> bool
+	{
+		// 
+		// Skip the sections which are not mapped or do not contain code.
+		// 
+
+		auto* SectionData = CkGetExecutableSectionData(InContext->BaseAddress, InSectionHeader);
+
+		if (SectionData == nullptr)
+			return FALSE;
+
+		// 
+		// Scan this section.
+		// 
+
+		return NT_SUCCESS(CkTryFindPattern(SectionData, InSectionHeader->Misc.VirtualSize, InContext->Signature, &InContext->Result));
+	});
+
+	// 
+	// Return the resulting address.
+	// 
+
+	if (OutResult != nullptr)
+		*OutResult = ScanContext.Result;
+
+	return ScanContext.Result != nullptr ? STATUS_SUCCESS : STATUS_NOT_FOUND;
+}
+
+/// <summary>
+/// Searches for a certain pattern inside the given module's executable sections.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSignature">The signature.</param>
+/// <param name="OutResult">The signature scan result.</param>
+NTSTATUS CkTryFindPatternInModuleExecutableSections(CONST PVOID InBaseAddress, CONST CHAR* InSignature, OPTIONAL OUT PVOID* OutResult)
+{
+	NTSTATUS Status;
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSignature == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	// 
+	// Compile the signature once for every section.
+	// 
+
+	CK_SIGNATURE* Signature = nullptr;
+
+	if (NT_ERROR(Status = CkCompileSignature(InSignature, &Signature)))
+		return Status == STATUS_INVALID_PARAMETER_1 ? STATUS_INVALID_PARAMETER_2 : Status;
+
+	Status = CkTryFindPatternInModuleExecutableSections(InBaseAddress, Signature, OutResult);
+	CkFreeSignature(Signature);
+	return Status;
+}
+
+/// <summary>
+/// Searches for every match of a certain pattern inside the given module's executable sections.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback, executed with the ordinal of every match and returning true to stop the scan.</param>
+NTSTATUS CkFindAllPatternsInModuleExecutableSections(CONST PVOID InBaseAddress, CONST CK_SIGNATURE* InSignature, PVOID InContext, ENUMERATE_PATTERNS_WITH_CONTEXT InCallback)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSignature == nullptr || InSignature->Length == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InCallback == nullptr)
+		return STATUS_INVALID_PARAMETER_4;
+
+	// 
+	// Setup the scan context.
+	// 
+
+	struct SCAN_CONTEXT
+	{
+		PVOID BaseAddress;
+		CONST CK_SIGNATURE* Signature;
+		PVOID SectionData;
+		PVOID Context;
+		ENUMERATE_PATTERNS_WITH_CONTEXT Callback;
+		ULONG NumberOfMatches;
+		BOOLEAN Stopped;
+	};
+
+	SCAN_CONTEXT ScanContext;
+	ScanContext.BaseAddress = InBaseAddress;
+	ScanContext.Signature = InSignature;
+	ScanContext.SectionData = nullptr;
+	ScanContext.Context = InContext;
+	ScanContext.Callback = InCallback;
+	ScanContext.NumberOfMatches = 0;
+	ScanContext.Stopped = FALSE;
+
+	// 
+	// Enumerate the sections of the module.
+	// 
+
+	RtlEnumerateModuleSections<SCAN_CONTEXT*>(InBaseAddress, &ScanContext, [] (ULONG InIndex, IMAGE_SECTION_HEADER* InSectionHeader, SCAN_CONTEXT* InContext) -> bool
+	{
+		// 
+		// Skip the sections which are not mapped or do not contain code.
+		// 
+
+		InContext->SectionData = CkGetExecutableSectionData(InContext->BaseAddress, InSectionHeader);
+
+		if (InContext->SectionData == nullptr)
+			return FALSE;
+
+		// 
+		// Scan this section, numbering the matches across every section.
+		// 
+
+		CkScanSignatureMatches((CONST UINT8*) InContext->SectionData, InSectionHeader->Misc.VirtualSize, InContext->Signature, InContext, [] (SIZE_T InOffset, PVOID InContext) -> bool
+		{
+			auto* ScanContext = (SCAN_CONTEXT*) InContext;
+			return ScanContext->Stopped = ScanContext->Callback(ScanContext->NumberOfMatches++, RtlAddOffsetToPointer(ScanContext->SectionData, InOffset), ScanContext->Context);
+		});
+
+		return InContext->Stopped;
+	});
+
+	return ScanContext.NumberOfMatches != 0 ? STATUS_SUCCESS : STATUS_NOT_FOUND;
+}
+
+/// <summary>
+/// Searches for every run of a specific padding byte at least as long as the given length inside the given module's executable sections.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InPaddingByte">The padding byte.</param>
+/// <param name="InPaddingLength">The minimum padding length.</param>
+/// <param name="OutRuns">The runs, as relative virtual addresses sorted by decreasing length.</param>
+/// <param name="InMaximumNumberOfRuns">The maximum number of runs.</param>
+/// <param name="OutNumberOfRuns">The number of runs.</param>
+NTSTATUS CkFindAllPaddingsInModuleExecutableSections(CONST PVOID InBaseAddress, UINT8 InPaddingByte, SIZE_T InPaddingLength, OUT CK_PADDING_RUN* OutRuns, ULONG InMaximumNumberOfRuns, OUT ULONG* OutNumberOfRuns)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InPaddingLength == 0)
+		return STATUS_INVALID_PARAMETER_3;
+
+	if (OutRuns == nullptr)
+		return STATUS_INVALID_PARAMETER_4;
+
+	if (InMaximumNumberOfRuns == 0)
+		return STATUS_INVALID_PARAMETER_5;
+
+	if (OutNumberOfRuns == nullptr)
+		return STATUS_INVALID_PARAMETER_6;
+
+	// 
+	// Setup the scan context.
+	// 
+
+	struct SCAN_CONTEXT
+	{
+		PVOID BaseAddress;
+		UINT8 PaddingByte;
+		SIZE_T PaddingLength;
+		PADDING_RUN_RESULTS Results;
+	};
+
+	SCAN_CONTEXT ScanContext;
+	ScanContext.BaseAddress = InBaseAddress;
+	ScanContext.PaddingByte = InPaddingByte;
+	ScanContext.PaddingLength = InPaddingLength;
+	ScanContext.Results.Runs = OutRuns;
+	ScanContext.Results.NumberOfRuns = 0;
+	ScanContext.Results.MaximumNumberOfRuns = InMaximumNumberOfRuns;
+	ScanContext.Results.BaseOffset = 0;
+	ScanContext.Results.Overflowed = FALSE;
+
+	// 
+	// Collect the runs of every section, as relative virtual addresses.
+	// 
+
+	RtlEnumerateModuleSections<SCAN_CONTEXT*>(InBaseAddress, &ScanContext, [] (ULONG InIndex, IMAGE_SECTION_HEADER* InSectionHeader, SCAN_CONTEXT* InContext) -> bool
+	{
+		auto* SectionData = CkGetExecutableSectionData(InContext->BaseAddress, InSectionHeader);
+
+		if (SectionData == nullptr)
+			return FALSE;
+
+		InContext->Results.BaseOffset = InSectionHeader->VirtualAddress;
+		CkScanPaddingRuns((CONST UINT8*) SectionData, InSectionHeader->Misc.VirtualSize, InContext->PaddingByte, InContext->PaddingLength, &InContext->Results, CkRecordPaddingRun);
+		return FALSE;
+	});
+
+	*OutNumberOfRuns = ScanContext.Results.NumberOfRuns;
+
+	if (ScanContext.Results.NumberOfRuns == 0)
+		return STATUS_NOT_FOUND;
+
+	return ScanContext.Results.Overflowed ? STATUS_BUFFER_OVERFLOW : STATUS_SUCCESS;
+}
+
+// 
+// The maximum length of the solid run each signature of a set contributes to the automaton.
+// 
+
+#define SIGNATURE_SET_KEY_LENGTH 8
+
+// 
+// The marker for the end of a chain in the automaton.
+// 
+
+#define SIGNATURE_SET_NONE ((ULONG) -1)
+
+/// <summary>
+/// A set of signatures matched together by a single automaton.
+/// </summary>
+struct CK_SIGNATURE_SET
+{
+	ULONG NumberOfSignatures;
+	CONST CK_SIGNATURE** Signatures;
+	SIZE_T* KeyOffsets;
+	SIZE_T* KeyLengths;
+	ULONG* NextSignatures;
+	ULONG NumberOfStates;
+	ULONG* FirstSignatures;
+	ULONG* OutputLinks;
+	UINT16* Transitions;
+};
+
+/// <summary>
+/// Selects the rarest run of solid bytes of the signature, up to the maximum key length.
+/// </summary>
+/// <param name="InSignature">The signature.</param>
+/// <param name="OutKeyOffset">The offset of the key in the signature.</param>
+/// <param name="OutKeyLength">The length of the key, zero if the signature has no solid byte.</param>
+static VOID CkSelectSignatureSetKey(CONST CK_SIGNATURE* InSignature, OUT SIZE_T* OutKeyOffset, OUT SIZE_T* OutKeyLength)
+{
+	SIZE_T BestOffset = 0;
+	SIZE_T BestLength = 0;
+	ULONG BestFrequency = 0;
+
+	for (SIZE_T I = 0; I < InSignature->Length; I++)
+	{
+		// 
+		// Measure the window of solid bytes starting at this entry.
+		// 
+
+		SIZE_T Length = 0;
+		ULONG Frequency = 0;
+
+		while (Length < SIGNATURE_SET_KEY_LENGTH && I + Length < InSignature->Length && InSignature->Masks[I + Length] == 0xFF)
+		{
+			Frequency += CkSignatureByteFrequency(InSignature->Values[I + Length]);
+			Length++;
+		}
+
+		// 
+		// Prefer the longest windows, then the rarest ones.
+		// 
+
+		if (Length > BestLength || (Length == BestLength && Length != 0 && Frequency < BestFrequency))
+		{
+			BestOffset = I;
+			BestLength = Length;
+			BestFrequency = Frequency;
+		}
+	}
+
+	*OutKeyOffset = BestOffset;
+	*OutKeyLength = BestLength;
+}
+
+/// <summary>
+/// Compiles a set of signatures into an automaton matching all of them in a single pass.
+/// </summary>
+/// <param name="InSignatures">The compiled signatures.</param>
+/// <param name="InNumberOfSignatures">The number of signatures.</param>
+/// <param name="OutSignatureSet">The signature set.</param>
+///	<remarks>The signatures must outlive the set, which needs to be released with CkFreeSignatureSet.</remarks>
+NTSTATUS CkCompileSignatureSet(CONST CK_SIGNATURE* CONST* InSignatures, ULONG InNumberOfSignatures, OUT CK_SIGNATURE_SET** OutSignatureSet)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InSignatures == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InNumberOfSignatures == 0 || InNumberOfSignatures > (MAXUINT16 - 1) / SIGNATURE_SET_KEY_LENGTH)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (OutSignatureSet == nullptr)
+		return STATUS_INVALID_PARAMETER_3;
+
+	for (ULONG I = 0; I < InNumberOfSignatures; I++)
+	{
+		if (InSignatures[I] == nullptr || InSignatures[I]->Length == 0)
+			return STATUS_INVALID_PARAMETER_1;
+	}
+
+	// 
+	// Allocate the set and its arrays in a single block, assuming every key gets its own states.
+	// 
+
+	CONST ULONG MaximumNumberOfStates = 1 + InNumberOfSignatures * SIGNATURE_SET_KEY_LENGTH;
+	CONST SIZE_T SignaturesSize = InNumberOfSignatures * (sizeof(CK_SIGNATURE*) + sizeof(SIZE_T) * 2 + sizeof(ULONG));
+	CONST SIZE_T StatesSize = MaximumNumberOfStates * (sizeof(ULONG) * 2 + sizeof(UINT16) * 256);
+
+	auto* SignatureSet = (CK_SIGNATURE_SET*) CkAllocatePool(NonPagedPoolNx, sizeof(CK_SIGNATURE_SET) + SignaturesSize + StatesSize);
+
+	if (SignatureSet == nullptr)
+		return STATUS_INSUFFICIENT_RESOURCES;
+
+	SignatureSet->NumberOfSignatures = InNumberOfSignatures;
+	SignatureSet->Signatures = (CONST CK_SIGNATURE**) RtlAddOffsetToPointer(SignatureSet, sizeof(CK_SIGNATURE_SET));
+	SignatureSet->KeyOffsets = (SIZE_T*) &SignatureSet->Signatures[InNumberOfSignatures];
+	SignatureSet->KeyLengths = &SignatureSet->KeyOffsets[InNumberOfSignatures];
+	SignatureSet->NextSignatures = (ULONG*) &SignatureSet->KeyLengths[InNumberOfSignatures];
+	SignatureSet->FirstSignatures = &SignatureSet->NextSignatures[InNumberOfSignatures];
+	SignatureSet->OutputLinks = &SignatureSet->FirstSignatures[MaximumNumberOfStates];
+	SignatureSet->Transitions = (UINT16*) &SignatureSet->OutputLinks[MaximumNumberOfStates];
+	SignatureSet->NumberOfStates = 1;
+
+	for (ULONG I = 0; I < MaximumNumberOfStates; I++)
+	{
+		SignatureSet->FirstSignatures[I] = SIGNATURE_SET_NONE;
+		SignatureSet->OutputLinks[I] = SIGNATURE_SET_NONE;
+	}
+
+	// 
+	// Insert the key of every signature in the trie, the root being the state zero.
+	// 
+
+	for (ULONG I = 0; I < InNumberOfSignatures; I++)
+	{
+		CONST CK_SIGNATURE* Signature = InSignatures[I];
+
+		SignatureSet->Signatures[I] = Signature;
+		SignatureSet->NextSignatures[I] = SIGNATURE_SET_NONE;
+		CkSelectSignatureSetKey(Signature, &SignatureSet->KeyOffsets[I], &SignatureSet->KeyLengths[I]);
+
+		// 
+		// Signatures without any solid byte are scanned on their own.
+		// 
+
+		if (SignatureSet->KeyLengths[I] == 0)
+			continue;
+
+		ULONG State = 0;
+
+		for (SIZE_T J = 0; J < SignatureSet->KeyLengths[I]; J++)
+		{
+			auto* Transition = &SignatureSet->Transitions[State * 256 + Signature->Values[SignatureSet->KeyOffsets[I] + J]];
+
+			if (*Transition == 0)
+				*Transition = (UINT16) SignatureSet->NumberOfStates++;
+
+			State = *Transition;
+		}
+
+		SignatureSet->NextSignatures[I] = SignatureSet->FirstSignatures[State];
+		SignatureSet->FirstSignatures[State] = I;
+	}
+
+	// 
+	// Turn the trie into a complete automaton, visiting the states breadth first.
+	// 
+
+	auto* FailureLinks = (UINT16*) CkAllocatePool(NonPagedPoolNx, SignatureSet->NumberOfStates * sizeof(UINT16) * 2);
+
+	if (FailureLinks == nullptr)
+	{
+		CkFreePool(SignatureSet);
+		return STATUS_INSUFFICIENT_RESOURCES;
+	}
+
+	auto* Queue = &FailureLinks[SignatureSet->NumberOfStates];
+	ULONG QueueHead = 0;
+	ULONG QueueTail = 0;
+
+	for (ULONG Value = 0; Value < 256; Value++)
+	{
+		CONST UINT16 Child = SignatureSet->Transitions[Value];
+
+		if (Child != 0)
+		{
+			FailureLinks[Child] = 0;
+			Queue[QueueTail++] = Child;
+		}
+	}
+
+	while (QueueHead < QueueTail)
+	{
+		CONST UINT16 State = Queue[QueueHead++];
+		CONST UINT16 FailureLink = FailureLinks[State];
+
+		// 
+		// Link the state to the closest suffix state which completes a key.
+		// 
+
+		SignatureSet->OutputLinks[State] = SignatureSet->FirstSignatures[FailureLink] != SIGNATURE_SET_NONE ? FailureLink : SignatureSet->OutputLinks[FailureLink];
+
+		for (ULONG Value = 0; Value < 256; Value++)
+		{
+			auto* Transition = &SignatureSet->Transitions[State * 256 + Value];
+			CONST UINT16 FailureTransition = SignatureSet->Transitions[FailureLink * 256 + Value];
+
+			if (*Transition != 0)
+			{
+				FailureLinks[*Transition] = FailureTransition;
+				Queue[QueueTail++] = *Transition;
+			}
+			else
+			{
+				*Transition = FailureTransition;
+			}
+		}
+	}
+
+	CkFreePool(FailureLinks);
+
+	*OutSignatureSet = SignatureSet;
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Releases a signature set previously compiled with CkCompileSignatureSet.
+/// </summary>
+/// <param name="InSignatureSet">The signature set.</param>
+VOID CkFreeSignatureSet(CK_SIGNATURE_SET* InSignatureSet)
+{
+	CkFreePool(InSignatureSet);
+}
+
+/// <summary>
+/// Gets the number of signatures in the given set.
+/// </summary>
+/// <param name="InSignatureSet">The signature set.</param>
+ULONG CkGetSignatureSetCount(CONST CK_SIGNATURE_SET* InSignatureSet)
+{
+	return InSignatureSet != nullptr ? InSignatureSet->NumberOfSignatures : 0;
+}
+
+/// <summary>
+/// Searches for every signature of the set in a single pass, executing the callback for each match.
+/// </summary>
+/// <param name="InData">The data.</param>
+/// <param name="InSize">The size of the data in bytes.</param>
+/// <param name="InSignatureSet">The signature set.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback, returning true to stop the scan.</param>
+/// <returns>True if the callback stopped the scan, false otherwise.</returns>
+static BOOLEAN CkScanSignatureSet(CONST UINT8* InData, SIZE_T InSize, CONST CK_SIGNATURE_SET* InSignatureSet, PVOID InContext, ENUMERATE_PATTERNS_WITH_CONTEXT InCallback)
+{
+	// 
+	// Walk the automaton over the data, verifying the whole signature whenever one of the keys is completed.
+	// 
+
+	ULONG State = 0;
+
+	for (SIZE_T I = 0; I < InSize; I++)
+	{
+		State = InSignatureSet->Transitions[State * 256 + InData[I]];
+
+		for (ULONG OutputState = InSignatureSet->FirstSignatures[State] != SIGNATURE_SET_NONE ? State : InSignatureSet->OutputLinks[State];
+			 OutputState != SIGNATURE_SET_NONE;
+			 OutputState = InSignatureSet->OutputLinks[OutputState])
+		{
+			for (ULONG Index = InSignatureSet->FirstSignatures[OutputState]; Index != SIGNATURE_SET_NONE; Index = InSignatureSet->NextSignatures[Index])
+			{
+				CONST CK_SIGNATURE* Signature = InSignatureSet->Signatures[Index];
+				CONST SIZE_T KeyEnd = InSignatureSet->KeyOffsets[Index] + InSignatureSet->KeyLengths[Index];
+
+				// 
+				// Make sure the whole signature fits in the data.
+				// 
+
+				if (I + 1 < KeyEnd)
+					continue;
+
+				CONST SIZE_T Offset = I + 1 - KeyEnd;
+
+				if (Offset + Signature->Length > InSize)
+					continue;
+
+				if (CkMatchSignature(&InData[Offset], Signature))
+				{
+					if (InCallback(Index, (PVOID) &InData[Offset], InContext))
+						return TRUE;
+				}
+			}
+		}
+	}
+
+	// 
+	// Scan the signatures without any solid byte on their own.
+	// 
+
+	for (ULONG Index = 0; Index < InSignatureSet->NumberOfSignatures; Index++)
+	{
+		CONST CK_SIGNATURE* Signature = InSignatureSet->Signatures[Index];
+
+		if (InSignatureSet->KeyLengths[Index] != 0 || InSize < Signature->Length)
+			continue;
+
+		for (SIZE_T Offset = 0; (Offset = CkScanSignatureScalar(InData, InSize, Signature, Offset)) != SIGNATURE_NOT_FOUND; Offset++)
+		{
+			if (InCallback(Index, (PVOID) &InData[Offset], InContext))
+				return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/// <summary>
+/// Searches for every signature of the set inside the given memory range in a single pass.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignatureSet">The signature set.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback, executed for every match and returning true to stop the scan.</param>
+NTSTATUS CkEnumeratePatterns(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_SIGNATURE_SET* InSignatureSet, PVOID InContext, ENUMERATE_PATTERNS_WITH_CONTEXT InCallback)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSize == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InSignatureSet == nullptr)
+		return STATUS_INVALID_PARAMETER_3;
+
+	if (InCallback == nullptr)
+		return STATUS_INVALID_PARAMETER_5;
+
+	CkScanSignatureSet((CONST UINT8*) InBaseAddress, InSize, InSignatureSet, InContext, InCallback);
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// The state of a search for the first match of every signature in a set.
+/// </summary>
+struct SIGNATURE_SET_RESULTS
+{
+	PVOID* Results;
+	ULONG NumberOfResults;
+	ULONG NumberOfSignatures;
+};
+
+/// <summary>
+/// Records the first match of a signature, stopping the scan once every signature has been found.
+/// </summary>
+/// <param name="InIndex">The index of the signature in the set.</param>
+/// <param name="InAddress">The address of the match.</param>
+/// <param name="InContext">The results.</param>
+static bool CkRecordFirstPattern(ULONG InIndex, PVOID InAddress, VOID* InContext)
+{
+	auto* Results = (SIGNATURE_SET_RESULTS*) InContext;
+
+	if (Results->Results[InIndex] == nullptr)
+	{
+		Results->Results[InIndex] = InAddress;
+		Results->NumberOfResults++;
+	}
+
+	return Results->NumberOfResults == Results->NumberOfSignatures;
+}
+
+/// <summary>
+/// Searches for the first match of every signature of the set inside the given memory range in a single pass.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignatureSet">The signature set.</param>
+/// <param name="OutResults">The results, one per signature of the set, null for the signatures which were not found.</param>
+///	<returns>STATUS_SUCCESS if every signature was found, STATUS_NOT_FOUND otherwise.</returns>
+NTSTATUS CkTryFindPatterns(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_SIGNATURE_SET* InSignatureSet, OUT PVOID* OutResults)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSize == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InSignatureSet == nullptr)
+		return STATUS_INVALID_PARAMETER_3;
+
+	if (OutResults == nullptr)
+		return STATUS_INVALID_PARAMETER_4;
+
+	// 
+	// Scan the memory region.
+	// 
+
+	RtlZeroMemory(OutResults, InSignatureSet->NumberOfSignatures * sizeof(PVOID));
+
+	SIGNATURE_SET_RESULTS Results;
+	Results.Results = OutResults;
+	Results.NumberOfResults = 0;
+	Results.NumberOfSignatures = InSignatureSet->NumberOfSignatures;
+
+	CkScanSignatureSet((CONST UINT8*) InBaseAddress, InSize, InSignatureSet, &Results, CkRecordFirstPattern);
+	return Results.NumberOfResults == Results.NumberOfSignatures ? STATUS_SUCCESS : STATUS_NOT_FOUND;
+}
+
+/// <summary>
+/// Searches for the first match of every signature of the set inside the given module's executable sections, scanning each section once.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSignatureSet">The signature set.</param>
+/// <param name="OutResults">The results, one per signature of the set, null for the signatures which were not found.</param>
+///	<returns>STATUS_SUCCESS if every signature was found, STATUS_NOT_FOUND otherwise.</returns>
+NTSTATUS CkTryFindPatternsInModuleExecutableSections(CONST PVOID InBaseAddress, CONST CK_SIGNATURE_SET* InSignatureSet, OUT PVOID* OutResults)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSignatureSet == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (OutResults == nullptr)
+		return STATUS_INVALID_PARAMETER_3;
+
+	// 
+	// Setup the scan context.
+	// 
+
+	struct SCAN_CONTEXT
+	{
+		PVOID BaseAddress;
+		CONST CK_SIGNATURE_SET* SignatureSet;
+		SIGNATURE_SET_RESULTS Results;
+	};
+
+	RtlZeroMemory(OutResults, InSignatureSet->NumberOfSignatures * sizeof(PVOID));
+
+	SCAN_CONTEXT ScanContext;
+	ScanContext.BaseAddress = InBaseAddress;
+	ScanContext.SignatureSet = InSignatureSet;
+	ScanContext.Results.Results = OutResults;
+	ScanContext.Results.NumberOfResults = 0;
+	ScanContext.Results.NumberOfSignatures = InSignatureSet->NumberOfSignatures;
+
+	// 
+	// Enumerate the sections of the module, in ascending order so the first match of each signature is the lowest.
+	// 
+
+	RtlEnumerateModuleSections<SCAN_CONTEXT*>(InBaseAddress, &ScanContext, [] (ULONG InIndex, IMAGE_SECTION_HEADER* InSectionHeader, SCAN_CONTEXT* InContext) -> bool
+	{
+		// 
+		// Skip the sections which are not mapped or do not contain code.
+		// 
+
+		auto* SectionData = CkGetExecutableSectionData(InContext->BaseAddress, InSectionHeader);
+
+		if (SectionData == nullptr)
+			return FALSE;
+
+		// 
+		// Scan this section.
+		// 
+
+		return CkScanSignatureSet((CONST UINT8*) SectionData, InSectionHeader->Misc.VirtualSize, InContext->SignatureSet, &InContext->Results, CkRecordFirstPattern);
+	});
+
+	return ScanContext.Results.NumberOfResults == ScanContext.Results.NumberOfSignatures ? STATUS_SUCCESS : STATUS_NOT_FOUND;
+}
+
+/// <summary>
+/// Resolves the address described by an entry of a resolution table out of the match of its signature.
+/// </summary>
+/// <param name="InBaseAddress">The base address of the module.</param>
+/// <param name="InSizeOfImage">The size of the module's image.</param>
+/// <param name="InMatch">The match of the signature, or null if it was not found.</param>
+/// <param name="InEntry">The entry.</param>
+/// <param name="OutResult">The resolved address.</param>
+static NTSTATUS CkResolveSignatureEntry(CONST PVOID InBaseAddress, SIZE_T InSizeOfImage, CONST PVOID InMatch, CONST CK_SIGNATURE_RESOLUTION* InEntry, OUT PVOID* OutResult)
+{
+	if (InMatch == nullptr)
+		return STATUS_NOT_FOUND;
+
+	// 
+	// The instruction must lie inside the image.
+	// 
+
+	auto InstructionOffset = (INT64) ((CONST UINT8*) InMatch - (CONST UINT8*) InBaseAddress) + InEntry->InstructionOffset;
+
+	if (InstructionOffset < 0 || (UINT64) InstructionOffset >= InSizeOfImage)
+		return STATUS_INVALID_ADDRESS;
+
+	auto* Instruction = RtlAddOffsetToPointer(InBaseAddress, InstructionOffset);
+
+	if (InEntry->InstructionLength == 0)
+	{
+		*OutResult = Instruction;
+		return STATUS_SUCCESS;
+	}
+
+	// 
+	// So must its relative address, before it is followed.
+	// 
+
+	if ((UINT64) InstructionOffset + InEntry->RelativeAddressOffset + sizeof(INT32) > InSizeOfImage)
+		return STATUS_INVALID_ADDRESS;
+
+	if (!MmIsAddressValid(RtlAddOffsetToPointer(Instruction, InEntry->RelativeAddressOffset))
+	 || !MmIsAddressValid(RtlAddOffsetToPointer(Instruction, InEntry->RelativeAddressOffset + sizeof(INT32) - 1)))
+		return STATUS_INVALID_ADDRESS;
+
+	*OutResult = ResolveRelativeAddress(Instruction, InEntry->RelativeAddressOffset, InEntry->InstructionLength);
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Resolves every entry of the table inside the given module's executable sections, scanning each section once.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InOutEntries">The entries, receiving their result and their status.</param>
+/// <param name="InNumberOfEntries">The number of entries.</param>
+/// <param name="OutNumberOfFailures">The number of entries which could not be resolved.</param>
+///	<remarks>The instruction starts at the given offset from the match. Its relative address is followed as with ResolveRelativeAddress, unless the instruction length is zero in which case the instruction address itself is the result.</remarks>
+///	<returns>STATUS_SUCCESS if every entry was resolved, STATUS_NOT_FOUND otherwise, or the failure of the signature set, which every entry then receives as its status.</returns>
+NTSTATUS CkResolveSignatures(CONST PVOID InBaseAddress, CK_SIGNATURE_RESOLUTION* InOutEntries, ULONG InNumberOfEntries, OPTIONAL OUT ULONG* OutNumberOfFailures)
+{
+	NTSTATUS Status;
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InOutEntries == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InNumberOfEntries == 0)
+		return STATUS_INVALID_PARAMETER_3;
+
+	auto* NtHeaders = RtlModuleNtHeaders(InBaseAddress);
+
+	if (NtHeaders == nullptr)
+		return STATUS_INVALID_IMAGE_FORMAT;
+
+	// 
+	// Allocate the compiled signatures, their matches and the entries they belong to in a single block.
+	// 
+
+	auto* Signatures = (CK_SIGNATURE**) CkAllocatePool(NonPagedPoolNx, InNumberOfEntries * (sizeof(CK_SIGNATURE*) + sizeof(PVOID) + sizeof(ULONG)));
+
+	if (Signatures == nullptr)
+		return STATUS_INSUFFICIENT_RESOURCES;
+
+	auto* Matches = (PVOID*) RtlAddOffsetToPointer(Signatures, InNumberOfEntries * sizeof(CK_SIGNATURE*));
+	auto* EntryIndices = (ULONG*) RtlAddOffsetToPointer(Matches, InNumberOfEntries * sizeof(PVOID));
+
+	// 
+	// Compile the signatures, the invalid ones failing right away.
+	// 
+
+	ULONG NumberOfSignatures = 0;
+
+	for (ULONG I = 0; I < InNumberOfEntries; I++)
+	{
+		auto* Entry = &InOutEntries[I];
+
+		if (Entry->Result != nullptr)
+			*Entry->Result = nullptr;
+
+		if (NT_ERROR(Entry->Status = CkCompileSignature(Entry->Signature, &Signatures[NumberOfSignatures])))
+			continue;
+
+		EntryIndices[NumberOfSignatures++] = I;
+	}
+
+	// 
+	// Search for every signature at once.
+	// 
+
+	RtlZeroMemory(Matches, InNumberOfEntries * sizeof(PVOID));
+
+	if (NumberOfSignatures != 0)
+	{
+		CK_SIGNATURE_SET* SignatureSet = nullptr;
+
+		if (NT_ERROR(Status = CkCompileSignatureSet(Signatures, NumberOfSignatures, &SignatureSet)))
+		{
+			// 
+			// None of the entries can be resolved, so they all carry the failure of the set.
+			// 
+
+			for (ULONG I = 0; I < NumberOfSignatures; I++)
+			{
+				InOutEntries[EntryIndices[I]].Status = Status;
+				CkFreeSignature(Signatures[I]);
+			}
+
+			CkFreePool(Signatures);
+
+			if (OutNumberOfFailures != nullptr)
+				*OutNumberOfFailures = InNumberOfEntries;
+
+			return Status;
+		}
+
+		CkTryFindPatternsInModuleExecutableSections(InBaseAddress, SignatureSet, Matches);
+		CkFreeSignatureSet(SignatureSet);
+	}
+
+	// 
+	// Resolve the entries out of their matches.
+	// 
+
+	for (ULONG I = 0; I < NumberOfSignatures; I++)
+	{
+		auto* Entry = &InOutEntries[EntryIndices[I]];
+		PVOID Result = nullptr;
+
+		if (NT_SUCCESS(Entry->Status = CkResolveSignatureEntry(InBaseAddress, NtHeaders->OptionalHeader.SizeOfImage, Matches[I], Entry, &Result)) && Entry->Result != nullptr)
+			*Entry->Result = Result;
+
+		CkFreeSignature(Signatures[I]);
+	}
+
+	CkFreePool(Signatures);
+
+	// 
+	// Count the entries which failed.
+	// 
+
+	ULONG NumberOfFailures = 0;
+
+	for (ULONG I = 0; I < InNumberOfEntries; I++)
+	{
+		if (NT_ERROR(InOutEntries[I].Status))
+			NumberOfFailures++;
+	}
+
+	if (OutNumberOfFailures != nullptr)
+		*OutNumberOfFailures = NumberOfFailures;
+
+	return NumberOfFailures == 0 ? STATUS_SUCCESS : STATUS_NOT_FOUND;
+}
+
+// 
+// The maximum number of instructions of a compiled byte pattern.
+// 
+
+#define BYTE_PATTERN_MAXIMUM_INSTRUCTIONS 0x2000
+
+// 
+// The maximum nesting depth of the groups of a byte pattern.
+// 
+
+#define BYTE_PATTERN_MAXIMUM_DEPTH 16
+
+// 
+// The maximum number of bytes skipped by a gap of a byte pattern.
+// 
+
+#define BYTE_PATTERN_MAXIMUM_GAP 255
+
+// 
+// The operations of a compiled byte pattern.
+// 
+
+#define BYTE_PATTERN_OP_BYTE  0		// Consumes a byte whose masked bits are equal to the value.
+#define BYTE_PATTERN_OP_RANGE 1		// Consumes a byte between the two bounds, included.
+#define BYTE_PATTERN_OP_SPLIT 2		// Continues at both targets, the first one being preferred.
+#define BYTE_PATTERN_OP_JUMP  3		// Continues at the target.
+#define BYTE_PATTERN_OP_MATCH 4		// Reports a match.
+
+// 
+// The value of a jump target which was not patched yet.
+// 
+
+#define BYTE_PATTERN_NO_TARGET ((ULONG) -1)
+
+/// <summary>
+/// An instruction of a compiled byte pattern.
+/// </summary>
+struct BYTE_PATTERN_INSTRUCTION
+{
+	UINT8 Opcode;
+	UINT8 First;
+	UINT8 Second;
+	ULONG Target;
+	ULONG Alternate;
+};
+
+/// <summary>
+/// A byte pattern compiled into instructions, matched by simulating every alternative at once.
+/// </summary>
+struct CK_BYTE_PATTERN
+{
+	BYTE_PATTERN_INSTRUCTION* Instructions;
+	ULONG NumberOfInstructions;
+	SIZE_T MinimumLength;
+	BOOLEAN FirstBytes[256];
+};
+
+/// <summary>
+/// The state of the compilation of a byte pattern, which first only counts the instructions.
+/// </summary>
+struct BYTE_PATTERN_COMPILER
+{
+	CONST CHAR* Pattern;
+	SIZE_T Step;
+	BYTE_PATTERN_INSTRUCTION* Instructions;
+	ULONG NumberOfInstructions;
+	ULONG Depth;
+};
+
+/// <summary>
+/// A thread of the simulation of a byte pattern, waiting on an instruction.
+/// </summary>
+struct BYTE_PATTERN_THREAD
+{
+	ULONG Pc;
+	SIZE_T Start;
+};
+
+/// <summary>
+/// The memory used to simulate a byte pattern, sized after its number of instructions.
+/// </summary>
+struct BYTE_PATTERN_WORKSPACE
+{
+	PVOID Buffer;
+	BYTE_PATTERN_THREAD* Current;
+	BYTE_PATTERN_THREAD* Next;
+	ULONG NumberOfCurrent;
+	ULONG NumberOfNext;
+	SIZE_T* Marks;
+	ULONG* Stack;
+	SIZE_T Generation;
+	SIZE_T CurrentGeneration;
+};
+
+/// <summary>
+/// Appends an instruction to the byte pattern, unless the instructions are only being counted.
+/// </summary>
+/// <param name="InOutCompiler">The compiler.</param>
+/// <param name="InOpcode">The operation.</param>
+/// <param name="InFirst">The value or the lower bound.</param>
+/// <param name="InSecond">The mask or the upper bound.</param>
+///	<returns>The index of the instruction.</returns>
+static ULONG CkEmitBytePatternInstruction(IN OUT BYTE_PATTERN_COMPILER* InOutCompiler, UINT8 InOpcode, UINT8 InFirst = 0, UINT8 InSecond = 0)
+{
+	CONST ULONG Index = InOutCompiler->NumberOfInstructions++;
+
+	if (InOutCompiler->Instructions != nullptr)
+	{
+		InOutCompiler->Instructions[Index].Opcode = InOpcode;
+		InOutCompiler->Instructions[Index].First = InFirst;
+		InOutCompiler->Instructions[Index].Second = InSecond;
+		InOutCompiler->Instructions[Index].Target = BYTE_PATTERN_NO_TARGET;
+		InOutCompiler->Instructions[Index].Alternate = BYTE_PATTERN_NO_TARGET;
+	}
+
+	return Index;
+}
+
+/// <summary>
+/// Sets the targets of a jump or a split instruction, unless the instructions are only being counted.
+/// </summary>
+/// <param name="InOutCompiler">The compiler.</param>
+/// <param name="InIndex">The index of the instruction.</param>
+/// <param name="InOpcode">The operation.</param>
+/// <param name="InTarget">The target.</param>
+/// <param name="InAlternate">The alternate target of a split.</param>
+static VOID CkPatchBytePatternInstruction(IN OUT BYTE_PATTERN_COMPILER* InOutCompiler, ULONG InIndex, UINT8 InOpcode, ULONG InTarget, ULONG InAlternate = BYTE_PATTERN_NO_TARGET)
+{
+	if (InOutCompiler->Instructions == nullptr)
+		return;
+
+	InOutCompiler->Instructions[InIndex].Opcode = InOpcode;
+	InOutCompiler->Instructions[InIndex].Target = InTarget;
+	InOutCompiler->Instructions[InIndex].Alternate = InAlternate;
+}
+
+static BOOLEAN CkCompileBytePatternSequence(IN OUT BYTE_PATTERN_COMPILER* InOutCompiler, OUT SIZE_T* OutMinimumLength);
+
+/// <summary>
+/// Compiles a group of alternatives, "(48 8B | 4C 8B)", the opening parenthesis being the current character.
+/// </summary>
+/// <param name="InOutCompiler">The compiler.</param>
+/// <param name="OutMinimumLength">The length of the shortest alternative.</param>
+static BOOLEAN CkCompileBytePatternGroup(IN OUT BYTE_PATTERN_COMPILER* InOutCompiler, OUT SIZE_T* OutMinimumLength)
+{
+	if (++InOutCompiler->Depth > BYTE_PATTERN_MAXIMUM_DEPTH)
+		return FALSE;
+
+	InOutCompiler->Step++;
+
+	// 
+	// Every alternative is preceded by a split to the next one, and followed by a jump to the end of the group,
+	// the jumps being chained through their target until it is known.
+	// 
+
+	ULONG LastJump = BYTE_PATTERN_NO_TARGET;
+	SIZE_T MinimumLength = (SIZE_T) -1;
+
+	while (TRUE)
+	{
+		CONST ULONG Split = CkEmitBytePatternInstruction(InOutCompiler, BYTE_PATTERN_OP_SPLIT);
+		SIZE_T AlternativeLength = 0;
+
+		if (!CkCompileBytePatternSequence(InOutCompiler, &AlternativeLength))
+			return FALSE;
+
+		if (AlternativeLength < MinimumLength)
+			MinimumLength = AlternativeLength;
+
+		if (InOutCompiler->Pattern[InOutCompiler->Step] == '|')
+		{
+			CONST ULONG Jump = CkEmitBytePatternInstruction(InOutCompiler, BYTE_PATTERN_OP_JUMP);
+			CkPatchBytePatternInstruction(InOutCompiler, Jump, BYTE_PATTERN_OP_JUMP, LastJump);
+			CkPatchBytePatternInstruction(InOutCompiler, Split, BYTE_PATTERN_OP_SPLIT, Split + 1, InOutCompiler->NumberOfInstructions);
+
+			LastJump = Jump;
+			InOutCompiler->Step++;
+			continue;
+		}
+
+		if (InOutCompiler->Pattern[InOutCompiler->Step] != ')')
+			return FALSE;
+
+		// 
+		// The last alternative has nothing to split to.
+		// 
+
+		CkPatchBytePatternInstruction(InOutCompiler, Split, BYTE_PATTERN_OP_JUMP, Split + 1);
+		InOutCompiler->Step++;
+		break;
+	}
+
+	// 
+	// Point the chained jumps to the end of the group.
+	// 
+
+	if (InOutCompiler->Instructions != nullptr)
+	{
+		while (LastJump != BYTE_PATTERN_NO_TARGET)
+		{
+			CONST ULONG PreviousJump = InOutCompiler->Instructions[LastJump].Target;
+			InOutCompiler->Instructions[LastJump].Target = InOutCompiler->NumberOfInstructions;
+			LastJump = PreviousJump;
+		}
+	}
+
+	InOutCompiler->Depth--;
+	*OutMinimumLength = MinimumLength;
+	return TRUE;
+}
+
+/// <summary>
+/// Compiles a gap of any bytes, "[4]" or "[2-6]", the opening bracket being the current character.
+/// </summary>
+/// <param name="InOutCompiler">The compiler.</param>
+/// <param name="OutMinimumLength">The minimum number of bytes of the gap.</param>
+static BOOLEAN CkCompileBytePatternGap(IN OUT BYTE_PATTERN_COMPILER* InOutCompiler, OUT SIZE_T* OutMinimumLength)
+{
+	CONST CHAR* Pattern = InOutCompiler->Pattern;
+	SIZE_T Step = InOutCompiler->Step + 1;
+	SIZE_T Bounds[2] = { 0, 0 };
+
+	// 
+	// Parse the decimal bounds, the upper one defaulting to the lower one.
+	// 
+
+	for (SIZE_T I = 0; I < 2; I++)
+	{
+		if (Pattern[Step] < '0' || Pattern[Step] > '9')
+			return FALSE;
+
+		while (Pattern[Step] >= '0' && Pattern[Step] <= '9')
+		{
+			Bounds[I] = Bounds[I] * 10 + (Pattern[Step++] - '0');
+
+			if (Bounds[I] > BYTE_PATTERN_MAXIMUM_GAP)
+				return FALSE;
+		}
+
+		if (I == 0 && Pattern[Step] != '-')
+		{
+			Bounds[1] = Bounds[0];
+			break;
+		}
+
+		if (I == 0)
+			Step++;
+	}
+
+	if (Pattern[Step] != ']' || Bounds[0] > Bounds[1])
+		return FALSE;
+
+	InOutCompiler->Step = Step + 1;
+
+	// 
+	// The mandatory bytes, then the optional ones, each of them preferably consumed.
+	// 
+
+	for (SIZE_T I = 0; I < Bounds[0]; I++)
+		CkEmitBytePatternInstruction(InOutCompiler, BYTE_PATTERN_OP_BYTE, 0x00, 0x00);
+
+	CONST ULONG End = InOutCompiler->NumberOfInstructions + (ULONG) (Bounds[1] - Bounds[0]) * 2;
+
+	for (SIZE_T I = Bounds[0]; I < Bounds[1]; I++)
+	{
+		CONST ULONG Split = CkEmitBytePatternInstruction(InOutCompiler, BYTE_PATTERN_OP_SPLIT);
+		CkPatchBytePatternInstruction(InOutCompiler, Split, BYTE_PATTERN_OP_SPLIT, Split + 1, End);
+		CkEmitBytePatternInstruction(InOutCompiler, BYTE_PATTERN_OP_BYTE, 0x00, 0x00);
+	}
+
+	*OutMinimumLength = Bounds[0];
+	return TRUE;
+}
+
+/// <summary>
+/// Compiles a sequence of bytes, ranges, gaps and groups, up to the end of the pattern, of the alternative or of the group.
+/// </summary>
+/// <param name="InOutCompiler">The compiler.</param>
+/// <param name="OutMinimumLength">The minimum number of bytes matched by the sequence.</param>
+static BOOLEAN CkCompileBytePatternSequence(IN OUT BYTE_PATTERN_COMPILER* InOutCompiler, OUT SIZE_T* OutMinimumLength)
+{
+	CONST CHAR* Pattern = InOutCompiler->Pattern;
+	SIZE_T MinimumLength = 0;
+
+	while (TRUE)
+	{
+		CONST CHAR Character = Pattern[InOutCompiler->Step];
+
+		// 
+		// Skip the separators.
+		// 
+
+		if (Character == ' ' || Character == '-')
+		{
+			InOutCompiler->Step++;
+			continue;
+		}
+
+		// 
+		// Stop at the end of the pattern, of the alternative or of the group.
+		// 
+
+		if (Character == '\0' || Character == '|' || Character == ')')
+			break;
+
+		SIZE_T ItemLength = 1;
+
+		if (Character == '(')
+		{
+			if (!CkCompileBytePatternGroup(InOutCompiler, &ItemLength))
+				return FALSE;
+		}
+		else if (Character == '[')
+		{
+			if (!CkCompileBytePatternGap(InOutCompiler, &ItemLength))
+				return FALSE;
+		}
+		else
+		{
+			// 
+			// A byte, as in the IDA format, or a range of bytes such as "70..7F".
+			// 
+
+			UINT8 Value;
+			UINT8 Mask;
+
+			if (!CkParseSignatureEntry(Pattern, &InOutCompiler->Step, &Value, &Mask))
+				return FALSE;
+
+			if (Pattern[InOutCompiler->Step] == '.' && Pattern[InOutCompiler->Step + 1] == '.')
+			{
+				UINT8 UpperValue;
+				UINT8 UpperMask;
+
+				InOutCompiler->Step += 2;
+
+				if (!CkParseSignatureEntry(Pattern, &InOutCompiler->Step, &UpperValue, &UpperMask))
+					return FALSE;
+
+				if (Mask != 0xFF || UpperMask != 0xFF || Value > UpperValue)
+					return FALSE;
+
+				CkEmitBytePatternInstruction(InOutCompiler, BYTE_PATTERN_OP_RANGE, Value, UpperValue);
+			}
+			else
+			{
+				CkEmitBytePatternInstruction(InOutCompiler, BYTE_PATTERN_OP_BYTE, Value, Mask);
+			}
+		}
+
+		MinimumLength += ItemLength;
+	}
+
+	*OutMinimumLength = MinimumLength;
+	return TRUE;
+}
+
+/// <summary>
+/// Adds a thread to a list of the simulation, following the jumps and the splits.
+/// </summary>
+/// <param name="InPattern">The byte pattern.</param>
+/// <param name="InOutWorkspace">The workspace.</param>
+/// <param name="InOutThreads">The list of threads.</param>
+/// <param name="InOutNumberOfThreads">The number of threads in the list.</param>
+/// <param name="InGeneration">The generation of the list, marking the instructions it already holds.</param>
+/// <param name="InPc">The instruction.</param>
+/// <param name="InStart">The offset at which the thread started matching.</param>
+///	<returns>TRUE if the thread reached the end of the pattern.</returns>
+static BOOLEAN CkAddBytePatternThread(CONST CK_BYTE_PATTERN* InPattern, IN OUT BYTE_PATTERN_WORKSPACE* InOutWorkspace, IN OUT BYTE_PATTERN_THREAD* InOutThreads, IN OUT ULONG* InOutNumberOfThreads, SIZE_T InGeneration, ULONG InPc, SIZE_T InStart)
+{
+	BOOLEAN Matched = FALSE;
+	ULONG StackSize = 0;
+
+	InOutWorkspace->Stack[StackSize++] = InPc;
+
+	while (StackSize != 0)
+	{
+		CONST ULONG Pc = InOutWorkspace->Stack[--StackSize];
+
+		// 
+		// A thread which started earlier already waits on this instruction.
+		// 
+
+		if (InOutWorkspace->Marks[Pc] == InGeneration)
+			continue;
+
+		InOutWorkspace->Marks[Pc] = InGeneration;
+
+		CONST BYTE_PATTERN_INSTRUCTION* Instruction = &InPattern->Instructions[Pc];
+
+		switch (Instruction->Opcode)
+		{
+			case BYTE_PATTERN_OP_JUMP:
+				InOutWorkspace->Stack[StackSize++] = Instruction->Target;
+				break;
+
+			case BYTE_PATTERN_OP_SPLIT:
+				InOutWorkspace->Stack[StackSize++] = Instruction->Alternate;
+				InOutWorkspace->Stack[StackSize++] = Instruction->Target;
+				break;
+
+			case BYTE_PATTERN_OP_MATCH:
+				Matched = TRUE;
+				break;
+
+			default:
+				InOutThreads[*InOutNumberOfThreads].Pc = Pc;
+				InOutThreads[*InOutNumberOfThreads].Start = InStart;
+				(*InOutNumberOfThreads)++;
+				break;
+		}
+	}
+
+	return Matched;
+}
+
+/// <summary>
+/// Searches for the leftmost match of a byte pattern, following every alternative at once.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InPattern">The byte pattern.</param>
+/// <param name="InOutWorkspace">The workspace.</param>
+/// <param name="OutLength">The length of the shortest match at that offset.</param>
+///	<returns>The offset of the match, or SIGNATURE_NOT_FOUND.</returns>
+static SIZE_T CkScanBytePattern(CONST UINT8* InBaseAddress, SIZE_T InSize, CONST CK_BYTE_PATTERN* InPattern, IN OUT BYTE_PATTERN_WORKSPACE* InOutWorkspace, OUT SIZE_T* OutLength)
+{
+	SIZE_T BestStart = SIGNATURE_NOT_FOUND;
+	SIZE_T BestLength = 0;
+
+	InOutWorkspace->NumberOfCurrent = 0;
+
+	for (SIZE_T I = 0; I < InSize; I++)
+	{
+		// 
+		// Start a new thread at every offset until a match is found, skipping the bytes no match can start with.
+		// 
+
+		if (BestStart == SIGNATURE_NOT_FOUND)
+		{
+			if (InOutWorkspace->NumberOfCurrent == 0)
+			{
+				while (I < InSize && !InPattern->FirstBytes[InBaseAddress[I]])
+					I++;
+
+				if (I == InSize)
+					break;
+
+				InOutWorkspace->CurrentGeneration = ++InOutWorkspace->Generation;
+			}
+
+			CkAddBytePatternThread(InPattern, InOutWorkspace, InOutWorkspace->Current, &InOutWorkspace->NumberOfCurrent, InOutWorkspace->CurrentGeneration, 0, I);
+		}
+
+		// 
+		// Advance every thread over this byte, the earliest ones first.
+		// 
+
+		CONST SIZE_T NextGeneration = ++InOutWorkspace->Generation;
+		CONST UINT8 Byte = InBaseAddress[I];
+
+		InOutWorkspace->NumberOfNext = 0;
+
+		for (ULONG J = 0; J < InOutWorkspace->NumberOfCurrent; J++)
+		{
+			CONST BYTE_PATTERN_THREAD* Thread = &InOutWorkspace->Current[J];
+			CONST BYTE_PATTERN_INSTRUCTION* Instruction = &InPattern->Instructions[Thread->Pc];
+
+			if (BestStart != SIGNATURE_NOT_FOUND && Thread->Start >= BestStart)
+				continue;
+
+			if (Instruction->Opcode == BYTE_PATTERN_OP_BYTE && (Byte & Instruction->Second) != Instruction->First)
+				continue;
+
+			if (Instruction->Opcode == BYTE_PATTERN_OP_RANGE && (Byte < Instruction->First || Byte > Instruction->Second))
+				continue;
+
+			if (CkAddBytePatternThread(InPattern, InOutWorkspace, InOutWorkspace->Next, &InOutWorkspace->NumberOfNext, NextGeneration, Thread->Pc + 1, Thread->Start)
+			 && Thread->Start < BestStart)
+			{
+				BestStart = Thread->Start;
+				BestLength = I + 1 - Thread->Start;
+			}
+		}
+
+		auto* Threads = InOutWorkspace->Current;
+		InOutWorkspace->Current = InOutWorkspace->Next;
+		InOutWorkspace->Next = Threads;
+		InOutWorkspace->NumberOfCurrent = InOutWorkspace->NumberOfNext;
+		InOutWorkspace->CurrentGeneration = NextGeneration;
+
+		// 
+		// Once a match is found, only the threads which started earlier can still beat it.
+		// 
+
+		if (BestStart != SIGNATURE_NOT_FOUND && (InOutWorkspace->NumberOfCurrent == 0 || InOutWorkspace->Current[0].Start >= BestStart))
+			break;
+	}
+
+	*OutLength = BestLength;
+	return BestStart;
+}
+
+/// <summary>
+/// Allocates the workspace used to simulate the given byte pattern.
+/// </summary>
+/// <param name="InPattern">The byte pattern.</param>
+/// <param name="OutWorkspace">The workspace, to be released with CkFreeBytePatternWorkspace.</param>
+static NTSTATUS CkAllocateBytePatternWorkspace(CONST CK_BYTE_PATTERN* InPattern, OUT BYTE_PATTERN_WORKSPACE* OutWorkspace)
+{
+	CONST SIZE_T NumberOfInstructions = InPattern->NumberOfInstructions;
+
+	// 
+	// Each list holds at most a thread per instruction, and each split pushes two instructions on the stack.
+	// 
+
+	auto* Threads = (BYTE_PATTERN_THREAD*) CkAllocatePool(NonPagedPoolNx, NumberOfInstructions * (sizeof(BYTE_PATTERN_THREAD) * 2 + sizeof(SIZE_T)) + (NumberOfInstructions * 2 + 1) * sizeof(ULONG));
+
+	if (Threads == nullptr)
+		return STATUS_INSUFFICIENT_RESOURCES;
+
+	OutWorkspace->Buffer = Threads;
+	OutWorkspace->Current = Threads;
+	OutWorkspace->Next = Threads + NumberOfInstructions;
+	OutWorkspace->Marks = (SIZE_T*) (Threads + NumberOfInstructions * 2);
+	OutWorkspace->Stack = (ULONG*) (OutWorkspace->Marks + NumberOfInstructions);
+	OutWorkspace->NumberOfCurrent = 0;
+	OutWorkspace->NumberOfNext = 0;
+	OutWorkspace->Generation = 0;
+	OutWorkspace->CurrentGeneration = 0;
+
+	RtlZeroMemory(OutWorkspace->Marks, NumberOfInstructions * sizeof(SIZE_T));
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Releases a workspace allocated with CkAllocateBytePatternWorkspace.
+/// </summary>
+/// <param name="InWorkspace">The workspace.</param>
+static VOID CkFreeBytePatternWorkspace(BYTE_PATTERN_WORKSPACE* InWorkspace)
+{
+	CkFreePool(InWorkspace->Buffer);
+}
+
+/// <summary>
+/// Compiles a byte pattern, which extends the IDA format with alternatives "(48 | 4C)", ranges "70..7F" and gaps "[2-6]".
+/// </summary>
+/// <param name="InPattern">The pattern.</param>
+/// <param name="OutPattern">The compiled byte pattern.</param>
+///	<remarks>The compiled byte pattern needs to be released with CkFreeBytePattern.</remarks>
+NTSTATUS CkCompileBytePattern(CONST CHAR* InPattern, OUT CK_BYTE_PATTERN** OutPattern)
+{
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InPattern == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (OutPattern == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	// 
+	// Count the instructions, rejecting the patterns which could match nothing.
+	// 
+
+	BYTE_PATTERN_COMPILER Compiler;
+	Compiler.Pattern = InPattern;
+	Compiler.Step = 0;
+	Compiler.Instructions = nullptr;
+	Compiler.NumberOfInstructions = 0;
+	Compiler.Depth = 0;
+
+	SIZE_T MinimumLength = 0;
+
+	if (!CkCompileBytePatternSequence(&Compiler, &MinimumLength) || InPattern[Compiler.Step] != '\0' || MinimumLength == 0)
+		return STATUS_INVALID_PARAMETER_1;
+
+	CONST ULONG NumberOfInstructions = Compiler.NumberOfInstructions + 1;
+
+	if (NumberOfInstructions > BYTE_PATTERN_MAXIMUM_INSTRUCTIONS)
+		return STATUS_INVALID_PARAMETER_1;
+
+	// 
+	// Allocate the pattern and its instructions in a single block, then emit them.
+	// 
+
+	auto* Pattern = (CK_BYTE_PATTERN*) CkAllocatePool(NonPagedPoolNx, sizeof(CK_BYTE_PATTERN) + NumberOfInstructions * sizeof(BYTE_PATTERN_INSTRUCTION));
+
+	if (Pattern == nullptr)
+		return STATUS_INSUFFICIENT_RESOURCES;
+
+	Pattern->Instructions = (BYTE_PATTERN_INSTRUCTION*) RtlAddOffsetToPointer(Pattern, sizeof(CK_BYTE_PATTERN));
+	Pattern->NumberOfInstructions = NumberOfInstructions;
+	Pattern->MinimumLength = MinimumLength;
+
+	Compiler.Step = 0;
+	Compiler.Instructions = Pattern->Instructions;
+	Compiler.NumberOfInstructions = 0;
+	Compiler.Depth = 0;
+
+	CkCompileBytePatternSequence(&Compiler, &MinimumLength);
+	CkEmitBytePatternInstruction(&Compiler, BYTE_PATTERN_OP_MATCH);
+
+	// 
+	// Gather the bytes a match can start with, out of the threads waiting on the first byte.
+	// 
+
+	BYTE_PATTERN_WORKSPACE Workspace;
+
+	if (!NT_SUCCESS(CkAllocateBytePatternWorkspace(Pattern, &Workspace)))
+	{
+		CkFreePool(Pattern);
+		return STATUS_INSUFFICIENT_RESOURCES;
+	}
+
+	CkAddBytePatternThread(Pattern, &Workspace, Workspace.Current, &Workspace.NumberOfCurrent, ++Workspace.Generation, 0, 0);
+	RtlZeroMemory(Pattern->FirstBytes, sizeof(Pattern->FirstBytes));
+
+	for (ULONG I = 0; I < Workspace.NumberOfCurrent; I++)
+	{
+		CONST BYTE_PATTERN_INSTRUCTION* Instruction = &Pattern->Instructions[Workspace.Current[I].Pc];
+
+		for (ULONG Byte = 0; Byte < 256; Byte++)
+		{
+			if (Instruction->Opcode == BYTE_PATTERN_OP_BYTE ? ((Byte & Instruction->Second) == Instruction->First) : (Byte >= Instruction->First && Byte <= Instruction->Second))
+				Pattern->FirstBytes[Byte] = TRUE;
+		}
+	}
+
+	CkFreeBytePatternWorkspace(&Workspace);
+
+	*OutPattern = Pattern;
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Releases a byte pattern previously compiled with CkCompileBytePattern.
+/// </summary>
+/// <param name="InPattern">The compiled byte pattern.</param>
+VOID CkFreeBytePattern(CK_BYTE_PATTERN* InPattern)
+{
+	CkFreePool(InPattern);
+}
+
+/// <summary>
+/// Searches for the first match of a byte pattern inside the given memory range, in a single pass.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InPattern">The compiled byte pattern.</param>
+/// <param name="OutResult">The address of the match.</param>
+/// <param name="OutLength">The length of the shortest match at that address.</param>
+NTSTATUS CkTryFindBytePattern(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_BYTE_PATTERN* InPattern, OPTIONAL OUT PVOID* OutResult, OPTIONAL OUT SIZE_T* OutLength)
+{
+	NTSTATUS Status;
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSize == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InPattern == nullptr)
+		return STATUS_INVALID_PARAMETER_3;
+
+	// 
+	// Scan the memory region.
+	// 
+
+	BYTE_PATTERN_WORKSPACE Workspace;
+
+	if (NT_ERROR(Status = CkAllocateBytePatternWorkspace(InPattern, &Workspace)))
+		return Status;
+
+	SIZE_T Length = 0;
+	CONST SIZE_T Offset = CkScanBytePattern((CONST UINT8*) InBaseAddress, InSize, InPattern, &Workspace, &Length);
+	CkFreeBytePatternWorkspace(&Workspace);
+
+	if (Offset == SIGNATURE_NOT_FOUND)
+		return STATUS_NOT_FOUND;
+
+	if (OutResult != nullptr)
+		*OutResult = RtlAddOffsetToPointer(InBaseAddress, Offset);
+
+	if (OutLength != nullptr)
+		*OutLength = Length;
+
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Searches for every offset a byte pattern matches at, inside the given memory range.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InPattern">The compiled byte pattern.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback, executed with the ordinal of every match and returning true to stop the scan.</param>
+NTSTATUS CkFindAllBytePatterns(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_BYTE_PATTERN* InPattern, PVOID InContext, ENUMERATE_PATTERNS_WITH_CONTEXT InCallback)
+{
+	NTSTATUS Status;
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSize == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InPattern == nullptr)
+		return STATUS_INVALID_PARAMETER_3;
+
+	if (InCallback == nullptr)
+		return STATUS_INVALID_PARAMETER_5;
+
+	// 
+	// Scan the memory region, resuming right after every match.
+	// 
+
+	BYTE_PATTERN_WORKSPACE Workspace;
+
+	if (NT_ERROR(Status = CkAllocateBytePatternWorkspace(InPattern, &Workspace)))
+		return Status;
+
+	ULONG NumberOfMatches = 0;
+	SIZE_T Offset = 0;
+
+	while (Offset < InSize)
+	{
+		SIZE_T Length = 0;
+		CONST SIZE_T Match = CkScanBytePattern((CONST UINT8*) InBaseAddress + Offset, InSize - Offset, InPattern, &Workspace, &Length);
+
+		if (Match == SIGNATURE_NOT_FOUND)
+			break;
+
+		if (InCallback(NumberOfMatches++, RtlAddOffsetToPointer(InBaseAddress, Offset + Match), InContext))
+			break;
+
+		Offset += Match + 1;
+	}
+
+	CkFreeBytePatternWorkspace(&Workspace);
+	return NumberOfMatches != 0 ? STATUS_SUCCESS : STATUS_NOT_FOUND;
+}
+
+/// <summary>
+/// Searches for the first match of a byte pattern inside the given module's executable sections.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InPattern">The compiled byte pattern.</param>
+/// <param name="OutResult">The address of the match.</param>
+NTSTATUS CkTryFindBytePatternInModuleExecutableSections(CONST PVOID InBaseAddress, CONST CK_BYTE_PATTERN* InPattern, OPTIONAL OUT PVOID* OutResult)
+{
+	NTSTATUS Status;
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InPattern == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	// 
+	// Setup the scan context, sharing a single workspace between the sections.
+	// 
+
+	struct SCAN_CONTEXT
+	{
+		PVOID BaseAddress;
+		CONST CK_BYTE_PATTERN* Pattern;
+		BYTE_PATTERN_WORKSPACE Workspace;
+		PVOID Result;
+	};
+
+	SCAN_CONTEXT ScanContext;
+	ScanContext.BaseAddress = InBaseAddress;
+	ScanContext.Pattern = InPattern;
+	ScanContext.Result = nullptr;
+
+	if (NT_ERROR(Status = CkAllocateBytePatternWorkspace(InPattern, &ScanContext.Workspace)))
+		return Status;
+
+	// 
+	// Enumerate the sections of the module.
+	// 
+
+	RtlEnumerateModuleSections<SCAN_CONTEXT*>(InBaseAddress, &ScanContext, [] (ULONG InIndex, IMAGE_SECTION_HEADER* InSectionHeader, SCAN_CONTEXT* InContext) -> bool
+	{
+		// 
+		// Skip the sections which are not mapped or do not contain code.
+		// 
+
+		auto* SectionData = CkGetExecutableSectionData(InContext->BaseAddress, InSectionHeader);
+
+		if (SectionData == nullptr)
+			return FALSE;
+
+		// 
+		// Scan this section.
+		// 
+
+		SIZE_T Length = 0;
+		CONST SIZE_T Offset = CkScanBytePattern((CONST UINT8*) SectionData, InSectionHeader->Misc.VirtualSize, InContext->Pattern, &InContext->Workspace, &Length);
+
+		if (Offset == SIGNATURE_NOT_FOUND)
+			return FALSE;
+
+		InContext->Result = RtlAddOffsetToPointer(SectionData, Offset);
+		return TRUE;
+	});
+
+	CkFreeBytePatternWorkspace(&ScanContext.Workspace);
+
+	// 
+	// Return the resulting address.
+	// 
+
+	if (OutResult != nullptr)
+		*OutResult = ScanContext.Result;
+
+	return ScanContext.Result != nullptr ? STATUS_SUCCESS : STATUS_NOT_FOUND;
+}
+
+// 
+// The minimum number of bytes scanned by each worker of a parallel scan.
+// 
+
+#define SIGNATURE_PARALLEL_CHUNK_SIZE 0x40000
+
+// 
+// The maximum number of workers of a parallel scan.
+// 
+
+#define SIGNATURE_PARALLEL_MAXIMUM_WORKERS 64
+
+/// <summary>
+/// A chunk of memory scanned by one of the workers of a parallel scan.
+/// </summary>
+struct SIGNATURE_PARALLEL_CHUNK
+{
+	CONST UINT8* Data;
+	SIZE_T Size;
+};
+
+/// <summary>
+/// The state shared by the workers of a parallel scan.
+/// </summary>
+struct SIGNATURE_PARALLEL_CONTEXT
+{
+	CONST CK_SIGNATURE* Signature;
+	SIGNATURE_PARALLEL_CHUNK* Chunks;
+	ULONG NumberOfChunks;
+	PEPROCESS Process;
+	volatile LONG NextChunk;
+	volatile LONG64 Result;
+	volatile LONG Status;
+};
+
+/// <summary>
+/// A pool of worker threads kept across parallel scans.
+/// </summary>
+struct CK_SCAN_POOL
+{
+	KEVENT Lock;
+	KSEMAPHORE Semaphore;
+	KEVENT Completed;
+	SIGNATURE_PARALLEL_CONTEXT* volatile Context;
+	volatile LONG NumberOfPendingWorkers;
+	BOOLEAN Stopping;
+	ULONG NumberOfWorkers;
+	HANDLE Workers[CK_SCAN_POOL_MAXIMUM_WORKERS];
+};
+
+/// <summary>
+/// Scans the chunks of a parallel scan until none is left, keeping the lowest match.
+/// </summary>
+/// <param name="InContext">The parallel scan context.</param>
+static VOID CkScanSignatureChunks(SIGNATURE_PARALLEL_CONTEXT* InContext)
+{
+	LONG Index;
+
+	while ((Index = InterlockedIncrement(&InContext->NextChunk) - 1) < (LONG) InContext->NumberOfChunks)
+	{
+		auto* Chunk = &InContext->Chunks[Index];
+
+		// 
+		// Chunks are handed out in ascending order, so nothing past an existing match can be lower.
+		// 
+
+		if ((ULONG64) InContext->Result <= (ULONG64) Chunk->Data)
+			continue;
+
+		// 
+		// The data may be user memory which can be unmapped at any time, which fails the whole scan.
+		// 
+
+		SIZE_T Offset = SIGNATURE_NOT_FOUND;
+
+		__try
+		{
+			Offset = CkScanSignature(Chunk->Data, Chunk->Size, InContext->Signature);
+		}
+		__except (EXCEPTION_EXECUTE_HANDLER)
+		{
+			InterlockedCompareExchange(&InContext->Status, GetExceptionCode(), STATUS_SUCCESS);
+			InterlockedExchange(&InContext->NextChunk, (LONG) InContext->NumberOfChunks);
+			return;
+		}
+
+		if (Offset == SIGNATURE_NOT_FOUND)
+			continue;
+
+		// 
+		// Keep the lowest match.
+		// 
+
+		CONST LONG64 Address = (LONG64) &Chunk->Data[Offset];
+		LONG64 Current = InContext->Result;
+
+		while ((ULONG64) Address < (ULONG64) Current)
+		{
+			CONST LONG64 Previous = InterlockedCompareExchange64(&InContext->Result, Address, Current);
+
+			if (Previous == Current)
+				break;
+
+			Current = Previous;
+		}
+	}
+}
+
+/// <summary>
+/// Scans the chunks of a parallel scan from a worker thread, attached to the process of the caller.
+/// </summary>
+/// <param name="InContext">The parallel scan context.</param>
+///	<remarks>The workers run in the system process, where neither the user address space nor the session space of the caller is mapped.</remarks>
+static VOID CkScanSignatureChunksAttached(SIGNATURE_PARALLEL_CONTEXT* InContext)
+{
+	if (InContext->Process == PsGetCurrentProcess())
+	{
+		CkScanSignatureChunks(InContext);
+		return;
+	}
+
+	KAPC_STATE ApcState;
+	KeStackAttachProcess(InContext->Process, &ApcState);
+	CkScanSignatureChunks(InContext);
+	KeUnstackDetachProcess(&ApcState);
+}
+
+/// <summary>
+/// The routine executed by the worker threads started for a single parallel scan.
+/// </summary>
+/// <param name="InContext">The parallel scan context.</param>
+static VOID CkScanSignatureChunksRoutine(PVOID InContext)
+{
+	CkScanSignatureChunksAttached((SIGNATURE_PARALLEL_CONTEXT*) InContext);
+	PsTerminateSystemThread(STATUS_SUCCESS);
+}
+
+/// <summary>
+/// The routine executed by the worker threads of a scan pool.
+/// </summary>
+/// <param name="InContext">The scan pool.</param>
+static VOID CkScanPoolWorkerRoutine(PVOID InContext)
+{
+	auto* Pool = (CK_SCAN_POOL*) InContext;
+
+	while (TRUE)
+	{
+		KeWaitForSingleObject(&Pool->Semaphore, Executive, KernelMode, FALSE, NULL);
+
+		if (Pool->Stopping)
+			break;
+
+		// 
+		// The scanning thread waits for every worker it woke up, so the context stays valid until then.
+		// 
+
+		CkScanSignatureChunksAttached(Pool->Context);
+
+		if (InterlockedDecrement(&Pool->NumberOfPendingWorkers) == 0)
+			KeSetEvent(&Pool->Completed, IO_NO_INCREMENT, FALSE);
+	}
+
+	PsTerminateSystemThread(STATUS_SUCCESS);
+}
+
+/// <summary>
+/// Creates a pool of worker threads reused by the parallel scans, saving the cost of starting threads on every scan.
+/// </summary>
+/// <param name="InNumberOfWorkers">The number of worker threads, up to CK_SCAN_POOL_MAXIMUM_WORKERS, or zero for one per processor but the current one.</param>
+/// <param name="OutPool">The scan pool.</param>
+///	<remarks>This function must be called at PASSIVE_LEVEL. The pool needs to be destroyed with CkDestroyScanPool.</remarks>
+NTSTATUS CkCreateScanPool(ULONG InNumberOfWorkers, OUT CK_SCAN_POOL** OutPool)
+{
+	PAGED_CODE();
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InNumberOfWorkers > CK_SCAN_POOL_MAXIMUM_WORKERS)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (OutPool == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InNumberOfWorkers == 0)
+		InNumberOfWorkers = min(KeQueryActiveProcessorCountEx(ALL_PROCESSOR_GROUPS) - 1, CK_SCAN_POOL_MAXIMUM_WORKERS);
+
+	if (InNumberOfWorkers == 0)
+		return STATUS_NOT_SUPPORTED;
+
+	// 
+	// Allocate and initialize the pool.
+	// 
+
+	auto* Pool = (CK_SCAN_POOL*) CkAllocatePool(NonPagedPoolNx, sizeof(CK_SCAN_POOL));
+
+	if (Pool == nullptr)
+		return STATUS_INSUFFICIENT_RESOURCES;
+
+	RtlZeroMemory(Pool, sizeof(CK_SCAN_POOL));
+	KeInitializeEvent(&Pool->Lock, SynchronizationEvent, TRUE);
+	KeInitializeSemaphore(&Pool->Semaphore, 0, MAXLONG);
+	KeInitializeEvent(&Pool->Completed, SynchronizationEvent, FALSE);
+
+	// 
+	// Start the worker threads.
+	// 
+
+	for (ULONG I = 0; I < InNumberOfWorkers; I++)
+	{
+		OBJECT_ATTRIBUTES ObjectAttributes;
+		InitializeObjectAttributes(&ObjectAttributes, NULL, OBJ_KERNEL_HANDLE, NULL, NULL);
+
+		if (NT_ERROR(PsCreateSystemThread(&Pool->Workers[Pool->NumberOfWorkers], SYNCHRONIZE, &ObjectAttributes, NULL, NULL, CkScanPoolWorkerRoutine, Pool)))
+			break;
+
+		Pool->NumberOfWorkers++;
+	}
+
+	if (Pool->NumberOfWorkers == 0)
+	{
+		CkFreePool(Pool);
+		return STATUS_INSUFFICIENT_RESOURCES;
+	}
+
+	*OutPool = Pool;
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Stops the worker threads of a scan pool and releases it.
+/// </summary>
+/// <param name="InPool">The scan pool.</param>
+///	<remarks>This function must be called at PASSIVE_LEVEL, once no parallel scan uses the pool anymore.</remarks>
+VOID CkDestroyScanPool(CK_SCAN_POOL* InPool)
+{
+	PAGED_CODE();
+
+	if (InPool == nullptr)
+		return;
+
+	// 
+	// Wake every worker, each of them exiting as it sees the pool stopping.
+	// 
+
+	InPool->Stopping = TRUE;
+	KeReleaseSemaphore(&InPool->Semaphore, IO_NO_INCREMENT, (LONG) InPool->NumberOfWorkers, FALSE);
+
+	for (ULONG I = 0; I < InPool->NumberOfWorkers; I++)
+	{
+		ZwWaitForSingleObject(InPool->Workers[I], FALSE, NULL);
+		ZwClose(InPool->Workers[I]);
+	}
+
+	CkFreePool(InPool);
+}
+
+/// <summary>
+/// Scans the given chunks on every processor and returns the lowest match.
+/// </summary>
+/// <param name="InPool">The optional scan pool, otherwise worker threads are started for this scan only.</param>
+/// <param name="InChunks">The chunks, in ascending order of address.</param>
+/// <param name="InNumberOfChunks">The number of chunks.</param>
+/// <param name="InSignature">The signature.</param>
+/// <param name="OutResult">The lowest match.</param>
+static NTSTATUS CkScanSignatureParallel(OPTIONAL CK_SCAN_POOL* InPool, SIGNATURE_PARALLEL_CHUNK* InChunks, ULONG InNumberOfChunks, CONST CK_SIGNATURE* InSignature, OUT PVOID* OutResult)
+{
+	SIGNATURE_PARALLEL_CONTEXT Context;
+	Context.Signature = InSignature;
+	Context.Chunks = InChunks;
+	Context.NumberOfChunks = InNumberOfChunks;
+	Context.Process = PsGetCurrentProcess();
+	Context.NextChunk = 0;
+	Context.Result = (LONG64) MAXULONG64;
+	Context.Status = STATUS_SUCCESS;
+
+	if (InPool != nullptr)
+	{
+		// 
+		// Hand the scan to the workers of the pool, one scan at a time, the current thread being one of the workers.
+		// 
+
+		KeWaitForSingleObject(&InPool->Lock, Executive, KernelMode, FALSE, NULL);
+
+		CONST ULONG NumberOfWorkers = min(InPool->NumberOfWorkers, InNumberOfChunks - 1);
+		InPool->Context = &Context;
+		InPool->NumberOfPendingWorkers = (LONG) NumberOfWorkers;
+
+		if (NumberOfWorkers != 0)
+			KeReleaseSemaphore(&InPool->Semaphore, IO_NO_INCREMENT, (LONG) NumberOfWorkers, FALSE);
+
+		CkScanSignatureChunks(&Context);
+
+		if (NumberOfWorkers != 0)
+			KeWaitForSingleObject(&InPool->Completed, Executive, KernelMode, FALSE, NULL);
+
+		InPool->Context = nullptr;
+		KeSetEvent(&InPool->Lock, IO_NO_INCREMENT, FALSE);
+	}
+	else
+	{
+		// 
+		// Start a worker on the other processors, the current thread being one of the workers.
+		// 
+
+		HANDLE Workers[SIGNATURE_PARALLEL_MAXIMUM_WORKERS];
+		ULONG NumberOfWorkers = 0;
+		ULONG MaximumNumberOfWorkers = min(KeQueryActiveProcessorCountEx(ALL_PROCESSOR_GROUPS), InNumberOfChunks);
+
+		if (MaximumNumberOfWorkers > SIGNATURE_PARALLEL_MAXIMUM_WORKERS)
+			MaximumNumberOfWorkers = SIGNATURE_PARALLEL_MAXIMUM_WORKERS;
+
+		for (ULONG I = 1; I < MaximumNumberOfWorkers; I++)
+		{
+			OBJECT_ATTRIBUTES ObjectAttributes;
+			InitializeObjectAttributes(&ObjectAttributes, NULL, OBJ_KERNEL_HANDLE, NULL, NULL);
+
+			if (NT_ERROR(PsCreateSystemThread(&Workers[NumberOfWorkers], SYNCHRONIZE, &ObjectAttributes, NULL, NULL, CkScanSignatureChunksRoutine, &Context)))
+				break;
+
+			NumberOfWorkers++;
+		}
+
+		CkScanSignatureChunks(&Context);
+
+		// 
+		// Wait for the other workers to exit, the context lives on our stack.
+		// 
+
+		for (ULONG I = 0; I < NumberOfWorkers; I++)
+		{
+			ZwWaitForSingleObject(Workers[I], FALSE, NULL);
+			ZwClose(Workers[I]);
+		}
+	}
+
+	if (NT_ERROR(Context.Status))
+		return Context.Status;
+
+	if (Context.Result == (LONG64) MAXULONG64)
+		return STATUS_NOT_FOUND;
+
+	*OutResult = (PVOID) Context.Result;
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Splits a region into chunks overlapping by the length of the signature minus one.
+/// </summary>
+/// <param name="InData">The data.</param>
+/// <param name="InSize">The size of the data in bytes.</param>
+/// <param name="InChunkSize">The size of a chunk in bytes.</param>
+/// <param name="InSignature">The signature.</param>
+/// <param name="OutChunks">The chunks, or null to only count them.</param>
+/// <param name="InOutNumberOfChunks">The number of chunks, incremented for each chunk.</param>
+static VOID CkSplitSignatureChunks(CONST UINT8* InData, SIZE_T InSize, SIZE_T InChunkSize, CONST CK_SIGNATURE* InSignature, OPTIONAL OUT SIGNATURE_PARALLEL_CHUNK* OutChunks, IN OUT ULONG* InOutNumberOfChunks)
+{
+	if (InSize < InSignature->Length)
+		return;
+
+	for (SIZE_T Offset = 0; Offset < InSize; Offset += InChunkSize)
+	{
+		if (OutChunks != nullptr)
+		{
+			auto* Chunk = &OutChunks[*InOutNumberOfChunks];
+			Chunk->Data = &InData[Offset];
+			Chunk->Size = min(InChunkSize + InSignature->Length - 1, InSize - Offset);
+		}
+
+		*InOutNumberOfChunks += 1;
+	}
+}
+
+/// <summary>
+/// Gets the size of the chunks of a parallel scan, so every processor gets a few of them.
+/// </summary>
+/// <param name="InTotalSize">The total number of bytes to scan.</param>
+static SIZE_T CkGetSignatureChunkSize(SIZE_T InTotalSize)
+{
+	CONST SIZE_T ChunkSize = InTotalSize / (KeQueryActiveProcessorCountEx(ALL_PROCESSOR_GROUPS) * 4);
+	return ChunkSize > SIGNATURE_PARALLEL_CHUNK_SIZE ? PAGE_ROUND_UP(ChunkSize) : SIGNATURE_PARALLEL_CHUNK_SIZE;
+}
+
+/// <summary>
+/// Searches for a certain pattern inside the given memory range, splitting the work across every processor.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSize">The size of the region in bytes.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="OutResult">The lowest match.</param>
+/// <param name="InPool">The optional scan pool, otherwise worker threads are started for this scan only.</param>
+///	<remarks>The region may lie in the address space of the current process, the workers attach to it. This function must be called at PASSIVE_LEVEL.</remarks>
+NTSTATUS CkTryFindPatternParallel(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CK_SIGNATURE* InSignature, OPTIONAL OUT PVOID* OutResult, OPTIONAL CK_SCAN_POOL* InPool)
+{
+	PAGED_CODE();
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSize == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InSignature == nullptr || InSignature->Length == 0)
+		return STATUS_INVALID_PARAMETER_3;
+
+	if (InSize < InSignature->Length)
+		return STATUS_ARRAY_BOUNDS_EXCEEDED;
+
+	// 
+	// Small regions are not worth the cost of starting the workers.
+	// 
+
+	CONST SIZE_T ChunkSize = CkGetSignatureChunkSize(InSize);
+	ULONG NumberOfChunks = 0;
+	CkSplitSignatureChunks((CONST UINT8*) InBaseAddress, InSize, ChunkSize, InSignature, nullptr, &NumberOfChunks);
+
+	if (NumberOfChunks <= 1)
+		return CkTryFindPattern(InBaseAddress, InSize, InSignature, OutResult);
+
+	// 
+	// Split the region and scan the chunks.
+	// 
+
+	auto* Chunks = (SIGNATURE_PARALLEL_CHUNK*) CkAllocatePool(NonPagedPoolNx, NumberOfChunks * sizeof(SIGNATURE_PARALLEL_CHUNK));
+
+	if (Chunks == nullptr)
+		return STATUS_INSUFFICIENT_RESOURCES;
+
+	NumberOfChunks = 0;
+	CkSplitSignatureChunks((CONST UINT8*) InBaseAddress, InSize, ChunkSize, InSignature, Chunks, &NumberOfChunks);
+
+	PVOID Result = nullptr;
+	CONST NTSTATUS Status = CkScanSignatureParallel(InPool, Chunks, NumberOfChunks, InSignature, &Result);
+	CkFreePool(Chunks);
+
+	if (NT_SUCCESS(Status) && OutResult != nullptr)
+		*OutResult = Result;
+
+	return Status;
+}
+
+/// <summary>
+/// Searches for a certain pattern inside the given module's executable sections, splitting the work across every processor.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="OutResult">The lowest match.</param>
+/// <param name="InPool">The optional scan pool, otherwise worker threads are started for this scan only.</param>
+///	<remarks>The module may be mapped in the address space of the current process, the workers attach to it. This function must be called at PASSIVE_LEVEL.</remarks>
+NTSTATUS CkTryFindPatternInModuleExecutableSectionsParallel(CONST PVOID InBaseAddress, CONST CK_SIGNATURE* InSignature, OPTIONAL OUT PVOID* OutResult, OPTIONAL CK_SCAN_POOL* InPool)
+{
+	PAGED_CODE();
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSignature == nullptr || InSignature->Length == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	// 
+	// Setup the split context.
+	// 
+
+	struct SPLIT_CONTEXT
+	{
+		PVOID BaseAddress;
+		CONST CK_SIGNATURE* Signature;
+		SIZE_T TotalSize;
+		SIZE_T ChunkSize;
+		SIGNATURE_PARALLEL_CHUNK* Chunks;
+		ULONG NumberOfChunks;
+	};
+
+	SPLIT_CONTEXT SplitContext = { };
+	SplitContext.BaseAddress = InBaseAddress;
+	SplitContext.Signature = InSignature;
+
+	// 
+	// Measure the executable sections, so the chunk size can be based on the total size.
+	// 
+
+	RtlEnumerateModuleSections<SPLIT_CONTEXT*>(InBaseAddress, &SplitContext, [] (ULONG InIndex, IMAGE_SECTION_HEADER* InSectionHeader, SPLIT_CONTEXT* InContext) -> bool
+	{
+		if (CkGetExecutableSectionData(InContext->BaseAddress, InSectionHeader) != nullptr)
+			InContext->TotalSize += InSectionHeader->Misc.VirtualSize;
+
+		return FALSE;
+	});
+
+	if (SplitContext.TotalSize == 0)
+		return STATUS_NOT_FOUND;
+
+	// 
+	// Count the chunks, then split the sections into them, in ascending order of address.
+	// 
+
+	SplitContext.ChunkSize = CkGetSignatureChunkSize(SplitContext.TotalSize);
+
+	for (ULONG Pass = 0; Pass < 2; Pass++)
+	{
+		SplitContext.NumberOfChunks = 0;
+
+		RtlEnumerateModuleSections<SPLIT_CONTEXT*>(InBaseAddress, &SplitContext, [] (ULONG InIndex, IMAGE_SECTION_HEADER* InSectionHeader, SPLIT_CONTEXT* InContext) -> bool
+		{
+			auto* SectionData = CkGetExecutableSectionData(InContext->BaseAddress, InSectionHeader);
+
+			if (SectionData != nullptr)
+				CkSplitSignatureChunks((CONST UINT8*) SectionData, InSectionHeader->Misc.VirtualSize, InContext->ChunkSize, InContext->Signature, InContext->Chunks, &InContext->NumberOfChunks);
+
+			return FALSE;
+		});
+
+		if (SplitContext.NumberOfChunks == 0)
+			return STATUS_NOT_FOUND;
+
+		if (Pass == 0)
+		{
+			SplitContext.Chunks = (SIGNATURE_PARALLEL_CHUNK*) CkAllocatePool(NonPagedPoolNx, SplitContext.NumberOfChunks * sizeof(SIGNATURE_PARALLEL_CHUNK));
+
+			if (SplitContext.Chunks == nullptr)
+				return STATUS_INSUFFICIENT_RESOURCES;
+		}
+	}
+
+	// 
+	// Scan the chunks.
+	// 
+
+	PVOID Result = nullptr;
+	CONST NTSTATUS Status = CkScanSignatureParallel(InPool, SplitContext.Chunks, SplitContext.NumberOfChunks, InSignature, &Result);
+	CkFreePool(SplitContext.Chunks);
+
+	if (NT_SUCCESS(Status) && OutResult != nullptr)
+		*OutResult = Result;
+
+	return Status;
+}
+
+// 
+// The number of bytes copied out of a process per chunk, not counting the overlap.
+// 
+
+#define SIGNATURE_PROCESS_CHUNK_SIZE 0x40000
+
+/// <summary>
+/// Checks whether the given memory region is committed and readable without faulting.
+/// </summary>
+/// <param name="InMemoryInformation">The memory region.</param>
+static BOOLEAN CkIsReadableMemoryRegion(CONST MEMORY_BASIC_INFORMATION* InMemoryInformation)
+{
+	if (InMemoryInformation->State != MEM_COMMIT)
+		return FALSE;
+
+	if (InMemoryInformation->Protect & (PAGE_GUARD | PAGE_NOACCESS))
+		return FALSE;
+
+	return (InMemoryInformation->Protect & (PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY)) != 0;
+}
+
+/// <summary>
+/// Searches for every match of a certain pattern inside the committed and readable memory of the given process.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback, executed with the ordinal and the address in the process of every match and returning true to stop the scan.</param>
+///	<remarks>This function must be called at PASSIVE_LEVEL.</remarks>
+NTSTATUS CkFindAllPatternsInProcess(CONST PEPROCESS InProcess, CONST CK_SIGNATURE* InSignature, PVOID InContext, ENUMERATE_PATTERNS_WITH_CONTEXT InCallback)
+{
+	PAGED_CODE();
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InProcess == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InSignature == nullptr || InSignature->Length == 0)
+		return STATUS_INVALID_PARAMETER_2;
+
+	if (InCallback == nullptr)
+		return STATUS_INVALID_PARAMETER_4;
+
+	// 
+	// Allocate the bounce buffer, large enough for a chunk and the overlap with the next one.
+	// 
+
+	auto* Buffer = (UINT8*) CkAllocatePool(NonPagedPoolNx, SIGNATURE_PROCESS_CHUNK_SIZE + InSignature->Length - 1);
+
+	if (Buffer == nullptr)
+		return STATUS_INSUFFICIENT_RESOURCES;
+
+	// 
+	// Setup the scan context.
+	// 
+
+	struct SCAN_CONTEXT
+	{
+		PEPROCESS Process;
+		CONST CK_SIGNATURE* Signature;
+		UINT8* Buffer;
+		PVOID ChunkAddress;
+		PVOID Context;
+		ENUMERATE_PATTERNS_WITH_CONTEXT Callback;
+		ULONG NumberOfMatches;
+		BOOLEAN Stopped;
+	};
+
+	SCAN_CONTEXT ScanContext;
+	ScanContext.Process = InProcess;
+	ScanContext.Signature = InSignature;
+	ScanContext.Buffer = Buffer;
+	ScanContext.ChunkAddress = nullptr;
+	ScanContext.Context = InContext;
+	ScanContext.Callback = InCallback;
+	ScanContext.NumberOfMatches = 0;
+	ScanContext.Stopped = FALSE;
+
+	// 
+	// Enumerate the memory regions of the process.
+	// 
+
+	CkEnumerateVirtualMemory<SCAN_CONTEXT*>(InProcess, &ScanContext, [] (ULONG InIndex, MEMORY_BASIC_INFORMATION* InMemoryInformation, SCAN_CONTEXT* InContext) -> bool
+	{
+		if (!CkIsReadableMemoryRegion(InMemoryInformation) || InMemoryInformation->RegionSize < InContext->Signature->Length)
+			return FALSE;
+
+		// 
+		// Stream the region through the bounce buffer, re-reading the last bytes of each chunk
+		// so the matches crossing a chunk boundary are found exactly once.
+		// 
+
+		for (SIZE_T Offset = 0; Offset < InMemoryInformation->RegionSize && !InContext->Stopped; Offset += SIGNATURE_PROCESS_CHUNK_SIZE)
+		{
+			CONST SIZE_T ChunkSize = min(SIGNATURE_PROCESS_CHUNK_SIZE + InContext->Signature->Length - 1, InMemoryInformation->RegionSize - Offset);
+
+			if (ChunkSize < InContext->Signature->Length)
+				break;
+
+			InContext->ChunkAddress = RtlAddOffsetToPointer(InMemoryInformation->BaseAddress, Offset);
+
+			// 
+			// Copy the chunk, scanning whatever was copied if the region changed under us.
+			// 
+
+			SIZE_T NumberOfBytesCopied = 0;
+			CkCopyVirtualMemory(InContext->Process, InContext->ChunkAddress, PsGetCurrentProcess(), InContext->Buffer, ChunkSize, &NumberOfBytesCopied);
+
+			if (NumberOfBytesCopied < InContext->Signature->Length)
+				continue;
+
+			CkScanSignatureMatches(InContext->Buffer, NumberOfBytesCopied, InContext->Signature, InContext, [] (SIZE_T InOffset, PVOID InContext) -> bool
+			{
+				auto* ScanContext = (SCAN_CONTEXT*) InContext;
+				return ScanContext->Stopped = ScanContext->Callback(ScanContext->NumberOfMatches++, RtlAddOffsetToPointer(ScanContext->ChunkAddress, InOffset), ScanContext->Context);
+			});
+		}
+
+		return InContext->Stopped;
+	});
+
+	CkFreePool(Buffer);
+	return ScanContext.NumberOfMatches != 0 ? STATUS_SUCCESS : STATUS_NOT_FOUND;
+}
+
+/// <summary>
+/// Searches for a certain pattern inside the committed and readable memory of the given process.
+/// </summary>
+/// <param name="InProcess">The process.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="OutResult">The address of the lowest match in the process.</param>
+///	<remarks>This function must be called at PASSIVE_LEVEL.</remarks>
+NTSTATUS CkTryFindPatternInProcess(CONST PEPROCESS InProcess, CONST CK_SIGNATURE* InSignature, OPTIONAL OUT PVOID* OutResult)
+{
+	PVOID Result = nullptr;
+
+	// 
+	// The regions are enumerated in ascending order, so the first match is the lowest.
+	// 
+
+	CONST NTSTATUS Status = CkFindAllPatternsInProcess(InProcess, InSignature, &Result, [] (ULONG InIndex, PVOID InAddress, VOID* InContext) -> bool
+	{
+		*(PVOID*) InContext = InAddress;
+		return TRUE;
+	});
+
+	if (NT_SUCCESS(Status) && OutResult != nullptr)
+		*OutResult = Result;
+
+	return Status;
+}
+
+// 
+// The number of bytes of physical memory mapped at once, not counting the overlap.
+// 
+
+#define SIGNATURE_PHYSICAL_WINDOW_SIZE 0x400000
+
+/// <summary>
+/// Searches for every match of a certain pattern inside the physical memory.
+/// </summary>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="InContext">The context.</param>
+/// <param name="InCallback">The callback, executed with the ordinal, the physical address and the mapped address of every match and returning true to stop the scan.</param>
+/// <param name="InProgressCallback">The optional callback, executed after each window with the number of bytes swept so far, the window address and the pages which could not be read, and returning true to stop the scan.</param>
+///	<remarks>This function must be called at PASSIVE_LEVEL.</remarks>
+NTSTATUS CkFindAllPatternsInPhysicalMemory(CONST CK_SIGNATURE* InSignature, PVOID InContext, ENUMERATE_PHYSICAL_PATTERNS_WITH_CONTEXT InCallback, OPTIONAL PHYSICAL_SCAN_PROGRESS InProgressCallback)
+{
+	PAGED_CODE();
+
+	// 
+	// Verify the passed parameters.
+	// 
+
+	if (InSignature == nullptr || InSignature->Length == 0)
+		return STATUS_INVALID_PARAMETER_1;
+
+	if (InCallback == nullptr)
+		return STATUS_INVALID_PARAMETER_3;
+
+	// 
+	// Query the ranges of physical memory backed by RAM.
+	// 
+
+	auto* Ranges = MmGetPhysicalMemoryRanges();
+
+	if (Ranges == nullptr)
+		return STATUS_UNSUCCESSFUL;
+
+	ULONG64 TotalNumberOfBytes = 0;
+
+	for (auto* Range = Ranges; Range->NumberOfBytes.QuadPart != 0; Range++)
+		TotalNumberOfBytes += Range->NumberOfBytes.QuadPart;
+
+	// 
+	// Setup the scan context.
+	// 
+
+	struct SCAN_CONTEXT
+	{
+		PHYSICAL_ADDRESS WindowAddress;
+		PVOID WindowData;
+		PVOID Context;
+		ENUMERATE_PHYSICAL_PATTERNS_WITH_CONTEXT Callback;
+		ULONG NumberOfMatches;
+		BOOLEAN Stopped;
+	};
+
+	SCAN_CONTEXT ScanContext;
+	ScanContext.WindowAddress.QuadPart = 0;
+	ScanContext.WindowData = nullptr;
+	ScanContext.Context = InContext;
+	ScanContext.Callback = InCallback;
+	ScanContext.NumberOfMatches = 0;
+	ScanContext.Stopped = FALSE;
+
+	auto OnMatch = [] (SIZE_T InOffset, PVOID InContext) -> bool
+	{
+		auto* ScanContext = (SCAN_CONTEXT*) InContext;
+
+		PHYSICAL_ADDRESS PhysicalAddress;
+		PhysicalAddress.QuadPart = ScanContext->WindowAddress.QuadPart + InOffset;
+
+		return ScanContext->Stopped = ScanContext->Callback(ScanContext->NumberOfMatches++, PhysicalAddress, RtlAddOffsetToPointer(ScanContext->WindowData, InOffset), ScanContext->Context);
+	};
+
+	// 
+	// The windows which cannot be mapped are copied page by page into a bounce buffer, allocated on first use,
+	// and the pages which cannot be copied either are reported to the progress callback.
+	// 
+
+	CONST SIZE_T BounceBufferSize = PAGE_ROUND_UP((SIZE_T) SIGNATURE_PHYSICAL_WINDOW_SIZE + InSignature->Length - 1);
+	UINT8* BounceBuffer = nullptr;
+
+	ULONG SkippedPagesBuffer[SIGNATURE_PHYSICAL_WINDOW_SIZE / PAGE_SIZE / 32];
+	RTL_BITMAP SkippedPages;
+
+	NTSTATUS Status = STATUS_SUCCESS;
+	ULONG64 NumberOfBytesScanned = 0;
+
+	for (auto* Range = Ranges; Range->NumberOfBytes.QuadPart != 0 && !ScanContext.Stopped; Range++)
+	{
+		CONST ULONG64 RangeSize = (ULONG64) Range->NumberOfBytes.QuadPart;
+
+		for (ULONG64 Offset = 0; Offset < RangeSize && !ScanContext.Stopped; Offset += SIGNATURE_PHYSICAL_WINDOW_SIZE)
+		{
+			// 
+			// Map the window with the overlap of the next one, the same way the memory manager maps RAM.
+			// 
+
+			CONST SIZE_T WindowSize = (SIZE_T) min((ULONG64) SIGNATURE_PHYSICAL_WINDOW_SIZE + InSignature->Length - 1, RangeSize - Offset);
+			CONST ULONG NumberOfWindowPages = (ULONG) BYTES_TO_PAGES(min((ULONG64) SIGNATURE_PHYSICAL_WINDOW_SIZE, RangeSize - Offset));
+
+			PHYSICAL_ADDRESS WindowAddress;
+			WindowAddress.QuadPart = Range->BaseAddress.QuadPart + Offset;
+			BOOLEAN HasSkippedPages = FALSE;
+
+			if (WindowSize >= InSignature->Length)
+			{
+				ScanContext.WindowAddress = WindowAddress;
+				ScanContext.WindowData = MmMapIoSpace(WindowAddress, PAGE_ROUND_UP(WindowSize), MmCached);
+
+				if (ScanContext.WindowData != nullptr)
+				{
+					CkScanSignatureMatches((CONST UINT8*) ScanContext.WindowData, WindowSize, InSignature, &ScanContext, OnMatch);
+					MmUnmapIoSpace(ScanContext.WindowData, PAGE_ROUND_UP(WindowSize));
+				}
+				else
+				{
+					// 
+					// Since Windows 10 1803, the page tables and a few other pages cannot be mapped anymore,
+					// so copy the window page by page and scan the runs of pages which could be read.
+					// 
+
+					if (BounceBuffer == nullptr && (BounceBuffer = (UINT8*) CkAllocatePool(NonPagedPoolNx, BounceBufferSize)) == nullptr)
+					{
+						Status = STATUS_INSUFFICIENT_RESOURCES;
+						ScanContext.Stopped = TRUE;
+						break;
+					}
+
+					RtlInitializeBitMap(&SkippedPages, SkippedPagesBuffer, NumberOfWindowPages);
+					RtlClearAllBits(&SkippedPages);
+
+					CONST ULONG NumberOfPages = (ULONG) BYTES_TO_PAGES(WindowSize);
+					ULONG RunStart = 0;
+
+					for (ULONG PageIndex = 0; PageIndex <= NumberOfPages && !ScanContext.Stopped; PageIndex++)
+					{
+						if (PageIndex < NumberOfPages)
+						{
+							MM_COPY_ADDRESS SourceAddress;
+							SourceAddress.PhysicalAddress.QuadPart = WindowAddress.QuadPart + (LONGLONG) PageIndex * PAGE_SIZE;
+							SIZE_T NumberOfBytesCopied = 0;
+
+							if (NT_SUCCESS(MmCopyMemory(&BounceBuffer[(SIZE_T) PageIndex * PAGE_SIZE], SourceAddress, PAGE_SIZE, MM_COPY_MEMORY_PHYSICAL, &NumberOfBytesCopied)) && NumberOfBytesCopied == PAGE_SIZE)
+								continue;
+
+							// 
+							// The pages of the overlap are reported with the next window.
+							// 
+
+							if (PageIndex < NumberOfWindowPages)
+							{
+								RtlSetBit(&SkippedPages, PageIndex);
+								HasSkippedPages = TRUE;
+							}
+						}
+
+						// 
+						// Scan the run of readable pages which ends here.
+						// 
+
+						CONST SIZE_T RunOffset = (SIZE_T) RunStart * PAGE_SIZE;
+						CONST SIZE_T RunEnd = min((SIZE_T) PageIndex * PAGE_SIZE, WindowSize);
+
+						if (RunEnd >= RunOffset + InSignature->Length)
+						{
+							ScanContext.WindowAddress.QuadPart = WindowAddress.QuadPart + RunOffset;
+							ScanContext.WindowData = &BounceBuffer[RunOffset];
+							CkScanSignatureMatches(&BounceBuffer[RunOffset], RunEnd - RunOffset, InSignature, &ScanContext, OnMatch);
+						}
+
+						RunStart = PageIndex + 1;
+					}
+				}
+			}
+
+			// 
+			// Report the progress, giving the caller a chance to yield or to cancel the sweep.
+			// 
+
+			NumberOfBytesScanned += min((ULONG64) SIGNATURE_PHYSICAL_WINDOW_SIZE, RangeSize - Offset);
+
+			if (!ScanContext.Stopped && InProgressCallback != nullptr && InProgressCallback(NumberOfBytesScanned, TotalNumberOfBytes, WindowAddress, HasSkippedPages ? &SkippedPages : nullptr, InContext))
+				ScanContext.Stopped = TRUE;
+		}
+	}
+
+	if (BounceBuffer != nullptr)
+		CkFreePool(BounceBuffer);
+
+	ExFreePool(Ranges);
+
+	if (NT_ERROR(Status))
+		return Status;
+
+	return ScanContext.NumberOfMatches != 0 ? STATUS_SUCCESS : STATUS_NOT_FOUND;
+}
+
+// 
+// The identifier and the version of the signature cache files.
+// 
+
+#define SIGNATURE_CACHE_MAGIC 'ScKC'
+#define SIGNATURE_CACHE_VERSION 1
+
+// 
+// The relative virtual address recorded for the signatures which were not found.
+// 
+
+#define SIGNATURE_CACHE_NOT_FOUND ((ULONG) -1)
+
 /// <summary>
-/// Searches for a certain pattern inside the given memory range.
+/// The result of a signature scan inside a specific build of a module.
 /// </summary>
-/// <param name="InBaseAddress">The base address.</param>
-/// <param name="InSize">The size of the region in bytes.</param>
-/// <param name="InSignature">The signature.</param>
-/// <param name="OutResult">The result.</param>
-NTSTATUS CkTryFindPattern(CONST PVOID InBaseAddress, SIZE_T InSize, CONST CHAR* InSignature, OPTIONAL OUT PVOID* OutResult)
+struct SIGNATURE_CACHE_ENTRY
 {
-	// 
-	// Verify the passed parameters.
-	// 
+	ULONG TimeDateStamp;
+	ULONG SizeOfImage;
+	ULONG CheckSum;
+	ULONG RelativeAddress;
+	UINT64 SignatureHash;
+};
 
-	if (InBaseAddress == nullptr)
-		return STATUS_INVALID_PARAMETER_1;
+/// <summary>
+/// The header of the signature cache files, followed by the entries.
+/// </summary>
+struct SIGNATURE_CACHE_HEADER
+{
+	ULONG Magic;
+	ULONG Version;
+	ULONG NumberOfEntries;
+	ULONG Reserved;
+};
 
-	if (InSize == 0)
-		return STATUS_INVALID_PARAMETER_2;
+/// <summary>
+/// A cache of signature scan results, keyed by module build.
+/// </summary>
+struct CK_SIGNATURE_CACHE
+{
+	SIGNATURE_CACHE_ENTRY* Entries;
+	ULONG NumberOfEntries;
+	ULONG MaximumNumberOfEntries;
+};
 
-	if (InSignature == nullptr)
-		return STATUS_INVALID_PARAMETER_3;
+/// <summary>
+/// Gets the identity of the module at the given address.
+/// </summary>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="OutEntry">The entry receiving the identity of the module.</param>
+static NTSTATUS CkGetSignatureCacheModuleIdentity(CONST PVOID InBaseAddress, OUT SIGNATURE_CACHE_ENTRY* OutEntry)
+{
+	auto* NtHeaders = RtlModuleNtHeaders(InBaseAddress);
 
-	// 
-	// Setup the scan structures.
-	// 
+	if (NtHeaders == nullptr)
+		return STATUS_INVALID_IMAGE_FORMAT;
+
+	OutEntry->TimeDateStamp = NtHeaders->FileHeader.TimeDateStamp;
+	OutEntry->SizeOfImage = NtHeaders->OptionalHeader.SizeOfImage;
+	OutEntry->CheckSum = NtHeaders->OptionalHeader.CheckSum;
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Calculates the hash identifying a compiled signature in the cache.
+/// </summary>
+/// <param name="InSignature">The compiled signature.</param>
+static UINT64 CkGetSignatureCacheHash(CONST CK_SIGNATURE* InSignature)
+{
+	UINT64 Hash = CkCalculateFnv1a((PVOID) InSignature->Values, InSignature->Length);
+	return CkCalculateFnv1a((PVOID) InSignature->Masks, InSignature->Length, Hash);
+}
 
-	struct SIGNATURE_ENTRY
+/// <summary>
+/// Finds the entry of the given module build and signature.
+/// </summary>
+/// <param name="InCache">The signature cache.</param>
+/// <param name="InKey">The module identity and the signature hash.</param>
+static SIGNATURE_CACHE_ENTRY* CkFindSignatureCacheEntry(CONST CK_SIGNATURE_CACHE* InCache, CONST SIGNATURE_CACHE_ENTRY* InKey)
+{
+	for (ULONG I = 0; I < InCache->NumberOfEntries; I++)
 	{
-		UINT8 Value;
-		BOOLEAN IsWildcard;
-	};
+		auto* Entry = &InCache->Entries[I];
 
-	SIGNATURE_ENTRY SignatureBytes[128];
-	RtlZeroMemory(&SignatureBytes[0], sizeof(SignatureBytes));
+		if (Entry->SignatureHash == InKey->SignatureHash
+		 && Entry->TimeDateStamp == InKey->TimeDateStamp
+		 && Entry->SizeOfImage == InKey->SizeOfImage
+		 && Entry->CheckSum == InKey->CheckSum)
+			return Entry;
+	}
 
-	// 
-	// Parse the signature according to the IDA format.
-	// 
+	return nullptr;
+}
 
-	SIZE_T SignatureLength = 0;
-	SIZE_T SignatureStep = 0;
-	
-	while (InSignature[SignatureStep])
-	{
-		switch (InSignature[SignatureStep])
-		{
-			case ' ':
-			case '-':
-			{
-				SignatureStep += sizeof(char) * 1;
-				break;
-			}
+/// <summary>
+/// Records the result of a scan, growing the cache if needed.
+/// </summary>
+/// <param name="InCache">The signature cache.</param>
+/// <param name="InEntry">The entry.</param>
+static NTSTATUS CkInsertSignatureCacheEntry(CK_SIGNATURE_CACHE* InCache, CONST SIGNATURE_CACHE_ENTRY* InEntry)
+{
+	auto* Entry = CkFindSignatureCacheEntry(InCache, InEntry);
 
-			case '?':
-			{
-				auto* Entry = &SignatureBytes[SignatureLength++];
-				Entry->Value = 0x00;
-				Entry->IsWildcard = TRUE;
+	if (Entry != nullptr)
+	{
+		*Entry = *InEntry;
+		return STATUS_SUCCESS;
+	}
 
-				if (InSignature[SignatureStep + 1] == '?')
-					SignatureStep += 2;
-				else
-					SignatureStep += 1;
+	if (InCache->NumberOfEntries == InCache->MaximumNumberOfEntries)
+	{
+		CONST ULONG MaximumNumberOfEntries = InCache->MaximumNumberOfEntries != 0 ? InCache->MaximumNumberOfEntries * 2 : 16;
+		auto* Entries = (SIGNATURE_CACHE_ENTRY*) CkAllocatePool(NonPagedPoolNx, MaximumNumberOfEntries * sizeof(SIGNATURE_CACHE_ENTRY));
 
-				break;
-			}
-			
-			default:
-			{
-				auto* Entry = &SignatureBytes[SignatureLength++];
-				Entry->Value = CkHexadecimalStringToByte(&InSignature[SignatureStep]);
-				Entry->IsWildcard = FALSE;
+		if (Entries == nullptr)
+			return STATUS_INSUFFICIENT_RESOURCES;
 
-				SignatureStep += 2;
-				break;
-			}
+		if (InCache->Entries != nullptr)
+		{
+			RtlCopyMemory(Entries, InCache->Entries, InCache->NumberOfEntries * sizeof(SIGNATURE_CACHE_ENTRY));
+			CkFreePool(InCache->Entries);
 		}
+
+		InCache->Entries = Entries;
+		InCache->MaximumNumberOfEntries = MaximumNumberOfEntries;
 	}
 
+	InCache->Entries[InCache->NumberOfEntries++] = *InEntry;
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Creates an empty signature cache.
+/// </summary>
+/// <param name="OutCache">The signature cache.</param>
+///	<remarks>The signature cache needs to be released with CkFreeSignatureCache.</remarks>
+NTSTATUS CkCreateSignatureCache(OUT CK_SIGNATURE_CACHE** OutCache)
+{
 	// 
-	// The signature cannot be bigger than the region of memory we are about to scan.
+	// Verify the passed parameters.
 	// 
-	
-	if (InSize < SignatureLength)
-		return STATUS_ARRAY_BOUNDS_EXCEEDED;
+
+	if (OutCache == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
 
 	// 
-	// Loop through the memory region.
+	// Allocate the cache, the entries are allocated on the first insertion.
 	// 
 
-	for (SIZE_T X = 0; X < InSize - SignatureLength; X++)
-	{
-		// 
-		// Search for the pattern.
-		// 
+	auto* Cache = (CK_SIGNATURE_CACHE*) CkAllocatePool(NonPagedPoolNx, sizeof(CK_SIGNATURE_CACHE));
 
-		for (SIZE_T Y = 0; Y < SignatureLength; Y++)
-		{
-			auto* const Entry = &SignatureBytes[Y];
+	if (Cache == nullptr)
+		return STATUS_INSUFFICIENT_RESOURCES;
 
-			// 
-			// Check if the bytes matches.
-			//
-			
-			if (Entry->IsWildcard == FALSE)
-			{
-				auto const Value = *(UINT8*) RtlAddOffsetToPointer(InBaseAddress, X + Y);
+	RtlZeroMemory(Cache, sizeof(CK_SIGNATURE_CACHE));
 
-				if (Value != Entry->Value)
-					break;
-			}
+	*OutCache = Cache;
+	return STATUS_SUCCESS;
+}
 
-			// 
-			// If this was the last byte for the scan...
-			// 
-			
-			if (Y == SignatureLength - 1)
-			{
-				if (OutResult != nullptr)
-					*OutResult = RtlAddOffsetToPointer(InBaseAddress, X);
+/// <summary>
+/// Releases a signature cache previously created with CkCreateSignatureCache or CkLoadSignatureCache.
+/// </summary>
+/// <param name="InCache">The signature cache.</param>
+VOID CkFreeSignatureCache(CK_SIGNATURE_CACHE* InCache)
+{
+	if (InCache == nullptr)
+		return;
 
-				return STATUS_SUCCESS;
-			}
-		}
-	}
+	if (InCache->Entries != nullptr)
+		CkFreePool(InCache->Entries);
 
-	return STATUS_NOT_FOUND;
+	CkFreePool(InCache);
 }
 
 /// <summary>
-/// Searches for a successive pattern of a specific padding byte in the given memory range.
+/// Loads a signature cache previously saved with CkSaveSignatureCache.
 /// </summary>
-/// <param name="InBaseAddress">The base address.</param>
-/// <param name="InSize">The size of the region in bytes.</param>
-/// <param name="InPaddingByte">The padding byte.</param>
-/// <param name="InPaddingLength">The padding length.</param>
-/// <param name="OutResult">The result.</param>
-NTSTATUS CkTryFindPadding(CONST PVOID InBaseAddress, SIZE_T InSize, UINT8 InPaddingByte, SIZE_T InPaddingLength, OPTIONAL OUT PVOID* OutResult)
+/// <param name="InFilePath">The path of the file.</param>
+/// <param name="OutCache">The signature cache.</param>
+///	<remarks>The signature cache needs to be released with CkFreeSignatureCache.</remarks>
+NTSTATUS CkLoadSignatureCache(CONST WCHAR* InFilePath, OUT CK_SIGNATURE_CACHE** OutCache)
 {
+	NTSTATUS Status;
+
 	// 
 	// Verify the passed parameters.
 	// 
 
-	if (InBaseAddress == nullptr)
+	if (InFilePath == nullptr)
 		return STATUS_INVALID_PARAMETER_1;
 
-	if (InSize == 0)
+	if (OutCache == nullptr)
 		return STATUS_INVALID_PARAMETER_2;
 
-	if (InPaddingLength == 0)
-		return STATUS_INVALID_PARAMETER_4;
-
 	// 
-	// The padding cannot be bigger than the region of memory we are about to scan.
+	// Read the file and verify its header.
 	// 
 
-	if (InSize < InPaddingLength)
-		return STATUS_ARRAY_BOUNDS_EXCEEDED;
+	PVOID FileBuffer = nullptr;
+	SIZE_T FileSize = 0;
 
-	// 
-	// Loop through the memory region.
-	// 
-	
-	for (SIZE_T X = 0; X < InSize - InPaddingLength; X++)
+	if (NT_ERROR(Status = CkGetFileBuffer(InFilePath, &FileBuffer, &FileSize)))
+		return Status;
+
+	auto* Header = (SIGNATURE_CACHE_HEADER*) FileBuffer;
+
+	if (FileSize < sizeof(SIGNATURE_CACHE_HEADER)
+	 || Header->Magic != SIGNATURE_CACHE_MAGIC
+	 || Header->Version != SIGNATURE_CACHE_VERSION
+	 || (FileSize - sizeof(SIGNATURE_CACHE_HEADER)) / sizeof(SIGNATURE_CACHE_ENTRY) != Header->NumberOfEntries
+	 || (FileSize - sizeof(SIGNATURE_CACHE_HEADER)) % sizeof(SIGNATURE_CACHE_ENTRY) != 0)
 	{
-		// 
-		// Search for the padding.
-		// 
+		CkFreePool(FileBuffer);
+		return STATUS_FILE_CORRUPT_ERROR;
+	}
 
-		for (SIZE_T Y = 0; Y < InPaddingLength; Y++)
-		{
-			// 
-			// Check if the bytes matches.
-			// 
+	// 
+	// Insert the entries into a new cache.
+	// 
 
-			const auto CurrentByte = *(UINT8*) RtlAddOffsetToPointer(InBaseAddress, X + Y);
+	CK_SIGNATURE_CACHE* Cache = nullptr;
 
-			if (CurrentByte != InPaddingByte)
-				break;
+	if (NT_ERROR(Status = CkCreateSignatureCache(&Cache)))
+	{
+		CkFreePool(FileBuffer);
+		return Status;
+	}
 
-			// 
-			// If this was the last byte for the scan...
-			// 
-			
-			if (Y == InPaddingLength - 1)
-			{
-				if (OutResult != nullptr)
-					*OutResult = RtlAddOffsetToPointer(InBaseAddress, X);
+	auto* Entries = (SIGNATURE_CACHE_ENTRY*) RtlAddOffsetToPointer(FileBuffer, sizeof(SIGNATURE_CACHE_HEADER));
 
-				return STATUS_SUCCESS;
-			}
+	for (ULONG I = 0; I < Header->NumberOfEntries; I++)
+	{
+		if (NT_ERROR(Status = CkInsertSignatureCacheEntry(Cache, &Entries[I])))
+		{
+			CkFreeSignatureCache(Cache);
+			CkFreePool(FileBuffer);
+			return Status;
 		}
 	}
 
-	return STATUS_NOT_FOUND;
+	CkFreePool(FileBuffer);
+
+	*OutCache = Cache;
+	return STATUS_SUCCESS;
 }
 
 /// <summary>
-/// Searches for a successive pattern of a specific padding byte in the given memory range, starting from the end.
+/// Saves a signature cache to a file, so it can be loaded back with CkLoadSignatureCache.
 /// </summary>
-/// <param name="InBaseAddress">The base address.</param>
-/// <param name="InSize">The size of the region in bytes.</param>
-/// <param name="InPaddingByte">The padding byte.</param>
-/// <param name="InPaddingLength">The padding length.</param>
-/// <param name="OutResult">The result.</param>
-NTSTATUS CkTryFindPaddingFromEnd(CONST PVOID InBaseAddress, SIZE_T InSize, UINT8 InPaddingByte, SIZE_T InPaddingLength, OPTIONAL OUT PVOID* OutResult)
+/// <param name="InCache">The signature cache.</param>
+/// <param name="InFilePath">The path of the file.</param>
+NTSTATUS CkSaveSignatureCache(CONST CK_SIGNATURE_CACHE* InCache, CONST WCHAR* InFilePath)
 {
 	// 
 	// Verify the passed parameters.
 	// 
 
-	if (InBaseAddress == nullptr)
+	if (InCache == nullptr)
 		return STATUS_INVALID_PARAMETER_1;
 
-	if (InSize == 0)
+	if (InFilePath == nullptr)
 		return STATUS_INVALID_PARAMETER_2;
 
-	if (InPaddingLength == 0)
-		return STATUS_INVALID_PARAMETER_4;
-
 	// 
-	// The padding cannot be bigger than the region of memory we are about to scan.
-	// 
-
-	if (InSize < InPaddingLength)
-		return STATUS_ARRAY_BOUNDS_EXCEEDED;
-
+	// Serialize the header and the entries.
 	// 
-	// Loop through the memory region.
-	// 
-	
-	for (SIZE_T X = InSize - InPaddingLength; X > 0 ; X--)
-	{
-		// 
-		// Search for the padding.
-		// 
-
-		for (SIZE_T Y = 0; Y < InPaddingLength; Y++)
-		{
-			// 
-			// Check if the bytes matches.
-			// 
 
-			const auto CurrentByte = *(UINT8*) RtlAddOffsetToPointer(InBaseAddress, X + Y);
+	CONST SIZE_T FileSize = sizeof(SIGNATURE_CACHE_HEADER) + InCache->NumberOfEntries * sizeof(SIGNATURE_CACHE_ENTRY);
+	auto* FileBuffer = (SIGNATURE_CACHE_HEADER*) CkAllocatePool(NonPagedPoolNx, FileSize);
 
-			if (CurrentByte != InPaddingByte)
-				break;
+	if (FileBuffer == nullptr)
+		return STATUS_INSUFFICIENT_RESOURCES;
 
-			// 
-			// If this was the last byte for the scan...
-			// 
-			
-			if (Y == InPaddingLength - 1)
-			{
-				if (OutResult != nullptr)
-					*OutResult = RtlAddOffsetToPointer(InBaseAddress, X);
+	FileBuffer->Magic = SIGNATURE_CACHE_MAGIC;
+	FileBuffer->Version = SIGNATURE_CACHE_VERSION;
+	FileBuffer->NumberOfEntries = InCache->NumberOfEntries;
+	FileBuffer->Reserved = 0;
 
-				return STATUS_SUCCESS;
-			}
-		}
-	}
+	if (InCache->NumberOfEntries != 0)
+		RtlCopyMemory(RtlAddOffsetToPointer(FileBuffer, sizeof(SIGNATURE_CACHE_HEADER)), InCache->Entries, InCache->NumberOfEntries * sizeof(SIGNATURE_CACHE_ENTRY));
 
-	return STATUS_NOT_FOUND;
+	CONST NTSTATUS Status = CkSetFileBuffer(InFilePath, FileBuffer, FileSize);
+	CkFreePool(FileBuffer);
+	return Status;
 }
 
 /// <summary>
-/// Searches for a certain pattern inside the given module's executable sections.
+/// Removes every result recorded for the build of the module at the given address, typically before it unloads.
 /// </summary>
-/// <param name="InBaseAddress">The base address.</param>
-/// <param name="InSignature">The signature.</param>
-/// <param name="OutResult">The signature scan result.</param>
-NTSTATUS CkTryFindPatternInModuleExecutableSections(CONST PVOID InBaseAddress, CONST CHAR* InSignature, OPTIONAL OUT PVOID* OutResult)
+/// <param name="InCache">The signature cache.</param>
+/// <param name="InBaseAddress">The base address of the module.</param>
+NTSTATUS CkInvalidateSignatureCache(CK_SIGNATURE_CACHE* InCache, CONST PVOID InBaseAddress)
 {
 	NTSTATUS Status;
 
@@ -279,80 +4177,112 @@ NTSTATUS CkTryFindPatternInModuleExecutableSections(CONST PVOID InBaseAddress, C
 	// Verify the passed parameters.
 	// 
 
-	if (InBaseAddress == nullptr)
+	if (InCache == nullptr)
 		return STATUS_INVALID_PARAMETER_1;
 
-	if (InSignature == nullptr)
+	if (InBaseAddress == nullptr)
 		return STATUS_INVALID_PARAMETER_2;
 
+	SIGNATURE_CACHE_ENTRY Key;
+
+	if (NT_ERROR(Status = CkGetSignatureCacheModuleIdentity(InBaseAddress, &Key)))
+		return Status;
+
 	// 
-	// Setup the scan context.
+	// Compact the entries of the other modules.
 	// 
 
-	struct SCAN_CONTEXT
+	ULONG NumberOfEntries = 0;
+
+	for (ULONG I = 0; I < InCache->NumberOfEntries; I++)
 	{
-		PVOID BaseAddress;
-		CONST CHAR* Signature;
-		PVOID Result;
-	};
+		auto* Entry = &InCache->Entries[I];
 
-	SCAN_CONTEXT ScanContext;
-	ScanContext.BaseAddress = InBaseAddress;
-	ScanContext.Signature = InSignature;
-	ScanContext.Result = nullptr;
+		if (Entry->TimeDateStamp == Key.TimeDateStamp
+		 && Entry->SizeOfImage == Key.SizeOfImage
+		 && Entry->CheckSum == Key.CheckSum)
+			continue;
+
+		InCache->Entries[NumberOfEntries++] = *Entry;
+	}
+
+	InCache->NumberOfEntries = NumberOfEntries;
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Searches for a certain pattern inside the given module's executable sections, reusing the result recorded for this build of the module.
+/// </summary>
+/// <param name="InCache">The signature cache.</param>
+/// <param name="InBaseAddress">The base address.</param>
+/// <param name="InSignature">The compiled signature.</param>
+/// <param name="OutResult">The signature scan result.</param>
+NTSTATUS CkTryFindPatternInModuleExecutableSectionsCached(CK_SIGNATURE_CACHE* InCache, CONST PVOID InBaseAddress, CONST CK_SIGNATURE* InSignature, OPTIONAL OUT PVOID* OutResult)
+{
+	NTSTATUS Status;
 
 	// 
-	// Enumerate the sections of the module.
+	// Verify the passed parameters.
 	// 
 
-	RtlEnumerateModuleSections<SCAN_CONTEXT*>(InBaseAddress, &ScanContext, [] (ULONG InIndex, IMAGE_SECTION_HEADER* InSectionHeader, SCAN_CONTEXT* InContext) -> bool
-	{
-		// 
-		// Parse the section's characteristics.
-		// 
+	if (InCache == nullptr)
+		return STATUS_INVALID_PARAMETER_1;
 
-		auto Executable	 = (InSectionHeader->Characteristics & IMAGE_SCN_MEM_EXECUTE) != 0;
-		auto Readable	 = (InSectionHeader->Characteristics & IMAGE_SCN_MEM_READ) != 0;
-		auto Writable	 = (InSectionHeader->Characteristics & IMAGE_SCN_MEM_WRITE) != 0;
-		auto Discardable = (InSectionHeader->Characteristics & IMAGE_SCN_MEM_DISCARDABLE) != 0;
-		auto ContainCode = (InSectionHeader->Characteristics & IMAGE_SCN_CNT_CODE) != 0;
+	if (InBaseAddress == nullptr)
+		return STATUS_INVALID_PARAMETER_2;
 
-		// 
-		// Discardable sections are not mapped.
-		// 
+	if (InSignature == nullptr || InSignature->Length == 0)
+		return STATUS_INVALID_PARAMETER_3;
 
-		if (Discardable)
-			return FALSE;
+	SIGNATURE_CACHE_ENTRY Key;
 
-		// 
-		// Check if the section is executable or contains code.
-		// 
+	if (NT_ERROR(Status = CkGetSignatureCacheModuleIdentity(InBaseAddress, &Key)))
+		return Status;
 
-		if (!Executable && !ContainCode)
-			return FALSE;
+	Key.SignatureHash = CkGetSignatureCacheHash(InSignature);
 
-		// 
-		// Verify the validity of the address.
-		// 
+	// 
+	// Reuse the recorded result, as long as the signature still matches at this address.
+	// 
 
-		auto* SectionData = RtlAddOffsetToPointer(InContext->BaseAddress, InSectionHeader->VirtualAddress);
+	auto* Entry = CkFindSignatureCacheEntry(InCache, &Key);
 
-		if (!MmIsAddressValid(SectionData))
-			return FALSE;
+	if (Entry != nullptr)
+	{
+		if (Entry->RelativeAddress == SIGNATURE_CACHE_NOT_FOUND)
+			return STATUS_NOT_FOUND;
 
-		// 
-		// Scan this section.
-		// 
+		if ((SIZE_T) Entry->RelativeAddress + InSignature->Length <= Key.SizeOfImage)
+		{
+			auto* Address = (CONST UINT8*) RtlAddOffsetToPointer(InBaseAddress, Entry->RelativeAddress);
 
-		return NT_SUCCESS(CkTryFindPattern(SectionData, InSectionHeader->Misc.VirtualSize, InContext->Signature, &InContext->Result));
-	});
+			if (MmIsAddressValid((PVOID) Address)
+			 && MmIsAddressValid((PVOID) &Address[InSignature->Length - 1])
+			 && CkMatchSignature(Address, InSignature))
+			{
+				if (OutResult != nullptr)
+					*OutResult = (PVOID) Address;
+
+				return STATUS_SUCCESS;
+			}
+		}
+	}
 
 	// 
-	// Return the resulting address.
+	// Scan the module and record the result, including a miss.
 	// 
 
-	if (OutResult != nullptr)
-		*OutResult = ScanContext.Result;
+	PVOID Result = nullptr;
+	Status = CkTryFindPatternInModuleExecutableSections(InBaseAddress, InSignature, &Result);
 
-	return ScanContext.Result != nullptr ? STATUS_SUCCESS : STATUS_NOT_FOUND;
+	if (Status != STATUS_SUCCESS && Status != STATUS_NOT_FOUND)
+		return Status;
+
+	Key.RelativeAddress = Status == STATUS_SUCCESS ? (ULONG) ((ULONG_PTR) Result - (ULONG_PTR) InBaseAddress) : SIGNATURE_CACHE_NOT_FOUND;
+	CkInsertSignatureCacheEntry(InCache, &Key);
+
+	if (NT_SUCCESS(Status) && OutResult != nullptr)
+		*OutResult = Result;
+
+	return Status;
 }
@@ -1,14 +1,64 @@
 #include "../../Headers/EasyNT.h"
 
+/// <summary>
+/// Gets a value indicating whether the given build number belongs to the given platform.
+/// </summary>
+/// <param name="InBuildNumber">The build number.</param>
+/// <param name="InPlatform">The platform.</param>
+static BOOLEAN CkIsBuildOfPlatform(ULONG InBuildNumber, BYTE InPlatform)
+{
+	const auto CurrentBuildNumber = InBuildNumber;
+
+	switch (InPlatform)
+	{
+		case OS_PLATFORM_WINDOWS_11:
+		{
+			return CurrentBuildNumber >= 22000 &&
+				   CurrentBuildNumber < 30000;
+		}
+
+		case OS_PLATFORM_WINDOWS_10:
+		{
+			return CurrentBuildNumber >= 10240 &&
+				   CurrentBuildNumber <  22000;
+		}
+
+		case OS_PLATFORM_WINDOWS_7:
+		{
+			return CurrentBuildNumber == 7601;
+		}
+
+		default:
+		{
+			return false;
+		}
+	}
+}
+
+/// <summary>
+/// Gets the platform of the given build number.
+/// </summary>
+/// <param name="InBuildNumber">The build number.</param>
+///	<returns>One of the OS_PLATFORM_* values, or zero for an unknown platform.</returns>
+static BYTE CkGetPlatformOfBuild(ULONG InBuildNumber)
+{
+	CONST BYTE Platforms[] = { OS_PLATFORM_WINDOWS_11, OS_PLATFORM_WINDOWS_10, OS_PLATFORM_WINDOWS_7 };
+
+	for (auto const Platform : Platforms)
+	{
+		if (CkIsBuildOfPlatform(InBuildNumber, Platform))
+			return Platform;
+	}
+
+	return 0;
+}
+
 /// <summary>
 /// Gets the current major version number for this operating system.
 /// </summary>
 ULONG RtlGetVersionMajorNumber()
 {
-	RTL_OSVERSIONINFOW VersionInfo = { };
-	VersionInfo.dwOSVersionInfoSize = sizeof(RTL_OSVERSIONINFOW);
-	RtlGetVersion(&VersionInfo);
-	return VersionInfo.dwMajorVersion;
+	return CkGetSystemCapabilities()->MajorVersion;
 }
 
 /// <summary>
@@ -16,10 +66,7 @@ ULONG RtlGetVersionMajorNumber()
 /// </summary>
 ULONG RtlGetVersionMinorNumber()
 {
-	RTL_OSVERSIONINFOW VersionInfo = { };
-	VersionInfo.dwOSVersionInfoSize = sizeof(RTL_OSVERSIONINFOW);
-	RtlGetVersion(&VersionInfo);
-	return VersionInfo.dwMinorVersion;
+	return CkGetSystemCapabilities()->MinorVersion;
 }
 
 /// <summary>
@@ -27,10 +74,7 @@ ULONG RtlGetVersionMinorNumber()
 /// </summary>
 ULONG RtlGetVersionBuildNumber()
 {
-	RTL_OSVERSIONINFOW VersionInfo = { };
-	VersionInfo.dwOSVersionInfoSize = sizeof(RTL_OSVERSIONINFOW);
-	RtlGetVersion(&VersionInfo);
-	return VersionInfo.dwBuildNumber;
+	return CkGetSystemCapabilities()->BuildNumber;
 }
 
 /// <summary>
@@ -38,30 +82,130 @@ ULONG RtlGetVersionBuildNumber()
 /// </summary>
 BOOLEAN RtlCurrentPlatformIs(BYTE InPlatform)
 {
-	const auto CurrentBuildNumber = RtlGetVersionBuildNumber();
+	return InPlatform != 0 && CkGetSystemCapabilities()->Platform == InPlatform;
+}
 
-	switch (InPlatform)
+// 
+// Capability table.
+// 
+
+#define SYSTEM_CAPABILITIES_UNINITIALIZED		0
+#define SYSTEM_CAPABILITIES_INITIALIZING		1
+#define SYSTEM_CAPABILITIES_INITIALIZED			2
+
+static CK_SYSTEM_CAPABILITIES SystemCapabilities = { };
+static volatile LONG SystemCapabilitiesState = SYSTEM_CAPABILITIES_UNINITIALIZED;
+
+/// <summary>
+/// Queries the operating system and the processor and fills the given capability table.
+/// </summary>
+/// <param name="OutCapabilities">The capability table.</param>
+static VOID CkQuerySystemCapabilities(OUT CK_SYSTEM_CAPABILITIES* OutCapabilities)
+{
+	RtlZeroMemory(OutCapabilities, sizeof(CK_SYSTEM_CAPABILITIES));
+
+	// 
+	// Query the version of the operating system.
+	// 
+
+	RTL_OSVERSIONINFOW VersionInfo = { };
+	VersionInfo.dwOSVersionInfoSize = sizeof(RTL_OSVERSIONINFOW);
+	RtlGetVersion(&VersionInfo);
+
+	OutCapabilities->MajorVersion = VersionInfo.dwMajorVersion;
+	OutCapabilities->MinorVersion = VersionInfo.dwMinorVersion;
+	OutCapabilities->BuildNumber = VersionInfo.dwBuildNumber;
+	OutCapabilities->Platform = CkGetPlatformOfBuild(VersionInfo.dwBuildNumber);
+
+	if (VersionInfo.dwBuildNumber >= 22000)
+		OutCapabilities->SystemFeatures |= CK_SYSTEM_FEATURE_WINDOWS_11;
+
+#if defined(_M_AMD64)
+
+	// 
+	// Query the features the operating system has enabled.
+	// 
+
+	if ((RtlGetEnabledExtendedFeatures(XSTATE_MASK_AVX) & XSTATE_MASK_AVX) != 0)
+		OutCapabilities->SystemFeatures |= CK_SYSTEM_FEATURE_AVX_STATE;
+
+	if ((__readcr4() & (1ULL << 12)) != 0)
+		OutCapabilities->SystemFeatures |= CK_SYSTEM_FEATURE_FIVE_LEVEL_PAGING;
+
+	// 
+	// Query the features of the processor.
+	// 
+
+	int CpuInfo[4] = { };
+	__cpuid(CpuInfo, 0);
+
+	CONST auto MaximumLeaf = CpuInfo[0];
+
+	if (MaximumLeaf >= 7)
 	{
-		case OS_PLATFORM_WINDOWS_11:
-		{
-			return CurrentBuildNumber >= 22000 &&
-				   CurrentBuildNumber < 30000;
-		}
+		__cpuidex(CpuInfo, 7, 0);
 
-		case OS_PLATFORM_WINDOWS_10:
-		{
-			return CurrentBuildNumber >= 10240 &&
-				   CurrentBuildNumber <  22000;
-		}
+		if ((CpuInfo[1] & (1 << 5)) != 0)
+			OutCapabilities->ProcessorFeatures |= CK_PROCESSOR_FEATURE_AVX2;
+	}
 
-		case OS_PLATFORM_WINDOWS_7:
-		{
-			return CurrentBuildNumber == 7601;
-		}
+	// 
+	// Record the offsets of the structures used by the library, only known on x64 and left zero elsewhere.
+	// KPROCESS.DirectoryTableBase has not moved on x64 since Windows 7.
+	// 
 
-		default:
-		{
-			return false;
-		}
+	OutCapabilities->ProcessDirectoryTableBaseOffset = 0x28;
+
+#endif
+}
+
+/// <summary>
+/// Populates the capability table, querying the operating system and the processor only once.
+/// </summary>
+///	<remarks>This function should be called at PASSIVE_LEVEL from the entry point of the driver, otherwise the table is populated by the first function using it, which must then run at PASSIVE_LEVEL as well.</remarks>
+NTSTATUS CkInitializeSystemCapabilities()
+{
+	if (ReadAcquire(&SystemCapabilitiesState) == SYSTEM_CAPABILITIES_INITIALIZED)
+		return STATUS_SUCCESS;
+
+	// 
+	// Every racing caller queries its own copy, which takes as long as it needs to and can be preempted.
+	// 
+
+	CK_SYSTEM_CAPABILITIES Capabilities;
+	CkQuerySystemCapabilities(&Capabilities);
+
+	// 
+	// Only the first one publishes it, at DISPATCH_LEVEL so it cannot be preempted on its processor.
+	// The others only ever wait for this copy to complete, never for a thread which is not running.
+	// 
+
+	KIRQL OldIrql;
+	KeRaiseIrql(DISPATCH_LEVEL, &OldIrql);
+
+	if (InterlockedCompareExchange(&SystemCapabilitiesState, SYSTEM_CAPABILITIES_INITIALIZING, SYSTEM_CAPABILITIES_UNINITIALIZED) == SYSTEM_CAPABILITIES_UNINITIALIZED)
+	{
+		SystemCapabilities = Capabilities;
+		InterlockedExchange(&SystemCapabilitiesState, SYSTEM_CAPABILITIES_INITIALIZED);
 	}
+	else
+	{
+		while (ReadAcquire(&SystemCapabilitiesState) != SYSTEM_CAPABILITIES_INITIALIZED)
+			YieldProcessor();
+	}
+
+	KeLowerIrql(OldIrql);
+	return STATUS_SUCCESS;
+}
+
+/// <summary>
+/// Gets the capability table, populating it first if needed.
+/// </summary>
+///	<remarks>Once the table is populated, this function can be called at DISPATCH_LEVEL.</remarks>
+CONST CK_SYSTEM_CAPABILITIES* CkGetSystemCapabilities()
+{
+	if (ReadAcquire(&SystemCapabilitiesState) != SYSTEM_CAPABILITIES_INITIALIZED)
+		CkInitializeSystemCapabilities();
+
+	return &SystemCapabilities;
 }